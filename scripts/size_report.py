@@ -0,0 +1,150 @@
+"""
+@file size_report.py
+@brief Rapport RAM/flash par module à partir du fichier map de l'édition de liens.
+@part of Apple-ADB-Ressurector
+
+Ajoute la cible `size_report` :
+
+    pio run -e bluepill_f103c8_128k -t size_report
+
+Les budgets sont lus dans platformio.ini (`custom_ram_budget`,
+`custom_flash_budget`, en octets) ; la cible échoue si l'un d'eux est dépassé.
+
+@date 2025
+@author Clément SAILLANT
+Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+@license GNU GPL v3
+"""
+
+import os
+import re
+
+Import("env")  # noqa: F821  (fourni par SCons)
+
+MAP_FILE = os.path.join("$BUILD_DIR", "firmware.map")
+env.Append(LINKFLAGS=["-Wl,-Map," + MAP_FILE])  # noqa: F821
+
+# Section d'entrée -> (flash, ram). .data est copiée de la flash vers la RAM.
+SECTION_CLASSES = (
+    (".text", (True, False)),
+    (".rodata", (True, False)),
+    (".literal", (True, False)),
+    (".flash.", (True, False)),
+    (".isr_vector", (True, False)),
+    (".ARM.exidx", (True, False)),
+    (".ARM.extab", (True, False)),
+    (".init_array", (True, False)),
+    (".fini_array", (True, False)),
+    (".data", (True, True)),
+    (".dram0.data", (True, True)),
+    (".iram", (True, True)),
+    (".bss", (False, True)),
+    (".dram0.bss", (False, True)),
+    (".noinit", (False, True)),
+    ("COMMON", (False, True)),
+)
+
+# Ligne d'une section d'entrée : nom, adresse, taille, objet
+INPUT_LINE = re.compile(
+    r"^\s(?P<name>[.\w][^\s]*)?\s+0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)\s+(?P<obj>\S.*)$"
+)
+SECTION_ONLY = re.compile(r"^\s(?P<name>[.\w][^\s]*)\s*$")
+ARCHIVE_MEMBER = re.compile(r"(?P<archive>[^/\\]+\.a)\((?P<member>[^)]+)\)$")
+
+
+def classify(section):
+    for prefix, kind in SECTION_CLASSES:
+        if section.startswith(prefix):
+            return kind
+    return None
+
+
+def module_name(obj):
+    """Regroupe les sources du projet par fichier, les bibliothèques par archive."""
+    obj = obj.strip()
+    match = ARCHIVE_MEMBER.search(obj)
+    if match:
+        return match.group("archive")
+    name = os.path.basename(obj)
+    return name[:-2] if name.endswith(".o") else name
+
+
+def parse_map(path):
+    modules = {}
+    pending = None
+    in_map = False
+    with open(path, encoding="utf-8", errors="replace") as handle:
+        for line in handle:
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+
+            only = SECTION_ONLY.match(line)
+            if only:
+                pending = only.group("name")
+                continue
+
+            match = INPUT_LINE.match(line)
+            if not match:
+                pending = None
+                continue
+
+            section = match.group("name") or pending
+            pending = None
+            size = int(match.group("size"), 16)
+            if not section or size == 0 or int(match.group("addr"), 16) == 0:
+                continue
+
+            kind = classify(section)
+            if kind is None:
+                continue
+            usage = modules.setdefault(module_name(match.group("obj")), [0, 0])
+            if kind[0]:
+                usage[0] += size
+            if kind[1]:
+                usage[1] += size
+    return modules
+
+
+def budget(name):
+    value = env.GetProjectOption(name, "")  # noqa: F821
+    return int(value, 0) if value else None
+
+
+def size_report(target, source, env):
+    path = env.subst(MAP_FILE)
+    if not os.path.isfile(path):
+        print("Fichier map introuvable : %s" % path)
+        return 1
+
+    modules = parse_map(path)
+    rows = sorted(modules.items(), key=lambda item: item[1][0] + item[1][1], reverse=True)
+    total_flash = sum(flash for flash, _ in modules.values())
+    total_ram = sum(ram for _, ram in modules.values())
+
+    print("%-40s %10s %10s" % ("Module", "Flash", "RAM"))
+    for name, (flash, ram) in rows:
+        print("%-40s %10d %10d" % (name, flash, ram))
+    print("%-40s %10d %10d" % ("TOTAL", total_flash, total_ram))
+
+    status = 0
+    for label, used, limit in (
+        ("Flash", total_flash, budget("custom_flash_budget")),
+        ("RAM", total_ram, budget("custom_ram_budget")),
+    ):
+        if limit is None:
+            continue
+        print("%s : %d / %d octets (%d%%)" % (label, used, limit, used * 100 // limit))
+        if used > limit:
+            print("ERREUR : budget %s dépassé de %d octets" % (label, used - limit))
+            status = 1
+    return status
+
+
+env.AddCustomTarget(  # noqa: F821
+    name="size_report",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions=[size_report],
+    title="Size report",
+    description="Occupation RAM/flash par module et contrôle des budgets",
+)
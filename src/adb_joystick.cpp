@@ -0,0 +1,215 @@
+/**
+ * @file adb_joystick.cpp
+ * @brief Implémentation du décodage et de l'étalonnage des manettes ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "adb_joystick.h"
+#include "spsc_ring.h"
+
+// Étendue initiale de part et d'autre du centre, élargie par les valeurs
+// observées : la pleine course est atteinte même si les potentiomètres ne
+// couvrent pas 0..255
+#define SPAN_INIT 0x40
+// Centre relevé au démarrage seulement s'il est plausible (manette au repos)
+#define CENTER_MIN 0x40
+#define CENTER_MAX 0xC0
+
+static const adb_joystick_format formats[] = {
+    // MouseStick II : deux axes, trois boutons
+    {ADB_JOYSTICK_HANDLER_GRAVIS, "MouseStick II", 2, 3, false},
+};
+
+/**
+ * @struct axis_cal
+ * @brief Étalonnage d'un axe ; gains en Q8 (unités HID par pas brut).
+ */
+struct axis_cal {
+  uint8_t min;
+  uint8_t center;
+  uint8_t max;
+  uint32_t gain_neg_q8;
+  uint32_t gain_pos_q8;
+};
+
+static const adb_joystick_format *format = nullptr;
+static axis_cal cal[ADB_JOYSTICK_AXES];
+static bool centered = false;
+static uint16_t deadzone_q15 = ADB_JOYSTICK_DEADZONE_Q15;
+static uint32_t deadzone = 0;         // En unités HID
+static uint32_t deadzone_gain_q15 = 0; // Remise à l'échelle hors zone morte
+
+// Décodage -> rapports
+static SpscRing<joystick_sample, ADB_JOYSTICK_RING_SIZE> samples;
+
+// Côté producteur uniquement
+static joystick_sample last_pushed;
+static bool pushed = false;
+
+// Côté consommateur uniquement
+static uint8_t last_buttons = 0;
+static uint32_t coalesced = 0;
+
+/**
+ * @brief Gain arrondi par excès : la butée donne exactement la pleine
+ * échelle (le résultat est borné ensuite).
+ */
+static uint32_t gain(uint8_t shift, uint32_t span) {
+  return (((uint32_t)ADB_JOYSTICK_AXIS_MAX << shift) + span - 1) / span;
+}
+
+static void update_gains(axis_cal &c) {
+  c.gain_neg_q8 = gain(8, c.center - c.min);
+  c.gain_pos_q8 = gain(8, c.max - c.center);
+}
+
+static void update_deadzone() {
+  deadzone = (uint32_t)deadzone_q15 * ADB_JOYSTICK_AXIS_MAX >> 15;
+  deadzone_gain_q15 = gain(15, ADB_JOYSTICK_AXIS_MAX - deadzone);
+}
+
+/**
+ * @brief Étalonnage par défaut autour d'un centre.
+ */
+static void center_axis(axis_cal &c, uint8_t center) {
+  c.center = center;
+  c.min = center > SPAN_INIT ? center - SPAN_INIT : 0;
+  c.max = center < 0xFF - SPAN_INIT ? center + SPAN_INIT : 0xFF;
+  update_gains(c);
+}
+
+const adb_joystick_format *adb_joystick_format_for(uint8_t handler_id) {
+  for (const adb_joystick_format &f : formats)
+    if (f.handler_id == handler_id)
+      return &f;
+  return nullptr;
+}
+
+void adb_joystick_begin(const adb_joystick_format *f) {
+  format = f;
+  centered = false;
+  for (axis_cal &c : cal)
+    center_axis(c, 0x80);
+  update_deadzone();
+}
+
+bool adb_joystick_calibrate(uint8_t axis, uint8_t min, uint8_t center,
+                            uint8_t max) {
+  if (axis >= ADB_JOYSTICK_AXES || !(min < center && center < max))
+    return false;
+  cal[axis].min = min;
+  cal[axis].center = center;
+  cal[axis].max = max;
+  update_gains(cal[axis]);
+  centered = true;
+  return true;
+}
+
+void adb_joystick_set_deadzone(uint16_t q15) {
+  deadzone_q15 = q15 > 0x4000 ? 0x4000 : q15;
+  update_deadzone();
+}
+
+uint16_t adb_joystick_deadzone() { return deadzone_q15; }
+
+/**
+ * @brief Ramène une valeur brute sur l'étendue HID, zone morte comprise.
+ */
+static int16_t scale_axis(axis_cal &c, uint8_t raw) {
+  if (raw < c.min || raw > c.max) {
+    if (raw < c.min)
+      c.min = raw;
+    else
+      c.max = raw;
+    update_gains(c);
+  }
+
+  bool negative = raw < c.center;
+  uint32_t offset = negative ? c.center - raw : raw - c.center;
+  uint32_t magnitude =
+      offset * (negative ? c.gain_neg_q8 : c.gain_pos_q8) >> 8;
+  if (magnitude > ADB_JOYSTICK_AXIS_MAX)
+    magnitude = ADB_JOYSTICK_AXIS_MAX;
+  if (magnitude <= deadzone)
+    return 0;
+
+  // Sortie de zone morte à partir de 0 : pas de saut de valeur
+  magnitude = (magnitude - deadzone) * deadzone_gain_q15 >> 15;
+  if (magnitude > ADB_JOYSTICK_AXIS_MAX)
+    magnitude = ADB_JOYSTICK_AXIS_MAX;
+  return negative ? -(int16_t)magnitude : (int16_t)magnitude;
+}
+
+bool adb_joystick_decode(const uint8_t *frame, uint8_t len,
+                         joystick_sample *sample) {
+  if (format == nullptr || len < 1 + format->axis_count)
+    return false;
+
+  // Première trame : manette au repos, centre relevé
+  if (!centered) {
+    for (uint8_t i = 0; i < format->axis_count; i++) {
+      uint8_t raw = frame[1 + i];
+      if (raw >= CENTER_MIN && raw <= CENTER_MAX)
+        center_axis(cal[i], raw);
+    }
+    centered = true;
+  }
+
+  for (uint8_t i = 0; i < ADB_JOYSTICK_AXES; i++)
+    sample->axes[i] =
+        i < format->axis_count ? scale_axis(cal[i], frame[1 + i]) : 0;
+  sample->buttons =
+      (uint8_t)~frame[0] & (uint8_t)((1u << format->button_count) - 1);
+  return true;
+}
+
+bool adb_joystick_push(const joystick_sample &sample) {
+  if (pushed && sample.buttons == last_pushed.buttons) {
+    bool same = true;
+    for (uint8_t i = 0; i < ADB_JOYSTICK_AXES; i++)
+      same = same && sample.axes[i] == last_pushed.axes[i];
+    if (same)
+      return false;
+  }
+  // File pleine : le même état sera redéposé à la trame suivante
+  if (samples.push(sample)) {
+    last_pushed = sample;
+    pushed = true;
+  }
+  return true;
+}
+
+bool adb_joystick_next(joystick_sample *sample) {
+  joystick_sample incoming;
+  bool found = false;
+  while (samples.pop(incoming)) {
+    if (found)
+      coalesced++;
+    *sample = incoming;
+    found = true;
+    // Changement de bouton : envoyé tel quel, la suite attend le tour suivant
+    if (incoming.buttons != last_buttons) {
+      last_buttons = incoming.buttons;
+      return true;
+    }
+  }
+  return found;
+}
+
+uint32_t adb_joystick_coalesced() { return coalesced; }
+
+uint32_t adb_joystick_overflows() { return samples.overflows(); }
+
+void adb_joystick_reset() {
+  joystick_sample discard;
+  while (samples.pop(discard))
+    ;
+  pushed = false;
+  last_buttons = 0;
+  coalesced = 0;
+}
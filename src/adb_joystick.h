@@ -0,0 +1,153 @@
+/**
+ * @file adb_joystick.h
+ * @brief Manettes et joysticks ADB : détection, étalonnage des axes et
+ * regroupement des échantillons.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Les manettes (Advanced Gravis MouseStick II par exemple) répondent à
+ * l'adresse de la souris et se distinguent par leur identifiant de
+ * gestionnaire (registre 3). Le registre 0 renvoie une trame de
+ * 1 + axis_count octets :
+ *
+ * | Octet | Contenu                                               |
+ * |-------|-------------------------------------------------------|
+ * | 0     | Boutons 1 à 8, actifs à l'état bas (bit 0 : bouton 1) |
+ * | 1..n  | Axes absolus non signés (X, Y, manette des gaz)       |
+ *
+ * Chaque axe est ramené sur -ADB_JOYSTICK_AXIS_MAX..ADB_JOYSTICK_AXIS_MAX
+ * en virgule fixe : centre relevé au repos, gains séparés de part et
+ * d'autre du centre (étendue élargie par les valeurs observées), puis zone
+ * morte autour du centre sans saut de valeur à sa sortie.
+ *
+ * Le décodage dépose les échantillons qui changent dans une file sans
+ * verrou ; côté rapports, chaque changement de bouton est transmis, les
+ * positions intermédiaires sont remplacées par la plus récente.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef ADB_JOYSTICK_H
+#define ADB_JOYSTICK_H
+
+#include <cstdint>
+
+#define ADB_JOYSTICK_ADDRESS 3 /**< Adresse partagée avec la souris. */
+/** Advanced Gravis MouseStick II (identifiant à confirmer sur matériel). */
+#define ADB_JOYSTICK_HANDLER_GRAVIS 0x30
+#define ADB_JOYSTICK_AXES 3          /**< Axes rapportés au plus. */
+#define ADB_JOYSTICK_BUTTONS 8       /**< Boutons rapportés au plus. */
+#define ADB_JOYSTICK_FRAME_MAX 8     /**< Longueur maximale d'une trame. */
+#define ADB_JOYSTICK_RING_SIZE 16    /**< File du décodage (puissance de 2). */
+#define ADB_JOYSTICK_AXIS_MAX 32767  /**< Étendue HID des axes (±). */
+/** Zone morte par défaut, fraction Q15 de l'étendue (2048 : 6,25 %). */
+#define ADB_JOYSTICK_DEADZONE_Q15 2048
+/** Période visée des créneaux d'interrogation de la manette (µs). */
+#define ADB_JOYSTICK_POLL_US 4000
+
+/**
+ * @struct adb_joystick_format
+ * @brief Description d'un modèle de manette.
+ */
+struct adb_joystick_format {
+  uint8_t handler_id;   /**< Identifiant de gestionnaire (registre 3). */
+  const char *name;     /**< Nom court, pour les traces. */
+  uint8_t axis_count;   /**< Axes présents dans la trame. */
+  uint8_t button_count; /**< Boutons présents. */
+  /**
+   * Identifiant vérifié sur matériel. Sinon, le périphérique reste traité en
+   * souris sauf avec ADB_JOYSTICK_TRY_UNCONFIRMED.
+   */
+  bool confirmed;
+};
+
+/**
+ * @struct joystick_sample
+ * @brief Échantillon étalonné.
+ */
+struct joystick_sample {
+  uint32_t timestamp_us;           /**< Horodatage du décodage (micros()). */
+  int16_t axes[ADB_JOYSTICK_AXES]; /**< Axes, 0 au centre. */
+  uint8_t buttons;                 /**< Bit i : bouton i + 1 enfoncé. */
+};
+
+/**
+ * @brief Retourne le format d'un gestionnaire de manette.
+ *
+ * @param handler_id Identifiant lu dans le registre 3 de l'adresse
+ * ADB_JOYSTICK_ADDRESS.
+ * @return nullptr si l'identifiant n'est pas celui d'une manette (souris).
+ */
+const adb_joystick_format *adb_joystick_format_for(uint8_t handler_id);
+
+/**
+ * @brief Choisit le format de la manette détectée et remet l'étalonnage à
+ * zéro : le centre sera relevé sur la première trame.
+ */
+void adb_joystick_begin(const adb_joystick_format *format);
+
+/**
+ * @brief Impose l'étalonnage d'un axe (valeurs brutes de la trame).
+ *
+ * @return false si l'axe n'existe pas ou si min < center < max n'est pas
+ * respecté.
+ */
+bool adb_joystick_calibrate(uint8_t axis, uint8_t min, uint8_t center,
+                            uint8_t max);
+
+/**
+ * @brief Règle la zone morte (fraction Q15 de l'étendue, bornée à la
+ * moitié).
+ */
+void adb_joystick_set_deadzone(uint16_t deadzone_q15);
+
+/** @brief Zone morte courante (Q15). */
+uint16_t adb_joystick_deadzone();
+
+/**
+ * @brief Décode une trame du registre 0.
+ *
+ * @param frame Octets reçus, dans l'ordre du bus.
+ * @param len Nombre d'octets reçus.
+ * @param sample Échantillon étalonné (timestamp non renseigné).
+ * @return false si aucune manette n'est choisie ou si la trame est trop
+ * courte.
+ */
+bool adb_joystick_decode(const uint8_t *frame, uint8_t len,
+                         joystick_sample *sample);
+
+/**
+ * @brief Dépose un échantillon s'il diffère du précédent (producteur
+ * unique : décodage ADB).
+ *
+ * @return true si l'échantillon est un changement.
+ */
+bool adb_joystick_push(const joystick_sample &sample);
+
+/**
+ * @brief Retourne le prochain échantillon à envoyer (consommateur unique).
+ *
+ * Un changement de bouton est rendu aussitôt, les suivants restant en file ;
+ * les déplacements sont remplacés par la position la plus récente.
+ *
+ * @return true si un échantillon est disponible.
+ */
+bool adb_joystick_next(joystick_sample *sample);
+
+/** @brief Échantillons remplacés par un plus récent. */
+uint32_t adb_joystick_coalesced();
+
+/** @brief Échantillons refusés par la file du décodage (cumulé). */
+uint32_t adb_joystick_overflows();
+
+/**
+ * @brief Vide la file et remet les compteurs à zéro (format et étalonnage
+ * conservés).
+ *
+ * À n'appeler que lorsque producteur et consommateur sont à l'arrêt.
+ */
+void adb_joystick_reset();
+
+#endif // ADB_JOYSTICK_H
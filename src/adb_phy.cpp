@@ -0,0 +1,251 @@
+/**
+ * @file adb_phy.cpp
+ * @brief Implémentation de la couche physique ADB intégrée.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "adb_phy.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <string.h>
+#ifdef ARDUINO_ARCH_ESP32
+#include <driver/gpio.h>
+#include <soc/gpio_struct.h>
+#ifdef CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+#endif
+
+typedef adb_phy_clock timing;
+
+static uint8_t phy_pin;
+
+#if defined(ARDUINO_ARCH_STM32)
+static GPIO_TypeDef *phy_port;
+static uint32_t phy_mask;
+
+static inline void line_low() { phy_port->BSRR = phy_mask << 16; }
+static inline void line_release() { phy_port->BSRR = phy_mask; }
+static inline bool line_is_high() { return (phy_port->IDR & phy_mask) != 0; }
+static inline uint32_t cycle_count() { return DWT->CYCCNT; }
+static inline void irq_mask() { __disable_irq(); }
+static inline void irq_unmask() { __enable_irq(); }
+#elif defined(ARDUINO_ARCH_ESP32)
+static uint32_t phy_mask;
+#ifdef CONFIG_PM_ENABLE
+// Fréquence maximale pendant une transaction : le compteur suit le cœur
+static esp_pm_lock_handle_t phy_pm_lock;
+#endif
+
+static inline void line_low() { GPIO.out_w1tc = phy_mask; }
+static inline void line_release() { GPIO.out_w1ts = phy_mask; }
+static inline bool line_is_high() { return (GPIO.in & phy_mask) != 0; }
+static inline uint32_t cycle_count() { return ESP.getCycleCount(); }
+static inline void irq_mask() { portDISABLE_INTERRUPTS(); }
+static inline void irq_unmask() { portENABLE_INTERRUPTS(); }
+#else
+// Cœur générique (simulateur) : API Arduino et micros()
+static inline void line_low() {
+  pinMode(phy_pin, OUTPUT);
+  digitalWrite(phy_pin, LOW);
+}
+static inline void line_release() { pinMode(phy_pin, INPUT); }
+static inline bool line_is_high() { return digitalRead(phy_pin) == HIGH; }
+static inline uint32_t cycle_count() { return micros(); }
+static inline void irq_mask() { noInterrupts(); }
+static inline void irq_unmask() { interrupts(); }
+#endif
+
+static inline void wait_until(uint32_t deadline) {
+  while ((int32_t)(cycle_count() - deadline) < 0) {
+  }
+}
+
+/**
+ * @brief Attend un niveau de ligne jusqu'à une échéance.
+ *
+ * @param at Instant (cycles) où le niveau a été observé.
+ * @return false si l'échéance est dépassée.
+ */
+static inline bool wait_level(bool high, uint32_t deadline, uint32_t *at) {
+  for (;;) {
+    uint32_t now = cycle_count();
+    if (line_is_high() == high) {
+      *at = now;
+      return true;
+    }
+    if ((int32_t)(now - deadline) > 0)
+      return false;
+  }
+}
+
+/**
+ * @brief Phase basse d'une durée donnée, à partir de l'échéance `start`.
+ *
+ * Les interruptions sont masquées pendant la phase basse seulement : c'est
+ * elle qui porte la valeur du bit.
+ */
+static inline void pulse_low(uint32_t start, uint32_t low) {
+  wait_until(start);
+  irq_mask();
+  line_low();
+  wait_until(start + low);
+  line_release();
+  irq_unmask();
+}
+
+/**
+ * @brief Émet un bit ; `t` avance d'une cellule.
+ */
+static inline void send_bit(uint32_t *t, bool bit) {
+  pulse_low(*t, bit ? timing::ONE_LOW : timing::ZERO_LOW);
+  *t += timing::CELL;
+}
+
+/**
+ * @brief Émet une commande jusqu'à la fin du bit de stop.
+ *
+ * @return true si un périphérique a prolongé le bit de stop (SRQ).
+ */
+static bool send_command(uint8_t command) {
+  uint32_t t = cycle_count();
+  line_low();
+  t += timing::ATTENTION;
+  wait_until(t);
+  line_release();
+  t += timing::SYNC;
+
+  for (int8_t i = 7; i >= 0; i--)
+    send_bit(&t, command & (1 << i));
+
+  // Bit de stop : un périphérique ayant des données le prolonge
+  uint32_t stop = t;
+  pulse_low(stop, timing::ZERO_LOW);
+  wait_until(stop + timing::ZERO_LOW + timing::SETTLE);
+  bool srq = !line_is_high();
+  uint32_t end;
+  if (srq)
+    wait_level(true, stop + timing::SRQ_MAX, &end);
+  return srq;
+}
+
+static void transaction_begin() {
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_PM_ENABLE)
+  esp_pm_lock_acquire(phy_pm_lock);
+#endif
+}
+
+static void transaction_end() {
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_PM_ENABLE)
+  esp_pm_lock_release(phy_pm_lock);
+#endif
+}
+
+void adb_phy_init(uint8_t pin) {
+  phy_pin = pin;
+
+#if defined(ARDUINO_ARCH_STM32)
+  pinMode(pin, OUTPUT_OPEN_DRAIN);
+  phy_port = digitalPinToPort(pin);
+  phy_mask = digitalPinToBitMask(pin);
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#elif defined(ARDUINO_ARCH_ESP32)
+  // GPIO.out_w1ts/in ne couvrent que les broches 0 à 31
+  phy_mask = 1UL << pin;
+  gpio_set_direction((gpio_num_t)pin, GPIO_MODE_INPUT_OUTPUT_OD);
+#ifdef CONFIG_PM_ENABLE
+  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "adb", &phy_pm_lock);
+#endif
+#endif
+  line_release();
+}
+
+void adb_phy_reset() {
+  transaction_begin();
+  uint32_t t = cycle_count();
+  line_low();
+  wait_until(t + timing::RESET);
+  line_release();
+  transaction_end();
+}
+
+bool adb_phy_command(uint8_t command) {
+  transaction_begin();
+  bool srq = send_command(command);
+  transaction_end();
+  return srq;
+}
+
+/**
+ * @brief Reçoit une trame : bit de start, données, bit de stop.
+ */
+static adb_result receive(uint8_t *buf, uint8_t max_len, uint8_t *len) {
+  uint32_t fall;
+  // Tlt : un périphérique sans donnée ne répond pas
+  if (!wait_level(false, cycle_count() + timing::TLT_MAX, &fall))
+    return ADB_RESULT_TIMEOUT;
+
+  uint16_t cells = 0;
+  for (;;) {
+    uint32_t rise, next_fall;
+    if (!wait_level(true, fall + timing::PHASE_MAX, &rise))
+      return ADB_RESULT_COLLISION; // Ligne maintenue basse
+
+    // Pas de nouveau front descendant : cette cellule était le bit de stop
+    if (!wait_level(false, rise + timing::PHASE_MAX, &next_fall))
+      break;
+
+    bool bit = timing::bit(rise - fall, next_fall - rise);
+    if (cells == 0) {
+      if (!bit)
+        return ADB_RESULT_BIT_TIMING; // Bit de start toujours à 1
+    } else {
+      uint16_t index = cells - 1;
+      if (index / 8 >= max_len)
+        return ADB_RESULT_BIT_TIMING;
+      if (bit)
+        buf[index / 8] |= 0x80 >> (index % 8);
+    }
+    cells++;
+    fall = next_fall;
+  }
+
+  uint16_t data_bits = cells > 0 ? cells - 1 : 0;
+  if (data_bits < 16 || data_bits % 8 != 0)
+    return ADB_RESULT_BIT_TIMING;
+  *len = data_bits / 8;
+  return ADB_RESULT_OK;
+}
+
+adb_result adb_phy_talk(uint8_t command, uint8_t *buf, uint8_t max_len,
+                        uint8_t *len) {
+  *len = 0;
+  memset(buf, 0, max_len);
+
+  transaction_begin();
+  send_command(command);
+  adb_result result = receive(buf, max_len, len);
+  transaction_end();
+  return result;
+}
+
+void adb_phy_listen(uint8_t command, const uint8_t *data, uint8_t len) {
+  transaction_begin();
+  send_command(command);
+
+  uint32_t t = cycle_count() + timing::LISTEN_TLT;
+  send_bit(&t, true); // Bit de start
+  for (uint8_t i = 0; i < len; i++)
+    for (int8_t b = 7; b >= 0; b--)
+      send_bit(&t, data[i] & (1 << b));
+  pulse_low(t, timing::ZERO_LOW); // Bit de stop
+  transaction_end();
+}
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file adb_phy.h
+ * @brief Couche physique ADB intégrée : accès direct aux registres GPIO et
+ * temporisation au compteur de cycles.
+ * @part of Apple-ADB-Ressurector
+ *
+ * La ligne est pilotée en drain ouvert par les registres du port (BSRR/IDR
+ * sur STM32, GPIO.out_w1ts/out_w1tc/in sur ESP32) et chaque front est placé
+ * ou mesuré au compteur de cycles (DWT->CYCCNT, CCOUNT). Les durées du
+ * protocole sont converties en cycles à la compilation à partir de l'horloge de la
+ * carte (adb_phy_timing, board.h), avec vérification des marges de décodage.
+ *
+ * Émission : échéances absolues, une interruption ne décale qu'un front sans
+ * cumul ; seule la phase basse de chaque bit est protégée des interruptions.
+ * Réception : un bit vaut 1 si sa phase basse est plus courte que sa phase
+ * haute, ce qui tolère la dérive d'horloge des périphériques (±30 %).
+ *
+ * Trames reçues de 2 à 8 octets : les tablettes répondent au registre 0 par
+ * des trames plus longues que les 16 bits habituels.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef ADB_PHY_H
+#define ADB_PHY_H
+
+#include "adb_stats.h"
+#include "board.h"
+#include <cstdint>
+
+/** Octet de commande Talk pour un registre d'un périphérique. */
+#define ADB_PHY_TALK(addr, reg) (uint8_t)(((addr) << 4) | 0x0C | (reg))
+/** Octet de commande Listen pour un registre d'un périphérique. */
+#define ADB_PHY_LISTEN(addr, reg) (uint8_t)(((addr) << 4) | 0x08 | (reg))
+
+/**
+ * Adresse sans périphérique (réservée à l'hôte) : une commande Talk vers
+ * elle ne reçoit aucune réponse, seul un SRQ signale des données en attente.
+ */
+#define ADB_PHY_SRQ_PROBE_ADDRESS 0
+
+/** Durées nominales du protocole (µs). */
+#define ADB_PHY_RESET_US 3000    /**< Reset global. */
+#define ADB_PHY_ATTENTION_US 800 /**< Attention avant une commande. */
+#define ADB_PHY_SYNC_US 70       /**< Synchronisation après l'attention. */
+#define ADB_PHY_CELL_US 100      /**< Cellule de bit. */
+#define ADB_PHY_ONE_LOW_US 35    /**< Phase basse d'un bit 1. */
+#define ADB_PHY_ZERO_LOW_US 65   /**< Phase basse d'un bit 0. */
+#define ADB_PHY_LISTEN_TLT_US 200 /**< Délai avant les données d'un Listen. */
+#define ADB_PHY_SRQ_US 300       /**< Bit de stop prolongé par un SRQ. */
+
+/** Tolérances et délais de réception (µs). */
+#define ADB_PHY_DEVICE_TOLERANCE_PCT 30 /**< Dérive d'un périphérique. */
+#define ADB_PHY_SETTLE_US 4    /**< Remontée de la ligne par le tirage. */
+#define ADB_PHY_TLT_MAX_US 270 /**< Tlt maximal (260 µs) plus marge. */
+/** Phase maximale d'une cellule : bit 0 le plus lent plus marge. */
+#define ADB_PHY_PHASE_MAX_US 90
+#define ADB_PHY_SRQ_MAX_US 340 /**< Fin du bit de stop, SRQ compris. */
+
+/**
+ * Cycles d'une itération de la boucle d'échantillonnage (lecture du port et
+ * du compteur, comparaison) : résolution de la mesure d'un front.
+ */
+#define ADB_PHY_LOOP_CYCLES 24
+
+/**
+ * @struct adb_phy_timing
+ * @brief Durées du protocole en cycles d'une horloge donnée, vérifiées à la
+ * compilation.
+ *
+ * @tparam ClockHz Fréquence du compteur de cycles.
+ */
+template <uint32_t ClockHz> struct adb_phy_timing {
+  /** Conversion µs → cycles. */
+  static constexpr uint32_t cycles(uint32_t us) {
+    return (uint32_t)((uint64_t)ClockHz * us / 1000000UL);
+  }
+
+  static constexpr uint32_t RESET = cycles(ADB_PHY_RESET_US);
+  static constexpr uint32_t ATTENTION = cycles(ADB_PHY_ATTENTION_US);
+  static constexpr uint32_t SYNC = cycles(ADB_PHY_SYNC_US);
+  static constexpr uint32_t CELL = cycles(ADB_PHY_CELL_US);
+  static constexpr uint32_t ONE_LOW = cycles(ADB_PHY_ONE_LOW_US);
+  static constexpr uint32_t ZERO_LOW = cycles(ADB_PHY_ZERO_LOW_US);
+  static constexpr uint32_t LISTEN_TLT = cycles(ADB_PHY_LISTEN_TLT_US);
+  static constexpr uint32_t SETTLE = cycles(ADB_PHY_SETTLE_US);
+  static constexpr uint32_t TLT_MAX = cycles(ADB_PHY_TLT_MAX_US);
+  static constexpr uint32_t PHASE_MAX = cycles(ADB_PHY_PHASE_MAX_US);
+  static constexpr uint32_t SRQ_MAX = cycles(ADB_PHY_SRQ_MAX_US);
+
+  /** Résolution d'une mesure : une itération, au moins un cycle d'horloge. */
+  static constexpr uint32_t RESOLUTION =
+      ClockHz >= 8000000UL ? ADB_PHY_LOOP_CYCLES : 1;
+
+  /** Écart minimal entre phases basse et haute d'un bit reçu. */
+  static constexpr uint32_t BIT_MARGIN =
+      (uint32_t)((uint64_t)(ZERO_LOW - ONE_LOW) *
+                 (100 - ADB_PHY_DEVICE_TOLERANCE_PCT) / 100);
+
+  /** Phase la plus longue d'un périphérique lent. */
+  static constexpr uint32_t PHASE_SLOWEST =
+      (uint32_t)((uint64_t)ZERO_LOW * (100 + ADB_PHY_DEVICE_TOLERANCE_PCT) /
+                 100);
+
+  static_assert(ClockHz >= 1000000UL, "Horloge ADB inférieure à 1 MHz");
+  static_assert(ONE_LOW < ZERO_LOW && ZERO_LOW < CELL,
+                "Cellules de bit indistinctes à cette horloge");
+  static_assert(BIT_MARGIN > 2 * RESOLUTION,
+                "Marge de décodage des bits insuffisante");
+  static_assert(PHASE_SLOWEST + RESOLUTION < PHASE_MAX,
+                "Délai de phase trop court pour un périphérique lent");
+  static_assert(PHASE_MAX < SRQ_MAX, "SRQ confondu avec une phase de bit");
+  static_assert(RESET < 0x80000000UL,
+                "Compteur de cycles replié pendant un reset");
+
+  /** Décodage d'un bit reçu à partir de ses deux phases. */
+  static constexpr bool bit(uint32_t low, uint32_t high) { return low < high; }
+};
+
+/** Table de l'horloge d'une carte (Board::clock_hz). */
+template <typename Board>
+using adb_phy_board_timing = adb_phy_timing<Board::clock_hz>;
+
+/**
+ * Table de la carte de la cible. Les fonctions ci-dessous pilotent les
+ * registres de cette seule carte et restent compilées pour elle.
+ */
+typedef adb_phy_board_timing<board> adb_phy_clock;
+
+#ifdef ARDUINO
+/**
+ * @brief Configure la broche en drain ouvert et démarre le compteur.
+ *
+ * @param pin Broche de la ligne ADB.
+ */
+void adb_phy_init(uint8_t pin);
+
+/**
+ * @brief Reset global du bus (ligne basse 3 ms).
+ */
+void adb_phy_reset();
+
+/**
+ * @brief Émet une commande seule et relève une éventuelle demande de
+ * service.
+ *
+ * @param command Octet de commande.
+ * @return true si un périphérique a prolongé le bit de stop (SRQ).
+ */
+bool adb_phy_command(uint8_t command);
+
+/**
+ * @brief Émet une commande Talk et reçoit la réponse.
+ *
+ * @param command Octet de commande (voir ADB_PHY_TALK).
+ * @param buf Destination des octets reçus (ordre du bus).
+ * @param max_len Taille du tampon.
+ * @param len Nombre d'octets reçus.
+ * @return ADB_RESULT_TIMEOUT sans réponse, ADB_RESULT_COLLISION si la ligne
+ * reste basse, ADB_RESULT_BIT_TIMING si la trame est invalide (bit de start,
+ * longueur non multiple de 8, trop longue).
+ */
+adb_result adb_phy_talk(uint8_t command, uint8_t *buf, uint8_t max_len,
+                        uint8_t *len);
+
+/**
+ * @brief Émet une commande Listen suivie des données.
+ *
+ * @param command Octet de commande (voir ADB_PHY_LISTEN).
+ * @param data Octets à écrire (ordre du bus).
+ * @param len Nombre d'octets (2 à 8).
+ */
+void adb_phy_listen(uint8_t command, const uint8_t *data, uint8_t len);
+#endif
+
+#endif // ADB_PHY_H
@@ -0,0 +1,53 @@
+/**
+ * @file adb_sniff_decode.cpp
+ * @brief Outil hôte : transforme le flux binaire de l'analyseur ADB en
+ * journal de transactions lisible.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Compilé uniquement dans l'environnement `sniff_decoder` :
+ *
+ *     pio run -e sniff_decoder
+ *     stty -F /dev/ttyUSB0 460800 raw
+ *     .pio/build/sniff_decoder/program /dev/ttyUSB0
+ *
+ * Sans argument, le flux est lu sur l'entrée standard (capture enregistrée).
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifdef ADB_SNIFF_DECODER
+
+#include "adb_sniffer.h"
+#include <cstdio>
+
+int main(int argc, char **argv) {
+  FILE *input = stdin;
+  if (argc > 1) {
+    input = fopen(argv[1], "rb");
+    if (input == nullptr) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  adb_sniff_stream stream = {};
+  adb_sniff_event event;
+  char line[96];
+  int byte;
+  while ((byte = fgetc(input)) != EOF) {
+    if (!adb_sniff_stream_feed(&stream, (uint8_t)byte, &event))
+      continue;
+    adb_sniff_format(event, line, sizeof(line));
+    puts(line);
+    fflush(stdout);
+  }
+
+  if (input != stdin)
+    fclose(input);
+  return 0;
+}
+
+#endif // ADB_SNIFF_DECODER
@@ -0,0 +1,398 @@
+/**
+ * @file adb_sniffer.cpp
+ * @brief Implémentation de l'analyseur passif du bus ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "adb_sniffer.h"
+#include <cstdio>
+#include <cstring>
+
+/** États du décodeur. */
+enum : uint8_t {
+  SNIFF_IDLE = 0,  /**< Ligne au repos ou élément inconnu. */
+  SNIFF_COMMAND,   /**< Bits de commande après une attention. */
+  SNIFF_WAIT_DATA, /**< Délai Tlt après le bit de stop de la commande. */
+  SNIFF_DATA       /**< Trame de données en cours. */
+};
+
+#define SNIFF_RAW_BITS_MAX (sizeof(((adb_sniff_decoder *)0)->bits) * 8)
+
+static void emit(adb_sniff_decoder *d, uint8_t type, uint32_t t_us,
+                 const uint8_t *data, uint8_t len) {
+  if (d->sink == nullptr)
+    return;
+  adb_sniff_event event = {};
+  event.timestamp_us = t_us;
+  event.type = type;
+  event.len = len;
+  if (len > 0)
+    memcpy(event.data, data, len);
+  d->sink(event, d->ctx);
+}
+
+static void emit_error(adb_sniff_decoder *d, uint8_t code) {
+  uint8_t data[2] = {code, d->bit_count};
+  emit(d, ADB_SNIFF_ERROR, d->frame_start_us, data, sizeof(data));
+  d->state = SNIFF_IDLE;
+  d->bit_count = 0;
+}
+
+static void push_bit(adb_sniff_decoder *d, bool bit) {
+  if (d->bit_count >= SNIFF_RAW_BITS_MAX)
+    return;
+  uint8_t mask = 0x80 >> (d->bit_count % 8);
+  if (bit)
+    d->bits[d->bit_count / 8] |= mask;
+  else
+    d->bits[d->bit_count / 8] &= ~mask;
+  d->bit_count++;
+}
+
+static bool raw_bit(const adb_sniff_decoder *d, uint8_t index) {
+  return d->bits[index / 8] & (0x80 >> (index % 8));
+}
+
+/**
+ * @brief Émet la trame en cours : bit de start et bit de stop retirés.
+ */
+static void flush_frame(adb_sniff_decoder *d) {
+  if (d->state != SNIFF_DATA) {
+    if (d->state == SNIFF_WAIT_DATA)
+      d->state = SNIFF_IDLE; // Pas de réponse au Talk
+    return;
+  }
+
+  uint8_t data_bits = d->bit_count >= 2 ? d->bit_count - 2 : 0;
+  if (data_bits < 8 || data_bits % 8 != 0 ||
+      data_bits > ADB_SNIFF_PAYLOAD_MAX * 8 || !raw_bit(d, 0)) {
+    emit_error(d, ADB_SNIFF_ERR_LENGTH);
+    return;
+  }
+
+  uint8_t bytes[ADB_SNIFF_PAYLOAD_MAX] = {0};
+  for (uint8_t i = 0; i < data_bits; i++)
+    if (raw_bit(d, i + 1))
+      bytes[i / 8] |= 0x80 >> (i % 8);
+  emit(d, ADB_SNIFF_DATA, d->frame_start_us, bytes, data_bits / 8);
+  d->state = SNIFF_IDLE;
+  d->bit_count = 0;
+}
+
+/**
+ * @brief Fin d'une phase basse : attention, reset, SRQ ou bit.
+ */
+static void on_low(adb_sniff_decoder *d, uint32_t duration, uint32_t start) {
+  if (duration >= ADB_SNIFF_RESET_MIN_US) {
+    flush_frame(d);
+    emit(d, ADB_SNIFF_RESET, start, nullptr, 0);
+    d->state = SNIFF_IDLE;
+    return;
+  }
+
+  if (duration >= ADB_SNIFF_ATTN_MIN_US && duration <= ADB_SNIFF_ATTN_MAX_US) {
+    flush_frame(d);
+    d->state = SNIFF_COMMAND;
+    d->bit_count = 0;
+    d->frame_start_us = start;
+    return;
+  }
+
+  switch (d->state) {
+  case SNIFF_COMMAND:
+    if (d->bit_count < 8) {
+      if (duration > ADB_SNIFF_BIT_MAX_US) {
+        emit_error(d, ADB_SNIFF_ERR_BIT_TIMING);
+        return;
+      }
+      push_bit(d, duration < ADB_SNIFF_BIT_ONE_MAX_US);
+      return;
+    }
+    // Bit de stop : un périphérique le prolonge pour demander un service
+    {
+      uint8_t data[2] = {d->bits[0], duration >= ADB_SNIFF_SRQ_MIN_US};
+      emit(d, ADB_SNIFF_COMMAND, d->frame_start_us, data, sizeof(data));
+    }
+    d->state = SNIFF_WAIT_DATA;
+    d->bit_count = 0;
+    return;
+  case SNIFF_WAIT_DATA:
+    d->state = SNIFF_DATA;
+    d->frame_start_us = start;
+    // fallthrough
+  case SNIFF_DATA:
+    if (duration > ADB_SNIFF_BIT_MAX_US) {
+      emit_error(d, ADB_SNIFF_ERR_BIT_TIMING);
+      return;
+    }
+    push_bit(d, duration < ADB_SNIFF_BIT_ONE_MAX_US);
+    return;
+  default:
+    return;
+  }
+}
+
+/**
+ * @brief Fin d'une phase haute : une ligne longtemps haute clôt la trame.
+ */
+static void on_high(adb_sniff_decoder *d, uint32_t duration) {
+  if (d->state == SNIFF_DATA && duration > ADB_SNIFF_FRAME_GAP_US)
+    flush_frame(d);
+  else if (d->state == SNIFF_WAIT_DATA && duration > ADB_SNIFF_TLT_MAX_US)
+    d->state = SNIFF_IDLE;
+}
+
+void adb_sniff_decoder_init(adb_sniff_decoder *decoder, adb_sniff_sink sink,
+                            void *ctx) {
+  memset(decoder, 0, sizeof(*decoder));
+  decoder->level = 1;
+  decoder->sink = sink;
+  decoder->ctx = ctx;
+}
+
+void adb_sniff_decoder_edge(adb_sniff_decoder *decoder, uint8_t level,
+                            uint32_t t_us) {
+  level = level ? 1 : 0;
+  if (level == decoder->level)
+    return; // Front manqué : on attend le suivant
+
+  uint32_t duration = t_us - decoder->phase_start_us;
+  uint32_t start = decoder->phase_start_us;
+  decoder->level = level;
+  decoder->phase_start_us = t_us;
+
+  if (level)
+    on_low(decoder, duration, start);
+  else
+    on_high(decoder, duration);
+}
+
+void adb_sniff_decoder_idle(adb_sniff_decoder *decoder, uint32_t now_us) {
+  if (decoder->level)
+    on_high(decoder, now_us - decoder->phase_start_us);
+}
+
+size_t adb_sniff_encode(const adb_sniff_event &event, uint8_t *buf,
+                        size_t cap) {
+  uint8_t len = event.len > ADB_SNIFF_PAYLOAD_MAX ? ADB_SNIFF_PAYLOAD_MAX
+                                                  : event.len;
+  if (cap < (size_t)ADB_SNIFF_HEADER_LEN + len)
+    return 0;
+
+  buf[0] = ADB_SNIFF_SYNC;
+  buf[1] = event.type;
+  buf[2] = len;
+  for (uint8_t i = 0; i < 4; i++)
+    buf[3 + i] = (uint8_t)(event.timestamp_us >> (8 * i));
+  memcpy(buf + ADB_SNIFF_HEADER_LEN, event.data, len);
+  return ADB_SNIFF_HEADER_LEN + len;
+}
+
+bool adb_sniff_stream_feed(adb_sniff_stream *stream, uint8_t byte,
+                           adb_sniff_event *event) {
+  // Resynchronisation : on ne démarre un enregistrement que sur l'octet
+  // de synchronisation, et on rejette les en-têtes incohérents
+  if (stream->pos == 0 && byte != ADB_SNIFF_SYNC)
+    return false;
+  if (stream->pos == 1 && (byte < ADB_SNIFF_RESET || byte > ADB_SNIFF_OVERFLOW)) {
+    stream->pos = byte == ADB_SNIFF_SYNC ? 1 : 0;
+    return false;
+  }
+  if (stream->pos == 2 && byte > ADB_SNIFF_PAYLOAD_MAX) {
+    stream->pos = byte == ADB_SNIFF_SYNC ? 1 : 0;
+    return false;
+  }
+
+  stream->buf[stream->pos++] = byte;
+  if (stream->pos < ADB_SNIFF_HEADER_LEN ||
+      stream->pos < ADB_SNIFF_HEADER_LEN + stream->buf[2])
+    return false;
+
+  event->type = stream->buf[1];
+  event->len = stream->buf[2];
+  event->timestamp_us = 0;
+  for (uint8_t i = 0; i < 4; i++)
+    event->timestamp_us |= (uint32_t)stream->buf[3 + i] << (8 * i);
+  memcpy(event->data, stream->buf + ADB_SNIFF_HEADER_LEN, event->len);
+  stream->pos = 0;
+  return true;
+}
+
+size_t adb_sniff_format(const adb_sniff_event &event, char *buf, size_t len) {
+  static const char *const command_names[4] = {"Reset", "Flush", "Listen",
+                                                "Talk"};
+  if (len == 0)
+    return 0;
+
+  int n = snprintf(buf, len, "%8lu.%03lu ms  ",
+                   (unsigned long)(event.timestamp_us / 1000),
+                   (unsigned long)(event.timestamp_us % 1000));
+  size_t pos = n < 0 ? 0 : ((size_t)n < len ? (size_t)n : len - 1);
+
+  switch (event.type) {
+  case ADB_SNIFF_RESET:
+    n = snprintf(buf + pos, len - pos, "RESET");
+    break;
+  case ADB_SNIFF_COMMAND: {
+    uint8_t command = event.data[0];
+    uint8_t kind = (command >> 2) & 0x03;
+    // SendReset (0000) et Flush (0001) partagent le code 00
+    const char *name = kind == 0 ? command_names[command & 0x01]
+                                 : command_names[kind];
+    n = snprintf(buf + pos, len - pos, "%-6s adr %u reg %u%s", name,
+                 command >> 4, command & 0x03,
+                 event.len > 1 && event.data[1] ? "  SRQ" : "");
+    break;
+  }
+  case ADB_SNIFF_DATA:
+    n = snprintf(buf + pos, len - pos, "  data");
+    for (uint8_t i = 0; i < event.len && n >= 0; i++) {
+      pos += (size_t)n < len - pos ? (size_t)n : len - pos - 1;
+      n = snprintf(buf + pos, len - pos, " %02X", event.data[i]);
+    }
+    break;
+  case ADB_SNIFF_ERROR:
+    n = snprintf(buf + pos, len - pos, "ERREUR %s (%u bits)",
+                 event.data[0] == ADB_SNIFF_ERR_BIT_TIMING ? "timing"
+                                                           : "longueur",
+                 event.data[1]);
+    break;
+  case ADB_SNIFF_OVERFLOW:
+    n = snprintf(buf + pos, len - pos, "PERTE fronts=%u enreg=%u",
+                 event.data[0] | event.data[1] << 8,
+                 event.data[2] | event.data[3] << 8);
+    break;
+  default:
+    n = snprintf(buf + pos, len - pos, "? type %u", event.type);
+    break;
+  }
+  if (n > 0)
+    pos += (size_t)n < len - pos ? (size_t)n : len - pos - 1;
+  return pos;
+}
+
+#ifdef ARDUINO
+#include "spsc_ring.h"
+#include <Arduino.h>
+
+// Front : bit 31 = niveau après le front, bits 0-30 = compteur de cycles
+#define SNIFF_LEVEL_BIT 0x80000000u
+#define SNIFF_TICK_MASK 0x7FFFFFFFu
+
+static SpscRing<uint32_t, ADB_SNIFF_EDGE_RING> edges;
+static uint8_t sniff_pin;
+static uint32_t ticks_per_us = 1;
+static uint32_t last_ticks = 0;
+static uint64_t total_ticks = 0;
+static adb_sniff_decoder decoder;
+static uint32_t edges_reported = 0;
+static uint32_t records_lost = 0;
+
+static inline uint32_t cycle_count() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return ESP.getCycleCount();
+#elif defined(ADB_SIM)
+  return micros(); // Horloge virtuelle : un cycle par µs
+#else
+  return DWT->CYCCNT;
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+static void IRAM_ATTR on_edge() {
+#else
+static void on_edge() {
+#endif
+  uint32_t ticks = cycle_count() & SNIFF_TICK_MASK;
+  edges.push(digitalRead(sniff_pin) ? (ticks | SNIFF_LEVEL_BIT) : ticks);
+}
+
+/**
+ * @brief Convertit un compteur de cycles en µs depuis le début de capture.
+ */
+static uint32_t advance(uint32_t ticks) {
+  total_ticks += (ticks - last_ticks) & SNIFF_TICK_MASK;
+  last_ticks = ticks;
+  return (uint32_t)(total_ticks / ticks_per_us);
+}
+
+/**
+ * @brief Envoie un enregistrement, ou le compte s'il ne tient pas.
+ */
+static bool write_record(const adb_sniff_event &event) {
+  uint8_t record[ADB_SNIFF_RECORD_MAX];
+  size_t n = adb_sniff_encode(event, record, sizeof(record));
+  if ((size_t)Serial.availableForWrite() < n)
+    return false;
+  Serial.write(record, n);
+  return true;
+}
+
+static void send_event(const adb_sniff_event &event, void *) {
+  uint32_t edges_lost = edges.overflows() - edges_reported;
+  if (edges_lost > 0 || records_lost > 0) {
+    adb_sniff_event loss = {};
+    loss.timestamp_us = event.timestamp_us;
+    loss.type = ADB_SNIFF_OVERFLOW;
+    loss.len = 4;
+    loss.data[0] = edges_lost & 0xFF;
+    loss.data[1] = edges_lost > 0xFFFF ? 0xFF : edges_lost >> 8;
+    loss.data[2] = records_lost & 0xFF;
+    loss.data[3] = records_lost > 0xFFFF ? 0xFF : records_lost >> 8;
+    if (!write_record(loss)) {
+      records_lost++;
+      return;
+    }
+    edges_reported += edges_lost;
+    records_lost = 0;
+  }
+
+  if (!write_record(event))
+    records_lost++;
+}
+
+void adb_sniffer_begin(uint8_t pin) {
+  sniff_pin = pin;
+  // Écoute seule : la résistance de tirage est celle de l'hôte
+  pinMode(pin, INPUT);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  ticks_per_us = getCpuFrequencyMhz();
+#elif defined(ADB_SIM)
+  ticks_per_us = 1;
+#else
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  ticks_per_us = SystemCoreClock / 1000000;
+#endif
+
+  adb_sniff_decoder_init(&decoder, send_event, nullptr);
+  last_ticks = cycle_count() & SNIFF_TICK_MASK;
+  attachInterrupt(digitalPinToInterrupt(pin), on_edge, CHANGE);
+}
+
+void adb_sniffer_service() {
+  // Lecture du compteur avant la file : un front capturé ensuite est
+  // forcément postérieur
+  uint32_t now_ticks = cycle_count() & SNIFF_TICK_MASK;
+
+  uint32_t edge;
+  bool any = false;
+  while (edges.pop(edge)) {
+    any = true;
+    adb_sniff_decoder_edge(&decoder, (edge & SNIFF_LEVEL_BIT) ? 1 : 0,
+                           advance(edge & SNIFF_TICK_MASK));
+  }
+
+  // Bus silencieux : suivi du temps (évite le repliement du compteur) et
+  // clôture de la dernière trame
+  if (!any)
+    adb_sniff_decoder_idle(&decoder, advance(now_ticks));
+}
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file adb_sniffer.h
+ * @brief Analyseur passif du bus ADB : capture des fronts, décodage des
+ * transactions et flux binaire compact.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Choisi au démarrage (broche SNIFFER_PIN à la masse), ce mode n'émet rien
+ * sur le bus. Chaque front de ADB_PIN est horodaté par le compteur de cycles
+ * dans une interruption et déposé dans une file sans verrou ; la boucle
+ * principale décode attentions, resets, commandes, SRQ et trames de données,
+ * puis les envoie sur le port série sous forme d'enregistrements :
+ *
+ * | Octet | Contenu                                   |
+ * |-------|-------------------------------------------|
+ * | 0     | ADB_SNIFF_SYNC                            |
+ * | 1     | Type (adb_sniff_type)                     |
+ * | 2     | Longueur de la charge utile (0..8)        |
+ * | 3-6   | Horodatage en µs (petit-boutiste)         |
+ * | 7-    | Charge utile                              |
+ *
+ * Le décodeur et le format du flux sont portables : l'outil hôte
+ * (adb_sniff_decode.cpp, environnement `sniff_decoder`) les réutilise.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef ADB_SNIFFER_H
+#define ADB_SNIFFER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define ADB_SNIFF_SYNC 0xA5        /**< Premier octet d'un enregistrement. */
+#define ADB_SNIFF_HEADER_LEN 7     /**< Octets avant la charge utile. */
+#define ADB_SNIFF_PAYLOAD_MAX 8    /**< Charge utile maximale. */
+#define ADB_SNIFF_RECORD_MAX (ADB_SNIFF_HEADER_LEN + ADB_SNIFF_PAYLOAD_MAX)
+#define ADB_SNIFF_EDGE_RING 512    /**< Fronts en attente (puissance de 2). */
+#define ADB_SNIFF_BAUD 460800      /**< Débit série en mode analyseur. */
+
+/** Seuils de décodage (µs), tolérances du protocole incluses. */
+#define ADB_SNIFF_BIT_ONE_MAX_US 50   /**< Phase basse d'un bit 1. */
+#define ADB_SNIFF_BIT_MAX_US 110      /**< Phase basse d'un bit 0. */
+#define ADB_SNIFF_SRQ_MIN_US 140      /**< Bit de stop prolongé : SRQ. */
+#define ADB_SNIFF_ATTN_MIN_US 500     /**< Attention (nominal 800 µs). */
+#define ADB_SNIFF_ATTN_MAX_US 1100
+#define ADB_SNIFF_RESET_MIN_US 2800   /**< Reset (nominal 3 ms). */
+#define ADB_SNIFF_FRAME_GAP_US 140    /**< Ligne haute : fin de trame. */
+#define ADB_SNIFF_TLT_MAX_US 300      /**< Attente maximale d'une réponse. */
+
+/**
+ * @enum adb_sniff_type
+ * @brief Nature d'un enregistrement.
+ */
+enum adb_sniff_type : uint8_t {
+  ADB_SNIFF_RESET = 1, /**< Reset global du bus. */
+  ADB_SNIFF_COMMAND,   /**< data[0] = commande, data[1] = SRQ. */
+  ADB_SNIFF_DATA,      /**< Trame de données (2 à 8 octets). */
+  ADB_SNIFF_ERROR,     /**< data[0] = adb_sniff_error, data[1] = bits. */
+  ADB_SNIFF_OVERFLOW   /**< data[0..1] = fronts, data[2..3] = enreg. perdus. */
+};
+
+/**
+ * @enum adb_sniff_error
+ * @brief Causes d'erreur de décodage.
+ */
+enum adb_sniff_error : uint8_t {
+  ADB_SNIFF_ERR_BIT_TIMING = 1, /**< Phase basse hors tolérance. */
+  ADB_SNIFF_ERR_LENGTH          /**< Trame non multiple de 8 bits. */
+};
+
+/**
+ * @struct adb_sniff_event
+ * @brief Élément décodé.
+ */
+struct adb_sniff_event {
+  uint32_t timestamp_us; /**< Début de l'élément sur le bus. */
+  uint8_t type;          /**< Voir adb_sniff_type. */
+  uint8_t len;           /**< Octets utiles de data. */
+  uint8_t data[ADB_SNIFF_PAYLOAD_MAX];
+};
+
+typedef void (*adb_sniff_sink)(const adb_sniff_event &event, void *ctx);
+
+/**
+ * @struct adb_sniff_decoder
+ * @brief État du décodeur de fronts.
+ */
+struct adb_sniff_decoder {
+  uint8_t state;
+  uint8_t level;
+  uint32_t phase_start_us;
+  uint32_t frame_start_us;
+  uint8_t bits[9];
+  uint8_t bit_count;
+  adb_sniff_sink sink;
+  void *ctx;
+};
+
+/**
+ * @brief Initialise le décodeur (ligne supposée au repos, niveau haut).
+ */
+void adb_sniff_decoder_init(adb_sniff_decoder *decoder, adb_sniff_sink sink,
+                            void *ctx);
+
+/**
+ * @brief Traite un front.
+ *
+ * @param level Niveau de la ligne après le front.
+ * @param t_us Instant du front.
+ */
+void adb_sniff_decoder_edge(adb_sniff_decoder *decoder, uint8_t level,
+                            uint32_t t_us);
+
+/**
+ * @brief Termine la trame en cours si la ligne est au repos depuis assez
+ * longtemps.
+ */
+void adb_sniff_decoder_idle(adb_sniff_decoder *decoder, uint32_t now_us);
+
+/**
+ * @brief Sérialise un élément.
+ *
+ * @return Nombre d'octets écrits, 0 si le tampon est trop petit.
+ */
+size_t adb_sniff_encode(const adb_sniff_event &event, uint8_t *buf,
+                        size_t cap);
+
+/**
+ * @struct adb_sniff_stream
+ * @brief Analyseur de flux octet par octet (resynchronisation sur
+ * ADB_SNIFF_SYNC).
+ */
+struct adb_sniff_stream {
+  uint8_t buf[ADB_SNIFF_RECORD_MAX];
+  uint8_t pos;
+};
+
+/**
+ * @brief Ajoute un octet du flux.
+ *
+ * @return true lorsqu'un enregistrement complet est disponible dans event.
+ */
+bool adb_sniff_stream_feed(adb_sniff_stream *stream, uint8_t byte,
+                           adb_sniff_event *event);
+
+/**
+ * @brief Formate un élément en une ligne lisible.
+ *
+ * Exemple : `    1234.567 ms  Talk   adr 3 reg 0  SRQ`
+ *
+ * @return Nombre de caractères écrits (hors zéro terminal).
+ */
+size_t adb_sniff_format(const adb_sniff_event &event, char *buf, size_t len);
+
+#ifdef ARDUINO
+/**
+ * @brief Passe en mode analyseur : broche en entrée, capture des fronts.
+ */
+void adb_sniffer_begin(uint8_t pin);
+
+/**
+ * @brief Décode les fronts capturés et envoie les enregistrements.
+ *
+ * Non bloquant : un enregistrement qui ne tient pas dans le tampon série
+ * est compté puis signalé par un enregistrement ADB_SNIFF_OVERFLOW.
+ */
+void adb_sniffer_service();
+#endif
+
+#endif // ADB_SNIFFER_H
@@ -0,0 +1,134 @@
+/**
+ * @file adb_stats.cpp
+ * @brief Implémentation des statistiques d'erreurs du bus ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "adb_stats.h"
+#include <cstdio>
+
+static adb_device_stats stats[ADB_STATS_DEVICE_COUNT];
+
+static const char *const device_names[ADB_STATS_DEVICE_COUNT] = {
+    "kbd", "mse", "tab", "joy"};
+
+adb_result adb_stats_classify(bool error, uint32_t elapsed_us, bool line_low) {
+  if (!error)
+    return ADB_RESULT_OK;
+
+  // Un autre émetteur tient encore la ligne : deux périphériques ont répondu
+  if (line_low)
+    return ADB_RESULT_COLLISION;
+
+  // Échec avant la fin du délai Tlt : le périphérique n'a pas répondu
+  if (elapsed_us < ADB_NO_RESPONSE_MAX_US)
+    return ADB_RESULT_TIMEOUT;
+
+  return ADB_RESULT_BIT_TIMING;
+}
+
+void adb_stats_record(uint8_t device, adb_result result) {
+  if (device >= ADB_STATS_DEVICE_COUNT)
+    return;
+
+  adb_device_stats &s = stats[device];
+  switch (result) {
+  case ADB_RESULT_OK:
+    s.frames_ok++;
+    s.consecutive_errors = 0;
+    s.backoff_skip = 0;
+    return;
+  case ADB_RESULT_TIMEOUT:
+    // Un périphérique sans donnée à transmettre ne répond pas : ce n'est pas
+    // une erreur du lien, on ne fait que compter.
+    s.timeouts++;
+    return;
+  case ADB_RESULT_BIT_TIMING:
+    s.bit_errors++;
+    break;
+  case ADB_RESULT_COLLISION:
+    s.collisions++;
+    break;
+  }
+
+  if (s.consecutive_errors < UINT8_MAX)
+    s.consecutive_errors++;
+
+  // Erreur persistante : recul exponentiel borné
+  if (s.consecutive_errors >= ADB_ERROR_PERSISTENT) {
+    uint8_t shift = s.consecutive_errors - ADB_ERROR_PERSISTENT + 1;
+    uint16_t skip = shift >= 7 ? ADB_BACKOFF_MAX_POLLS : (1u << shift);
+    s.backoff_skip = skip > ADB_BACKOFF_MAX_POLLS ? ADB_BACKOFF_MAX_POLLS : skip;
+    s.backoffs++;
+  }
+}
+
+bool adb_stats_should_retry(uint8_t device, adb_result result, uint8_t attempt,
+                            uint32_t elapsed_us) {
+  if (device >= ADB_STATS_DEVICE_COUNT)
+    return false;
+
+  if (result == ADB_RESULT_OK || result == ADB_RESULT_TIMEOUT)
+    return false;
+
+  adb_device_stats &s = stats[device];
+  if (s.consecutive_errors >= ADB_ERROR_PERSISTENT)
+    return false;
+  if (attempt >= ADB_RETRY_MAX || elapsed_us >= ADB_POLL_BUDGET_US)
+    return false;
+
+  s.retries++;
+  return true;
+}
+
+bool adb_stats_should_poll(uint8_t device) {
+  if (device >= ADB_STATS_DEVICE_COUNT)
+    return false;
+
+  adb_device_stats &s = stats[device];
+  if (s.backoff_skip == 0)
+    return true;
+
+  s.backoff_skip--;
+  return false;
+}
+
+const adb_device_stats *adb_stats_get(uint8_t device) {
+  if (device >= ADB_STATS_DEVICE_COUNT)
+    return nullptr;
+  return &stats[device];
+}
+
+void adb_stats_reset() {
+  for (uint8_t i = 0; i < ADB_STATS_DEVICE_COUNT; i++)
+    stats[i] = adb_device_stats();
+}
+
+size_t adb_stats_format(char *buf, size_t len) {
+  if (len == 0)
+    return 0;
+
+  size_t pos = 0;
+  int n = snprintf(buf, len, "ADB");
+  if (n > 0)
+    pos = (size_t)n < len ? (size_t)n : len - 1;
+
+  for (uint8_t i = 0; i < ADB_STATS_DEVICE_COUNT && pos < len - 1; i++) {
+    const adb_device_stats &s = stats[i];
+    n = snprintf(buf + pos, len - pos,
+                 "%s %s ok=%lu to=%lu bt=%lu col=%lu rt=%lu bo=%lu",
+                 i == 0 ? "" : " |", device_names[i],
+                 (unsigned long)s.frames_ok, (unsigned long)s.timeouts,
+                 (unsigned long)s.bit_errors, (unsigned long)s.collisions,
+                 (unsigned long)s.retries, (unsigned long)s.backoffs);
+    if (n < 0)
+      break;
+    pos += (size_t)n < len - pos ? (size_t)n : len - pos - 1;
+  }
+  return pos;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file adb_stats.h
+ * @brief Statistiques d'erreurs du bus ADB et politique de relance adaptative.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef ADB_STATS_H
+#define ADB_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** Nombre maximum de relances immédiates pour une erreur transitoire. */
+#define ADB_RETRY_MAX 2
+/** Budget (µs) d'une interrogation, relances comprises. */
+#define ADB_POLL_BUDGET_US 3000
+/** Nombre d'erreurs consécutives à partir duquel une erreur est persistante. */
+#define ADB_ERROR_PERSISTENT 4
+/** Nombre maximum d'interrogations sautées en phase de recul. */
+#define ADB_BACKOFF_MAX_POLLS 64
+
+/**
+ * @brief Durée (µs) au-delà de laquelle une erreur n'est plus une absence de
+ * réponse : commande (~1730 µs) + Tlt maximal (260 µs) + bit de start.
+ */
+#define ADB_NO_RESPONSE_MAX_US 2100
+
+/**
+ * @enum adb_stats_device
+ * @brief Périphériques suivis par les statistiques.
+ */
+enum adb_stats_device : uint8_t {
+  ADB_STATS_KEYBOARD = 0,
+  ADB_STATS_MOUSE,
+  ADB_STATS_TABLET,
+  ADB_STATS_JOYSTICK,
+  ADB_STATS_DEVICE_COUNT
+};
+
+/**
+ * @enum adb_result
+ * @brief Résultat classé d'une transaction ADB.
+ */
+enum adb_result : uint8_t {
+  ADB_RESULT_OK = 0,     /**< Trame reçue correctement. */
+  ADB_RESULT_TIMEOUT,    /**< Aucune réponse (périphérique muet ou absent). */
+  ADB_RESULT_BIT_TIMING, /**< Cellule de bit hors tolérance en cours de trame. */
+  ADB_RESULT_COLLISION   /**< Ligne maintenue basse par un autre émetteur. */
+};
+
+/**
+ * @struct adb_device_stats
+ * @brief Compteurs et état de la politique de relance d'un périphérique.
+ */
+struct adb_device_stats {
+  uint32_t frames_ok = 0;  /**< Trames reçues sans erreur. */
+  uint32_t timeouts = 0;   /**< Transactions sans réponse. */
+  uint32_t bit_errors = 0; /**< Erreurs de timing de bit. */
+  uint32_t collisions = 0; /**< Collisions détectées. */
+  uint32_t retries = 0;    /**< Relances immédiates effectuées. */
+  uint32_t backoffs = 0;   /**< Entrées en phase de recul. */
+  uint8_t consecutive_errors = 0; /**< Erreurs consécutives (hors timeouts). */
+  uint8_t backoff_skip = 0;       /**< Interrogations restant à sauter. */
+};
+
+/**
+ * @brief Classe le résultat d'une transaction à partir des observations.
+ *
+ * @param error Indicateur d'erreur retourné par la bibliothèque ADB.
+ * @param elapsed_us Durée de la transaction en microsecondes.
+ * @param line_low true si la ligne ADB est encore basse après la transaction.
+ * @return Le résultat classé.
+ */
+adb_result adb_stats_classify(bool error, uint32_t elapsed_us, bool line_low);
+
+/**
+ * @brief Enregistre le résultat d'une transaction et met à jour le recul.
+ *
+ * @param device Périphérique concerné.
+ * @param result Résultat classé de la transaction.
+ */
+void adb_stats_record(uint8_t device, adb_result result);
+
+/**
+ * @brief Indique si une transaction en échec doit être relancée immédiatement.
+ *
+ * @param device Périphérique concerné.
+ * @param result Résultat de la dernière tentative.
+ * @param attempt Numéro de la tentative (0 pour la première).
+ * @param elapsed_us Temps déjà consommé dans le budget d'interrogation.
+ * @return true si une relance doit être tentée, false sinon.
+ */
+bool adb_stats_should_retry(uint8_t device, adb_result result, uint8_t attempt,
+                            uint32_t elapsed_us);
+
+/**
+ * @brief Indique si le périphérique doit être interrogé lors de ce cycle.
+ *
+ * Décrémente le compteur de recul lorsque l'interrogation est sautée.
+ *
+ * @param device Périphérique concerné.
+ * @return true si le périphérique doit être interrogé, false sinon.
+ */
+bool adb_stats_should_poll(uint8_t device);
+
+/**
+ * @brief Accès en lecture aux compteurs d'un périphérique.
+ *
+ * @param device Périphérique concerné.
+ * @return Pointeur vers les compteurs, nullptr si le périphérique est inconnu.
+ */
+const adb_device_stats *adb_stats_get(uint8_t device);
+
+/**
+ * @brief Remet à zéro tous les compteurs.
+ */
+void adb_stats_reset();
+
+/**
+ * @brief Formate les compteurs sur une seule ligne compacte.
+ *
+ * Exemple : `ADB kbd ok=120 to=4 bt=0 col=0 rt=0 bo=0 | mse ok=... | tab ...`
+ *
+ * @param buf Tampon de destination.
+ * @param len Taille du tampon.
+ * @return Nombre de caractères écrits (hors zéro terminal).
+ */
+size_t adb_stats_format(char *buf, size_t len);
+
+#endif // ADB_STATS_H
@@ -0,0 +1,134 @@
+/**
+ * @file adb_tablet.cpp
+ * @brief Implémentation du décodage et du regroupement des tablettes ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "adb_tablet.h"
+#include "spsc_ring.h"
+
+static const adb_tablet_format formats[] = {
+    // Wacom UD/ArtZ : 2540 lpi sur 8 x 6 pouces, 256 niveaux de pression
+    {ADB_TABLET_HANDLER_WACOM, "Wacom", 20320, 15240, 0xFF},
+};
+
+static const adb_tablet_format generic_format = {0, "Tablette", 0xFFFF, 0xFFFF,
+                                                 0xFF};
+
+// Décodage -> rapports
+static SpscRing<tablet_sample, ADB_TABLET_RING_SIZE> samples;
+
+// Côté consommateur uniquement
+static tablet_sample edges[ADB_TABLET_EDGE_QUEUE];
+static uint8_t edge_head = 0;
+static uint8_t edge_count = 0;
+static tablet_sample latest;
+static bool latest_pending = false;
+static uint8_t last_buttons = 0;
+static uint32_t coalesced = 0;
+
+const adb_tablet_format *adb_tablet_format_for(uint8_t handler_id) {
+  for (const adb_tablet_format &format : formats)
+    if (format.handler_id == handler_id)
+      return &format;
+  return &generic_format;
+}
+
+/**
+ * @brief Ramène une valeur native sur l'étendue HID.
+ */
+static uint16_t scale(uint32_t value, uint32_t max, uint32_t logical_max) {
+  if (value >= max)
+    return logical_max;
+  return (uint16_t)(value * logical_max / max);
+}
+
+bool adb_tablet_decode(const adb_tablet_format *format, const uint8_t *frame,
+                       uint8_t len, tablet_sample *sample) {
+  if (len < ADB_TABLET_FRAME_MIN)
+    return false;
+
+  uint16_t raw_x = (uint16_t)(frame[1] << 8 | frame[2]);
+  uint16_t raw_y = (uint16_t)(frame[3] << 8 | frame[4]);
+
+  sample->x = scale(raw_x, format->max_x, ADB_TABLET_LOGICAL_MAX);
+  sample->y = scale(raw_y, format->max_y, ADB_TABLET_LOGICAL_MAX);
+  sample->pressure =
+      scale(frame[5], format->max_pressure, ADB_TABLET_PRESSURE_MAX);
+  sample->buttons = frame[0] & (TABLET_TIP | TABLET_BARREL1 | TABLET_BARREL2);
+  if (frame[0] & 0x80)
+    sample->buttons |= TABLET_IN_RANGE;
+
+  // Hors de portée, la position n'est plus significative
+  if (!(sample->buttons & TABLET_IN_RANGE))
+    sample->buttons = 0;
+  return true;
+}
+
+bool adb_tablet_push(const tablet_sample &sample) {
+  return samples.push(sample);
+}
+
+/**
+ * @brief Range un échantillon : transition en file, déplacement en attente.
+ */
+static void coalesce(const tablet_sample &sample) {
+  if (sample.buttons == last_buttons) {
+    if (latest_pending)
+      coalesced++;
+    latest = sample;
+    latest_pending = true;
+    return;
+  }
+
+  last_buttons = sample.buttons;
+  // La transition porte sa propre position : le déplacement précédent est
+  // dépassé
+  if (latest_pending) {
+    coalesced++;
+    latest_pending = false;
+  }
+  edges[(edge_head + edge_count) % ADB_TABLET_EDGE_QUEUE] = sample;
+  edge_count++;
+}
+
+bool adb_tablet_next(tablet_sample *sample) {
+  // File des transitions pleine : les échantillons restent dans la file du
+  // décodage plutôt que d'écraser une transition
+  tablet_sample incoming;
+  while (edge_count < ADB_TABLET_EDGE_QUEUE && samples.pop(incoming))
+    coalesce(incoming);
+
+  if (edge_count > 0) {
+    *sample = edges[edge_head];
+    edge_head = (edge_head + 1) % ADB_TABLET_EDGE_QUEUE;
+    edge_count--;
+    return true;
+  }
+
+  if (latest_pending) {
+    *sample = latest;
+    latest_pending = false;
+    return true;
+  }
+  return false;
+}
+
+uint32_t adb_tablet_coalesced() { return coalesced; }
+
+uint32_t adb_tablet_overflows() { return samples.overflows(); }
+
+void adb_tablet_reset() {
+  tablet_sample discard;
+  while (samples.pop(discard))
+    ;
+  edge_head = edge_count = 0;
+  latest_pending = false;
+  last_buttons = 0;
+  coalesced = 0;
+}
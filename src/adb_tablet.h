@@ -0,0 +1,120 @@
+/**
+ * @file adb_tablet.h
+ * @brief Tablettes graphiques ADB : détection, décodage et regroupement des
+ * échantillons absolus.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Les tablettes répondent à l'adresse ADB réservée aux périphériques de
+ * pointage absolu. Le registre 0 renvoie une trame de 6 à 8 octets :
+ *
+ * | Octet | Contenu                                              |
+ * |-------|------------------------------------------------------|
+ * | 0     | bit 7 : stylet à portée, bits 0-2 : pointe, boutons  |
+ * | 1-2   | X absolu (poids fort en premier)                     |
+ * | 3-4   | Y absolu (poids fort en premier)                     |
+ * | 5     | Pression                                             |
+ *
+ * Le décodage produit des échantillons dans une file sans verrou ; côté
+ * rapports, seule la position la plus récente est envoyée à chaque tour,
+ * mais chaque changement de pointe, de bouton ou de proximité est transmis.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef ADB_TABLET_H
+#define ADB_TABLET_H
+
+#include <cstdint>
+
+#define ADB_TABLET_ADDRESS 4        /**< Adresse des pointeurs absolus. */
+#define ADB_TABLET_HANDLER_WACOM 0x3A /**< Tablettes Wacom ADB. */
+#define ADB_TABLET_FRAME_MIN 6      /**< Longueur minimale d'une trame. */
+#define ADB_TABLET_FRAME_MAX 8      /**< Longueur maximale d'une trame. */
+#define ADB_TABLET_RING_SIZE 32     /**< File du décodage (puissance de 2). */
+#define ADB_TABLET_EDGE_QUEUE 16    /**< Transitions en attente maximum. */
+#define ADB_TABLET_LOGICAL_MAX 0x7FFF /**< Étendue HID des axes. */
+#define ADB_TABLET_PRESSURE_MAX 0x3FF /**< Étendue HID de la pression. */
+
+/** Bits du champ buttons d'un échantillon. */
+#define TABLET_TIP 0x01      /**< Pointe du stylet posée. */
+#define TABLET_BARREL1 0x02  /**< Premier bouton latéral. */
+#define TABLET_BARREL2 0x04  /**< Second bouton latéral. */
+#define TABLET_IN_RANGE 0x08 /**< Stylet à portée de la tablette. */
+
+/**
+ * @struct adb_tablet_format
+ * @brief Étendue native d'un modèle de tablette.
+ */
+struct adb_tablet_format {
+  uint8_t handler_id; /**< Identifiant de gestionnaire (registre 3). */
+  const char *name;   /**< Nom court, pour les traces. */
+  uint16_t max_x;     /**< Valeur X maximale. */
+  uint16_t max_y;     /**< Valeur Y maximale. */
+  uint8_t max_pressure; /**< Pression maximale. */
+};
+
+/**
+ * @struct tablet_sample
+ * @brief Échantillon normalisé (axes sur 0..ADB_TABLET_LOGICAL_MAX).
+ */
+struct tablet_sample {
+  uint32_t timestamp_us; /**< Horodatage du décodage (micros()). */
+  uint16_t x;            /**< Position horizontale. */
+  uint16_t y;            /**< Position verticale. */
+  uint16_t pressure;     /**< Pression, 0..ADB_TABLET_PRESSURE_MAX. */
+  uint8_t buttons;       /**< Voir TABLET_TIP et suivants. */
+};
+
+/**
+ * @brief Retourne le format d'un gestionnaire de tablette.
+ *
+ * Un gestionnaire inconnu reçoit le format générique (axes sur 16 bits).
+ *
+ * @param handler_id Identifiant lu dans le registre 3.
+ */
+const adb_tablet_format *adb_tablet_format_for(uint8_t handler_id);
+
+/**
+ * @brief Décode une trame du registre 0.
+ *
+ * @param format Format de la tablette détectée.
+ * @param frame Octets reçus, dans l'ordre du bus.
+ * @param len Nombre d'octets reçus.
+ * @param sample Échantillon normalisé (timestamp non renseigné).
+ * @return false si la trame est trop courte.
+ */
+bool adb_tablet_decode(const adb_tablet_format *format, const uint8_t *frame,
+                       uint8_t len, tablet_sample *sample);
+
+/**
+ * @brief Dépose un échantillon (producteur unique : décodage ADB).
+ */
+bool adb_tablet_push(const tablet_sample &sample);
+
+/**
+ * @brief Retourne le prochain échantillon à envoyer (consommateur unique).
+ *
+ * Les transitions (pointe, boutons, proximité) sortent dans l'ordre ; les
+ * déplacements intermédiaires sont remplacés par la position la plus récente.
+ *
+ * @return true si un échantillon est disponible.
+ */
+bool adb_tablet_next(tablet_sample *sample);
+
+/** @brief Échantillons remplacés par un plus récent. */
+uint32_t adb_tablet_coalesced();
+
+/** @brief Échantillons refusés par la file du décodage (cumulé). */
+uint32_t adb_tablet_overflows();
+
+/**
+ * @brief Vide les files et remet le compteur de regroupement à zéro.
+ *
+ * À n'appeler que lorsque producteur et consommateur sont à l'arrêt.
+ */
+void adb_tablet_reset();
+
+#endif // ADB_TABLET_H
@@ -0,0 +1,148 @@
+/**
+ * @file ble_bond.cpp
+ * @brief Implémentation de la reconnexion rapide à l'hôte lié.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include "ble_bond.h"
+#include "ble_link.h"
+#include "text_console.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include <esp_gap_ble_api.h>
+
+#define BLE_BOND_NAMESPACE "ble_bond"
+#define BLE_BOND_KEY "peer"
+
+/**
+ * @struct bond_peer
+ * @brief Hôte mémorisé en NVS.
+ */
+struct bond_peer {
+  esp_bd_addr_t addr;
+  uint8_t addr_type;
+};
+
+static BLEAdvertising *fallback_advertising = nullptr;
+static bond_peer peer;
+static bool has_peer = false;
+static bool directed = false;
+static uint32_t directed_start_ms = 0;
+
+// Écrits depuis les callbacks Bluetooth, consommés par la tâche Bluetooth
+static bond_peer pending_peer;
+static std::atomic<bool> save_pending{false};
+static std::atomic<bool> restart_pending{false};
+
+/**
+ * @brief Vérifie que l'hôte figure encore dans la liste des liaisons.
+ */
+static bool peer_still_bonded(const bond_peer &candidate) {
+  int count = esp_ble_get_bond_device_num();
+  if (count <= 0)
+    return false;
+
+  esp_ble_bond_dev_t devices[CONFIG_BT_SMP_MAX_BONDS];
+  if (count > CONFIG_BT_SMP_MAX_BONDS)
+    count = CONFIG_BT_SMP_MAX_BONDS;
+  if (esp_ble_get_bond_device_list(&count, devices) != ESP_OK)
+    return false;
+
+  for (int i = 0; i < count; i++)
+    if (memcmp(devices[i].bd_addr, candidate.addr, sizeof(esp_bd_addr_t)) == 0)
+      return true;
+  return false;
+}
+
+void ble_bond_begin(BLEAdvertising *advertising) {
+  fallback_advertising = advertising;
+
+  Preferences prefs;
+  prefs.begin(BLE_BOND_NAMESPACE, true);
+  has_peer = prefs.getBytes(BLE_BOND_KEY, &peer, sizeof(peer)) == sizeof(peer);
+  prefs.end();
+
+  // Liaison effacée côté pile (ou hôte oublié) : inutile de le viser
+  if (has_peer && !peer_still_bonded(peer)) {
+    has_peer = false;
+    Console.println("Hôte BLE mémorisé absent des liaisons, ignoré.");
+  }
+}
+
+void ble_bond_remember(const esp_bd_addr_t addr, esp_ble_addr_type_t type) {
+  memcpy(pending_peer.addr, addr, sizeof(esp_bd_addr_t));
+  pending_peer.addr_type = type;
+  save_pending = true;
+}
+
+void ble_bond_start_advertising(uint32_t now_ms) {
+  ble_link_on_advertising(now_ms);
+
+  if (has_peer) {
+    esp_ble_adv_params_t params = {};
+    params.adv_int_min = 0x20;
+    params.adv_int_max = 0x20;
+    params.adv_type = ADV_TYPE_DIRECT_IND_HIGH;
+    params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    memcpy(params.peer_addr, peer.addr, sizeof(esp_bd_addr_t));
+    params.peer_addr_type = (esp_ble_addr_type_t)peer.addr_type;
+    params.channel_map = ADV_CHNL_ALL;
+    params.adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY;
+
+    if (esp_ble_gap_start_advertising(&params) == ESP_OK) {
+      directed = true;
+      directed_start_ms = now_ms;
+      return;
+    }
+  }
+
+  directed = false;
+  if (fallback_advertising)
+    fallback_advertising->start();
+}
+
+void ble_bond_on_disconnect() { restart_pending = true; }
+
+void ble_bond_service(uint32_t now_ms) {
+  if (save_pending.exchange(false)) {
+    bool changed = !has_peer || memcmp(&peer, &pending_peer, sizeof(peer)) != 0;
+    peer = pending_peer;
+    has_peer = true;
+    // Écriture en flash seulement si l'hôte a changé
+    if (changed) {
+      Preferences prefs;
+      prefs.begin(BLE_BOND_NAMESPACE, false);
+      prefs.putBytes(BLE_BOND_KEY, &peer, sizeof(peer));
+      prefs.end();
+    }
+  }
+
+  if (restart_pending.exchange(false)) {
+    ble_bond_start_advertising(now_ms);
+    return;
+  }
+
+  // Fin de la fenêtre dirigée : repli sur l'annonce classique
+  if (directed && !ble_link_connected() &&
+      now_ms - directed_start_ms >= BLE_BOND_DIRECTED_MS) {
+    directed = false;
+    esp_ble_gap_stop_advertising();
+    if (fallback_advertising)
+      fallback_advertising->start();
+  }
+
+  if (ble_link_connected())
+    directed = false;
+}
+
+bool ble_bond_has_peer() { return has_peer; }
+
+#endif // ARDUINO_ARCH_ESP32
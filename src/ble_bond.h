@@ -0,0 +1,65 @@
+/**
+ * @file ble_bond.h
+ * @brief Mémorisation de l'hôte lié et reconnexion rapide par annonce dirigée.
+ * @part of Apple-ADB-Ressurector
+ *
+ * L'adresse du dernier hôte lié est conservée en NVS. Au démarrage comme après
+ * une déconnexion, une annonce dirigée haute fréquence vers cet hôte est
+ * tentée pendant BLE_BOND_DIRECTED_MS, puis l'annonce classique prend le
+ * relais pour permettre l'appairage d'un nouvel hôte.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef BLE_BOND_H
+#define BLE_BOND_H
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <BLEDevice.h>
+#include <cstdint>
+
+/** Durée maximale d'une annonce dirigée haute fréquence (spécification). */
+#define BLE_BOND_DIRECTED_MS 1280
+
+/**
+ * @brief Charge l'hôte mémorisé et vérifie qu'il est toujours lié.
+ *
+ * @param advertising Annonce classique utilisée en repli.
+ */
+void ble_bond_begin(BLEAdvertising *advertising);
+
+/**
+ * @brief Mémorise l'hôte qui vient de terminer l'authentification.
+ *
+ * Appelable depuis les callbacks Bluetooth : l'écriture NVS est différée à
+ * ble_bond_service().
+ */
+void ble_bond_remember(const esp_bd_addr_t addr, esp_ble_addr_type_t type);
+
+/**
+ * @brief Lance l'annonce : dirigée si un hôte est mémorisé, classique sinon.
+ */
+void ble_bond_start_advertising(uint32_t now_ms);
+
+/**
+ * @brief Signale une déconnexion : l'annonce reprendra au prochain service.
+ */
+void ble_bond_on_disconnect();
+
+/**
+ * @brief Traitement périodique (tâche Bluetooth).
+ */
+void ble_bond_service(uint32_t now_ms);
+
+/**
+ * @brief Indique si un hôte lié est mémorisé.
+ */
+bool ble_bond_has_peer();
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // BLE_BOND_H
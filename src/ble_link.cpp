@@ -0,0 +1,303 @@
+/**
+ * @file ble_link.cpp
+ * @brief Implémentation de la gestion du lien Bluetooth.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "ble_link.h"
+#include "hid_transport.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @struct pending_report
+ * @brief Notification en attente.
+ */
+struct pending_report {
+  uint32_t queued_ms;
+  uint8_t kind;
+  uint8_t len;
+  uint8_t data[BLE_LINK_REPORT_MAX_LEN];
+};
+
+static ble_link_notify_fn notify_hook = nullptr;
+static ble_link_params_fn params_hook = nullptr;
+
+// Écrits depuis les callbacks de la pile Bluetooth
+static std::atomic<bool> connected{false};
+static std::atomic<uint32_t> connect_ms{0};
+static std::atomic<uint16_t> mtu{BLE_LINK_DEFAULT_MTU};
+static std::atomic<uint16_t> conn_interval{0};
+static std::atomic<bool> secured{false};
+static std::atomic<uint32_t> advertising_ms{0};
+static std::atomic<bool> measuring{false};
+
+// Utilisés uniquement depuis la tâche Bluetooth
+static pending_report queue[BLE_LINK_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+static uint8_t profile = BLE_PROFILE_NONE;
+static uint32_t last_activity_ms = 0;
+static uint32_t window_start_ms = 0;
+static uint8_t sent_in_window = 0;
+static ble_link_counters counters;
+
+void ble_link_set_hooks(ble_link_notify_fn notify, ble_link_params_fn params) {
+  notify_hook = notify;
+  params_hook = params;
+}
+
+ble_conn_params ble_link_profile_params(uint8_t p) {
+  switch (p) {
+  case BLE_PROFILE_LOW_LATENCY:
+    return {6, 12, 0, 200}; // 7,5-15 ms, pas de latence, supervision 2 s
+  case BLE_PROFILE_POWER_SAVING:
+    return {6, 12, 20, 400}; // même intervalle, 20 événements sautés, 4 s
+  default:
+    return {0, 0, 0, 0};
+  }
+}
+
+void ble_link_on_connect(uint32_t now_ms) {
+  connect_ms = now_ms;
+  mtu = BLE_LINK_DEFAULT_MTU;
+  conn_interval = 0;
+  secured = false;
+  connected = true;
+}
+
+void ble_link_on_disconnect() {
+  connected = false;
+  secured = false;
+}
+
+void ble_link_on_advertising(uint32_t now_ms) {
+  advertising_ms = now_ms;
+  measuring = true;
+}
+
+void ble_link_on_secured() { secured = true; }
+
+void ble_link_on_mtu(uint16_t negotiated) { mtu = negotiated; }
+
+void ble_link_on_conn_params(uint16_t interval, uint16_t) {
+  conn_interval = interval;
+}
+
+/**
+ * @brief Retire la notification la plus ancienne de la file.
+ */
+static void queue_drop_front() {
+  queue_head = (queue_head + 1) % BLE_LINK_QUEUE_SIZE;
+  queue_count--;
+}
+
+/**
+ * @brief Écarte les rapports périmés pendant que le lien est absent.
+ *
+ * Seuls les rapports clavier et Consumer récents sont conservés ; l'ordre
+ * est préservé.
+ */
+static void purge_while_unlinked(uint32_t now_ms) {
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < queue_count; i++) {
+    const pending_report &report = queue[(queue_head + i) % BLE_LINK_QUEUE_SIZE];
+    bool keep = (report.kind == HID_REPORT_KEYBOARD ||
+                 report.kind == HID_REPORT_CONSUMER) &&
+                now_ms - report.queued_ms < BLE_LINK_PRELINK_MAX_AGE_MS;
+    if (!keep) {
+      counters.dropped++;
+      continue;
+    }
+    queue[(queue_head + kept) % BLE_LINK_QUEUE_SIZE] = report;
+    kept++;
+  }
+  queue_count = kept;
+}
+
+/**
+ * @brief Fusionne deux déplacements en saturant sur 8 bits.
+ */
+static uint8_t merge_axis(uint8_t a, uint8_t b) {
+  int16_t sum = (int16_t)(int8_t)a + (int16_t)(int8_t)b;
+  if (sum > 127)
+    sum = 127;
+  if (sum < -127)
+    sum = -127;
+  return (uint8_t)(int8_t)sum;
+}
+
+bool ble_link_enqueue(uint8_t kind, const uint8_t *report, uint8_t len,
+                      uint32_t now_ms) {
+  // Charge utile d'une notification : MTU - 3 octets d'en-tête ATT
+  if (len > BLE_LINK_REPORT_MAX_LEN || len + 3 > mtu) {
+    counters.dropped++;
+    return false;
+  }
+
+  // Hors connexion, les déplacements et LEDs n'ont plus de sens à l'arrivée
+  bool linked = connected;
+  if (!linked && kind != HID_REPORT_KEYBOARD && kind != HID_REPORT_CONSUMER) {
+    counters.dropped++;
+    return false;
+  }
+
+  last_activity_ms = now_ms;
+
+  // Rapport souris de même état de boutons : cumul des déplacements
+  if (kind == HID_REPORT_MOUSE && queue_count > 0 && len >= 3) {
+    pending_report &last =
+        queue[(queue_head + queue_count - 1) % BLE_LINK_QUEUE_SIZE];
+    if (last.kind == HID_REPORT_MOUSE && last.len == len &&
+        last.data[0] == report[0]) {
+      last.data[1] = merge_axis(last.data[1], report[1]);
+      last.data[2] = merge_axis(last.data[2], report[2]);
+      counters.merged++;
+      return true;
+    }
+  }
+
+  // Rapport tablette ou manette de même état (pointe, boutons) : seule la
+  // position la plus récente part au prochain événement de connexion
+  if ((kind == HID_REPORT_TABLET || kind == HID_REPORT_JOYSTICK) &&
+      queue_count > 0) {
+    pending_report &last =
+        queue[(queue_head + queue_count - 1) % BLE_LINK_QUEUE_SIZE];
+    if (last.kind == kind && last.len == len &&
+        last.data[0] == report[0]) {
+      memcpy(last.data, report, len);
+      last.queued_ms = now_ms;
+      counters.merged++;
+      return true;
+    }
+  }
+
+  if (queue_count >= BLE_LINK_QUEUE_SIZE) {
+    counters.dropped++;
+    return false;
+  }
+
+  pending_report &slot =
+      queue[(queue_head + queue_count) % BLE_LINK_QUEUE_SIZE];
+  slot.queued_ms = now_ms;
+  slot.kind = kind;
+  slot.len = len;
+  memcpy(slot.data, report, len);
+  queue_count++;
+  counters.queued++;
+  if (!linked)
+    counters.buffered++;
+  return true;
+}
+
+/**
+ * @brief Demande les paramètres d'un profil au central.
+ */
+static void request_profile(uint8_t next) {
+  profile = next;
+  counters.param_updates++;
+  if (params_hook != nullptr)
+    params_hook(ble_link_profile_params(next));
+}
+
+void ble_link_service(uint32_t now_ms) {
+  if (!connected) {
+    purge_while_unlinked(now_ms);
+    profile = BLE_PROFILE_NONE;
+    return;
+  }
+
+  // Attente du chiffrement : un hôte lié ignore les notifications en clair
+  if (!ble_link_ready(now_ms))
+    return;
+
+  if (measuring.exchange(false))
+    counters.reconnect_ms = now_ms - advertising_ms;
+
+  // Choix du profil : basse latence pendant la frappe, économe au repos
+  if (now_ms - connect_ms >= BLE_LINK_PARAMS_DELAY_MS) {
+    uint8_t wanted = now_ms - last_activity_ms < BLE_LINK_IDLE_AFTER_MS
+                         ? BLE_PROFILE_LOW_LATENCY
+                         : BLE_PROFILE_POWER_SAVING;
+    if (profile == BLE_PROFILE_NONE)
+      wanted = BLE_PROFILE_LOW_LATENCY;
+    if (wanted != profile)
+      request_profile(wanted);
+  }
+
+  // Fenêtre d'un événement de connexion (intervalle négocié ou maximal)
+  uint16_t interval = conn_interval;
+  if (interval == 0)
+    interval = ble_link_profile_params(BLE_PROFILE_LOW_LATENCY).max_interval;
+  uint32_t window_ms = (interval * 5u + 3) / 4; // unités de 1,25 ms
+  if (now_ms - window_start_ms >= window_ms) {
+    window_start_ms = now_ms;
+    sent_in_window = 0;
+  }
+
+  while (queue_count > 0 && sent_in_window < BLE_LINK_NOTIFY_PER_EVENT) {
+    const pending_report &report = queue[queue_head];
+    if (notify_hook != nullptr)
+      notify_hook(report.kind, report.data, report.len);
+    queue_drop_front();
+    sent_in_window++;
+    counters.sent++;
+  }
+}
+
+bool ble_link_connected() { return connected; }
+
+bool ble_link_ready(uint32_t now_ms) {
+  return connected &&
+         (secured || now_ms - connect_ms >= BLE_LINK_SECURE_TIMEOUT_MS);
+}
+
+uint16_t ble_link_mtu() { return mtu; }
+
+uint8_t ble_link_profile() { return profile; }
+
+uint8_t ble_link_pending() { return queue_count; }
+
+const ble_link_counters &ble_link_get_counters() { return counters; }
+
+void ble_link_reset() {
+  connected = false;
+  connect_ms = 0;
+  mtu = BLE_LINK_DEFAULT_MTU;
+  conn_interval = 0;
+  secured = false;
+  advertising_ms = 0;
+  measuring = false;
+  queue_head = queue_count = 0;
+  profile = BLE_PROFILE_NONE;
+  last_activity_ms = window_start_ms = 0;
+  sent_in_window = 0;
+  counters = ble_link_counters();
+}
+
+size_t ble_link_format(char *buf, size_t len) {
+  if (len == 0)
+    return 0;
+
+  int n = snprintf(buf, len,
+                   "BLE con=%d mtu=%u int=%u prof=%u q=%u sent=%lu drop=%lu "
+                   "queued=%lu merged=%lu upd=%lu buf=%lu rc=%lu",
+                   connected ? 1 : 0, (unsigned)mtu, (unsigned)conn_interval,
+                   (unsigned)profile, (unsigned)queue_count,
+                   (unsigned long)counters.sent,
+                   (unsigned long)counters.dropped,
+                   (unsigned long)counters.queued,
+                   (unsigned long)counters.merged,
+                   (unsigned long)counters.param_updates,
+                   (unsigned long)counters.buffered,
+                   (unsigned long)counters.reconnect_ms);
+  if (n < 0)
+    return 0;
+  return (size_t)n < len ? (size_t)n : len - 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file ble_link.h
+ * @brief Gestion du lien Bluetooth : paramètres de connexion basse latence,
+ * suivi du MTU et regroupement des notifications HID par événement de
+ * connexion.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Après la connexion, le périphérique demande un intervalle de 7,5 à 15 ms.
+ * Pendant la frappe, la latence esclave est nulle ; après une période sans
+ * notification, un profil économe ajoute de la latence esclave sans changer
+ * l'intervalle, de sorte que la première frappe part toujours au prochain
+ * événement de connexion.
+ *
+ * Tant que le lien n'est pas prêt (connexion chiffrée avec un hôte lié), les
+ * rapports clavier sont conservés dans l'ordre, dans une file bornée, puis
+ * envoyés dès que les notifications sont possibles. Le temps écoulé entre le
+ * début de l'annonce et le lien prêt est mesuré.
+ *
+ * La logique est indépendante de la pile Bluetooth : l'envoi des
+ * notifications et la demande de paramètres passent par des fonctions
+ * fournies par main.cpp, ce qui permet de la tester nativement.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef BLE_LINK_H
+#define BLE_LINK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define BLE_LINK_QUEUE_SIZE 32       /**< Notifications en attente maximum. */
+#define BLE_LINK_NOTIFY_PER_EVENT 4  /**< Notifications par événement. */
+#define BLE_LINK_REPORT_MAX_LEN 8    /**< Taille maximale d'un rapport. */
+#define BLE_LINK_IDLE_AFTER_MS 2000  /**< Inactivité avant le profil économe. */
+#define BLE_LINK_PARAMS_DELAY_MS 500 /**< Délai avant la première demande. */
+#define BLE_LINK_DEFAULT_MTU 23      /**< MTU ATT par défaut. */
+#define BLE_LINK_SECURE_TIMEOUT_MS 1000 /**< Attente maximale du chiffrement. */
+#define BLE_LINK_PRELINK_MAX_AGE_MS 10000 /**< Âge maximal d'une frappe. */
+
+/**
+ * @enum ble_link_profile
+ * @brief Profils de paramètres de connexion.
+ */
+enum ble_link_profile : uint8_t {
+  BLE_PROFILE_NONE = 0,    /**< Paramètres choisis par le central. */
+  BLE_PROFILE_LOW_LATENCY, /**< Frappe en cours. */
+  BLE_PROFILE_POWER_SAVING /**< Inactivité. */
+};
+
+/**
+ * @struct ble_conn_params
+ * @brief Paramètres de connexion, en unités du standard Bluetooth.
+ */
+struct ble_conn_params {
+  uint16_t min_interval; /**< Intervalle minimal (unités de 1,25 ms). */
+  uint16_t max_interval; /**< Intervalle maximal (unités de 1,25 ms). */
+  uint16_t latency;      /**< Latence esclave (événements). */
+  uint16_t timeout;      /**< Supervision (unités de 10 ms). */
+};
+
+/**
+ * @struct ble_link_counters
+ * @brief Compteurs du lien.
+ */
+struct ble_link_counters {
+  uint32_t queued = 0;        /**< Notifications mises en file. */
+  uint32_t sent = 0;          /**< Notifications envoyées. */
+  uint32_t dropped = 0;       /**< File pleine, lien absent ou trop long. */
+  uint32_t merged = 0;        /**< Rapports souris fusionnés en file. */
+  uint32_t param_updates = 0; /**< Demandes de paramètres émises. */
+  uint32_t buffered = 0;      /**< Rapports conservés avant le lien. */
+  uint32_t reconnect_ms = 0;  /**< Durée de la dernière reconnexion. */
+};
+
+/** Envoie une notification sur la caractéristique du type de rapport. */
+typedef void (*ble_link_notify_fn)(uint8_t kind, const uint8_t *report,
+                                   uint8_t len);
+/** Demande de nouveaux paramètres de connexion au central. */
+typedef void (*ble_link_params_fn)(const ble_conn_params &params);
+
+/**
+ * @brief Définit les fonctions d'accès à la pile Bluetooth.
+ */
+void ble_link_set_hooks(ble_link_notify_fn notify, ble_link_params_fn params);
+
+/**
+ * @brief Paramètres associés à un profil.
+ */
+ble_conn_params ble_link_profile_params(uint8_t profile);
+
+/**
+ * @brief Signale une connexion (contexte des callbacks Bluetooth).
+ */
+void ble_link_on_connect(uint32_t now_ms);
+
+/**
+ * @brief Signale une déconnexion (contexte des callbacks Bluetooth).
+ */
+void ble_link_on_disconnect();
+
+/**
+ * @brief Signale le début de l'annonce (départ de la mesure de reconnexion).
+ */
+void ble_link_on_advertising(uint32_t now_ms);
+
+/**
+ * @brief Signale que le lien est chiffré avec un hôte lié.
+ */
+void ble_link_on_secured();
+
+/**
+ * @brief Signale le MTU négocié.
+ */
+void ble_link_on_mtu(uint16_t mtu);
+
+/**
+ * @brief Signale les paramètres de connexion effectivement appliqués.
+ *
+ * @param interval Intervalle (unités de 1,25 ms).
+ * @param latency Latence esclave.
+ */
+void ble_link_on_conn_params(uint16_t interval, uint16_t latency);
+
+/**
+ * @brief Met un rapport en file pour le prochain événement de connexion.
+ *
+ * Les rapports souris consécutifs de même état de boutons sont fusionnés,
+ * ceux de la tablette remplacés par le plus récent ; les rapports clavier ne le sont jamais, afin de préserver l'ordre des
+ * frappes. Hors connexion, seuls les rapports clavier et Consumer sont
+ * conservés.
+ *
+ * @return true si le rapport a été mis en file.
+ */
+bool ble_link_enqueue(uint8_t kind, const uint8_t *report, uint8_t len,
+                      uint32_t now_ms);
+
+/**
+ * @brief Envoie les notifications dues et ajuste le profil.
+ *
+ * À appeler régulièrement depuis la tâche Bluetooth.
+ */
+void ble_link_service(uint32_t now_ms);
+
+/**
+ * @brief Indique si le lien est établi.
+ */
+bool ble_link_connected();
+
+/**
+ * @brief Indique si les notifications peuvent être envoyées.
+ */
+bool ble_link_ready(uint32_t now_ms);
+
+/**
+ * @brief MTU négocié.
+ */
+uint16_t ble_link_mtu();
+
+/**
+ * @brief Profil courant.
+ */
+uint8_t ble_link_profile();
+
+/**
+ * @brief Nombre de notifications en attente.
+ */
+uint8_t ble_link_pending();
+
+/**
+ * @brief Compteurs du lien.
+ */
+const ble_link_counters &ble_link_get_counters();
+
+/**
+ * @brief Remet le gestionnaire dans son état initial.
+ */
+void ble_link_reset();
+
+/**
+ * @brief Formate l'état du lien sur une ligne compacte.
+ *
+ * @return Nombre de caractères écrits (hors zéro terminal).
+ */
+size_t ble_link_format(char *buf, size_t len);
+
+#endif // BLE_LINK_H
@@ -0,0 +1,25 @@
+/**
+ * @file board.cpp
+ * @brief Services communs aux cartes.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "board.h"
+
+void board_log_hid(const char *what, const char *hid_name, const char *state) {
+#ifdef ARDUINO
+  Serial.print(what);
+  Serial.print(' ');
+  Serial.print(hid_name);
+  Serial.println(state);
+#else
+  (void)what;
+  (void)hid_name;
+  (void)state;
+#endif
+}
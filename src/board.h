@@ -0,0 +1,192 @@
+/**
+ * @file board.h
+ * @brief Caractéristiques des cartes : broches, horloge, transports HID.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Chaque carte est décrite par une structure de constantes (broches,
+ * horloge du compteur de cycles, transports HID présents, écran d'état) et
+ * par l'ouverture
+ * de ses interfaces HID locales. `board` désigne la carte de la cible ;
+ * board_traits<> en vérifie la cohérence à la compilation. Les couches HID
+ * et ADB reçoivent la carte en paramètre de modèle (`board` par défaut) et
+ * n'en lisent que des constantes : la répartition est résolue à la
+ * compilation, et les tests natifs peuvent fournir leur propre carte.
+ *
+ * Ajouter une carte : écrire sa structure et l'ajouter à la sélection en fin
+ * de fichier, ou la désigner par `-D ADB_BOARD=<structure>`.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "hid_transport.h"
+#include "status_display.h"
+#include <cstdint>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#ifdef ARDUINO_ARCH_STM32
+#include "usbd_hid_composite_if.h"
+#endif
+
+/**
+ * @enum board_hid_interface
+ * @brief Interfaces HID locales ouvertes par board::hid_begin().
+ */
+enum board_hid_interface : uint8_t {
+  BOARD_HID_KEYBOARD = 0, /**< Clavier (et Consumer Control). */
+  BOARD_HID_MOUSE         /**< Souris. */
+};
+
+#ifdef ARDUINO_ARCH_STM32
+/**
+ * @struct board_stm32
+ * @brief Blue Pill (STM32F103C8) et STM32F3 Discovery : HID composite USB.
+ */
+struct board_stm32 {
+  static constexpr const char *hid_name = "USB";
+  static constexpr uint8_t adb_pin = PB4;
+  static constexpr uint8_t led_pin = PC13;
+  static constexpr uint8_t sniffer_pin = PB12;
+  // F_CPU doit être une constante : fournie par PlatformIO (board_build.f_cpu)
+  static constexpr uint32_t clock_hz = F_CPU;
+#ifdef USBCON
+  static constexpr const hid_transport *transports[] = {&hid_transport_usb};
+#else
+  static constexpr const hid_transport *transports[] = {nullptr};
+#endif
+#if defined(DISPLAY_ENABLED) && defined(STM32F1xx)
+  static constexpr const display_panel *display = &display_panel_ssd1306;
+#else
+  static constexpr const display_panel *display = nullptr;
+#endif
+
+  static void hid_begin(uint8_t iface) {
+    HID_Composite_Init(static_cast<HID_Interface>(iface));
+  }
+  static void hid_end(uint8_t iface) {
+    HID_Composite_DeInit(static_cast<HID_Interface>(iface));
+  }
+};
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+/**
+ * @struct board_esp32
+ * @brief ESP32 DevKit (Wemos) : HID over GATT.
+ */
+struct board_esp32 {
+  static constexpr const char *hid_name = "Bluetooth";
+  static constexpr uint8_t adb_pin = 2;
+  static constexpr uint8_t led_pin = 4;
+  static constexpr uint8_t sniffer_pin = 13;
+  static constexpr uint32_t clock_hz = F_CPU;
+  static constexpr const hid_transport *transports[] = {&hid_transport_ble};
+#ifdef DISPLAY_ENABLED
+  static constexpr const display_panel *display = &display_panel_ssd1306;
+#else
+  static constexpr const display_panel *display = nullptr;
+#endif
+
+  // Services GATT créés par la tâche Bluetooth (main.cpp)
+  static void hid_begin(uint8_t) {}
+  static void hid_end(uint8_t) {}
+};
+#endif
+
+/**
+ * @struct board_sim
+ * @brief Cœur Arduino simulé (test/test_sim) : horloge micros(), hôte HID
+ * enregistré par le banc de test.
+ */
+struct board_sim {
+  static constexpr const char *hid_name = "simulé";
+  static constexpr uint8_t adb_pin = 2;
+  static constexpr uint8_t led_pin = 4;
+  static constexpr uint8_t sniffer_pin = 13;
+  static constexpr uint32_t clock_hz = 1000000UL;
+  static constexpr const hid_transport *transports[] = {nullptr};
+  static constexpr const display_panel *display = &display_panel_native;
+
+  static void hid_begin(uint8_t) {}
+  static void hid_end(uint8_t) {}
+};
+
+#ifndef ARDUINO
+/**
+ * @struct board_native
+ * @brief Tests natifs : transport enregistreur, aucune broche réelle.
+ */
+struct board_native {
+  static constexpr const char *hid_name = "natif";
+  static constexpr uint8_t adb_pin = 0;
+  static constexpr uint8_t led_pin = 1;
+  static constexpr uint8_t sniffer_pin = 2;
+  static constexpr uint32_t clock_hz = 1000000UL;
+  static constexpr const hid_transport *transports[] = {
+      &hid_transport_native};
+  static constexpr const display_panel *display = &display_panel_native;
+
+  static void hid_begin(uint8_t) {}
+  static void hid_end(uint8_t) {}
+};
+#endif
+
+/**
+ * @brief Trace l'ouverture ou la fermeture d'une interface HID locale sur le
+ * port série (sans effet hors Arduino).
+ *
+ * @param what Début du message (« Clavier HID »).
+ * @param hid_name Nom des interfaces de la carte (Board::hid_name).
+ * @param state Fin du message (« initialisé. »).
+ */
+void board_log_hid(const char *what, const char *hid_name, const char *state);
+
+/**
+ * @struct board_traits
+ * @brief Vérifications et services dérivés d'une carte.
+ *
+ * @tparam Board Structure de carte.
+ */
+template <typename Board> struct board_traits {
+  /** Entrées de Board::transports (nullptr : aucun transport). */
+  static constexpr uint8_t transport_count =
+      sizeof(Board::transports) / sizeof(Board::transports[0]);
+
+  static_assert(Board::adb_pin != Board::led_pin &&
+                    Board::adb_pin != Board::sniffer_pin &&
+                    Board::led_pin != Board::sniffer_pin,
+                "Broches de carte partagées");
+  static_assert(transport_count <= HID_TRANSPORT_MAX,
+                "Plus de transports que HID_TRANSPORT_MAX");
+  static_assert(Board::clock_hz >= 1000000UL,
+                "Horloge de carte inférieure à 1 MHz");
+
+  /** Active les transports de la carte. */
+  static void register_transports() {
+    for (const hid_transport *transport : Board::transports)
+      hid_transport_register(transport);
+  }
+};
+
+#if defined(ADB_BOARD)
+typedef ADB_BOARD board;
+#elif defined(ADB_SIM)
+typedef board_sim board;
+#elif defined(ARDUINO_ARCH_STM32)
+typedef board_stm32 board;
+#elif defined(ARDUINO_ARCH_ESP32)
+typedef board_esp32 board;
+#elif !defined(ARDUINO)
+typedef board_native board;
+#else
+#error "Carte non prise en charge : définir ADB_BOARD"
+#endif
+
+#endif // BOARD_H
@@ -0,0 +1,410 @@
+/**
+ * @file ctrl_proto.cpp
+ * @brief Implémentation du protocole binaire de contrôle et de télémétrie.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Réponse à CTRL_GET_COUNTERS (entiers de 32 bits) :
+ * - nombre de périphériques ADB, nombre de types de rapport HID (1 octet
+ *   chacun) ;
+ * - par périphérique ADB : trames valides, timeouts, erreurs de timing,
+ *   collisions, relances, reculs ;
+ * - file d'événements : en attente, remplissage maximal, débordements ;
+ * - par type de rapport HID : envoyés, perdus ;
+ * - protocole : trames valides, erreurs CRC, erreurs de longueur.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "ctrl_proto.h"
+#include "adb_joystick.h"
+#include "adb_stats.h"
+#include "event_trace.h"
+#include "hid_reports.h"
+#include "hid_transport.h"
+#include "input_events.h"
+#include "key_remap.h"
+#include "sof_sync.h"
+
+/** États du récepteur. */
+enum : uint8_t {
+  RX_SYNC = 0,
+  RX_LEN_LO,
+  RX_LEN_HI,
+  RX_TYPE,
+  RX_PAYLOAD,
+  RX_CRC_LO,
+  RX_CRC_HI
+};
+
+#define CTRL_HEADER_LEN 4 /**< Synchro, longueur, type. */
+#define CTRL_REMAP_PREFIX 2 /**< Décalage avant les octets de la table. */
+#define CTRL_COUNTERS_LEN                                                      \
+  (2 + ADB_STATS_DEVICE_COUNT * 6 * 4 + 3 * 4 + HID_REPORT_KIND_COUNT * 2 * 4 + \
+   3 * 4)
+
+static_assert(CTRL_COUNTERS_LEN <= CTRL_PAYLOAD_MAX,
+              "Les compteurs doivent tenir dans une trame");
+static_assert(CTRL_REMAP_PREFIX + KEY_REMAP_SIZE <= CTRL_PAYLOAD_MAX,
+              "La table doit pouvoir être téléversée en une trame");
+
+static ctrl_write_fn write_out = nullptr;
+static ctrl_room_fn room_out = nullptr;
+static ctrl_counters counters;
+
+// Réception
+static uint8_t rx_state = RX_SYNC;
+static uint8_t rx_type = 0;
+static uint16_t rx_len = 0;
+static uint16_t rx_pos = 0;
+static uint16_t rx_crc = 0;
+static uint16_t rx_frame_crc = 0;
+static uint8_t rx_payload[CTRL_PAYLOAD_MAX];
+static uint8_t *rx_bulk = nullptr; /**< Destination directe des octets. */
+
+// Réponse en attente : en-tête, charge utile (éventuellement hors de ce
+// module), CRC ; émise par morceaux selon la place disponible
+static uint8_t tx_header[CTRL_HEADER_LEN];
+static const uint8_t *tx_payload = nullptr;
+static uint16_t tx_len = 0;
+static uint8_t tx_crc[2];
+static uint16_t tx_sent = 0;
+static bool tx_pending = false;
+static bool client_seen = false; // Trame valide reçue depuis l'initialisation
+static uint8_t tx_buf[CTRL_PAYLOAD_MAX];
+
+uint16_t ctrl_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+static uint8_t *put_u32(uint8_t *out, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++)
+    *out++ = (uint8_t)(value >> (8 * i));
+  return out;
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+  return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 |
+         (uint32_t)in[3] << 24;
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+  return (uint16_t)(in[0] | in[1] << 8);
+}
+
+/**
+ * @brief Prépare une réponse ; payload doit rester valide jusqu'à l'émission.
+ */
+static void respond(uint8_t type, const uint8_t *payload, uint16_t len) {
+  tx_header[0] = CTRL_SYNC;
+  tx_header[1] = len & 0xFF;
+  tx_header[2] = len >> 8;
+  tx_header[3] = type;
+  uint16_t crc = ctrl_crc16(0xFFFF, tx_header + 1, CTRL_HEADER_LEN - 1);
+  crc = ctrl_crc16(crc, payload, len);
+  tx_crc[0] = crc & 0xFF;
+  tx_crc[1] = crc >> 8;
+  tx_payload = payload;
+  tx_len = len;
+  tx_sent = 0;
+  tx_pending = true;
+  ctrl_proto_service();
+}
+
+static void ack(uint8_t request) {
+  tx_buf[0] = request;
+  respond(CTRL_ACK, tx_buf, 1);
+}
+
+static void nak(uint8_t request, uint8_t error) {
+  tx_buf[0] = request;
+  tx_buf[1] = error;
+  respond(CTRL_NAK, tx_buf, 2);
+}
+
+static bool config_get(uint8_t key, uint32_t *value) {
+  switch (key) {
+  case CTRL_CFG_VERSION:
+    *value = CTRL_VERSION;
+    return true;
+  case CTRL_CFG_TAP_HOLD_MS:
+    *value = hid_reports_tap_hold_ms();
+    return true;
+  case CTRL_CFG_REMAP_ENABLE:
+    *value = key_remap_enabled();
+    return true;
+  case CTRL_CFG_TRACE_ENABLE:
+    *value = event_trace_enabled();
+    return true;
+  case CTRL_CFG_SOF_SYNC:
+    *value = sof_sync_enabled();
+    return true;
+  case CTRL_CFG_JOYSTICK_DEADZONE:
+    *value = adb_joystick_deadzone();
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool config_set(uint8_t key, uint32_t value) {
+  switch (key) {
+  case CTRL_CFG_TAP_HOLD_MS:
+    hid_reports_set_tap_hold_ms(value > UINT16_MAX ? UINT16_MAX : value);
+    return true;
+  case CTRL_CFG_REMAP_ENABLE:
+    key_remap_set_enabled(value != 0);
+    return true;
+  case CTRL_CFG_TRACE_ENABLE:
+    event_trace_set_enabled(value != 0);
+    return true;
+  case CTRL_CFG_SOF_SYNC:
+    sof_sync_set_enabled(value != 0);
+    return true;
+  case CTRL_CFG_JOYSTICK_DEADZONE:
+    adb_joystick_set_deadzone(value > UINT16_MAX ? UINT16_MAX : value);
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void send_config(uint8_t type, uint8_t key) {
+  uint32_t value = 0;
+  if (!config_get(key, &value)) {
+    nak(type, CTRL_ERR_KEY);
+    return;
+  }
+  tx_buf[0] = key;
+  put_u32(tx_buf + 1, value);
+  respond(type | CTRL_RESPONSE, tx_buf, 5);
+}
+
+static void send_counters() {
+  uint8_t *out = tx_buf;
+  *out++ = ADB_STATS_DEVICE_COUNT;
+  *out++ = HID_REPORT_KIND_COUNT;
+  for (uint8_t i = 0; i < ADB_STATS_DEVICE_COUNT; i++) {
+    const adb_device_stats *s = adb_stats_get(i);
+    out = put_u32(out, s->frames_ok);
+    out = put_u32(out, s->timeouts);
+    out = put_u32(out, s->bit_errors);
+    out = put_u32(out, s->collisions);
+    out = put_u32(out, s->retries);
+    out = put_u32(out, s->backoffs);
+  }
+  out = put_u32(out, input_event_pending());
+  out = put_u32(out, input_event_high_water());
+  out = put_u32(out, input_event_overflows());
+  for (uint8_t kind = 0; kind < HID_REPORT_KIND_COUNT; kind++) {
+    out = put_u32(out, hid_transport_sent(kind));
+    out = put_u32(out, hid_transport_dropped(kind));
+  }
+  out = put_u32(out, counters.frames);
+  out = put_u32(out, counters.crc_errors);
+  out = put_u32(out, counters.length_errors);
+  respond(CTRL_GET_COUNTERS | CTRL_RESPONSE, tx_buf, out - tx_buf);
+}
+
+/**
+ * @brief Traite une trame reçue dont le CRC est valide.
+ */
+static void dispatch(uint8_t type, const uint8_t *payload, uint16_t len) {
+  switch (type) {
+  case CTRL_PING:
+    tx_buf[0] = CTRL_VERSION;
+    respond(type | CTRL_RESPONSE, tx_buf, 1);
+    return;
+  case CTRL_GET_CONFIG:
+    if (len != 1)
+      break;
+    send_config(type, payload[0]);
+    return;
+  case CTRL_SET_CONFIG:
+    if (len != 5)
+      break;
+    if (!config_set(payload[0], get_u32(payload + 1))) {
+      nak(type, CTRL_ERR_KEY);
+      return;
+    }
+    send_config(type, payload[0]);
+    return;
+  case CTRL_GET_COUNTERS:
+    send_counters();
+    return;
+  case CTRL_REMAP_WRITE:
+    if (rx_bulk == nullptr)
+      nak(type, CTRL_ERR_RANGE);
+    else
+      ack(type);
+    return;
+  case CTRL_REMAP_COMMIT:
+    if (len != 2)
+      break;
+    if (ctrl_crc16(0xFFFF, key_remap_staging(), KEY_REMAP_SIZE) !=
+        get_u16(payload)) {
+      nak(type, CTRL_ERR_CHECK);
+      return;
+    }
+    key_remap_commit();
+    ack(type);
+    return;
+  case CTRL_TRACE_INFO: {
+    uint8_t *out = put_u32(tx_buf, event_trace_total());
+    *out++ = EVENT_TRACE_SIZE & 0xFF;
+    *out++ = EVENT_TRACE_SIZE >> 8;
+    *out++ = sizeof(trace_entry);
+    respond(type | CTRL_RESPONSE, tx_buf, out - tx_buf);
+    return;
+  }
+  case CTRL_TRACE_READ: {
+    if (len != 3)
+      break;
+    // Émission directe depuis le tampon de trace
+    const uint8_t *bytes = event_trace_bytes(get_u16(payload), payload[2]);
+    if (bytes == nullptr) {
+      nak(type, CTRL_ERR_RANGE);
+      return;
+    }
+    respond(type | CTRL_RESPONSE, bytes, payload[2]);
+    return;
+  }
+  default:
+    nak(type, CTRL_ERR_TYPE);
+    return;
+  }
+  nak(type, CTRL_ERR_LENGTH);
+}
+
+/**
+ * @brief Range un octet de charge utile, directement à destination pour les
+ * téléversements.
+ */
+static void store_payload(uint8_t byte) {
+  if (rx_type == CTRL_REMAP_WRITE && rx_pos >= CTRL_REMAP_PREFIX) {
+    if (rx_bulk != nullptr)
+      rx_bulk[rx_pos - CTRL_REMAP_PREFIX] = byte;
+  } else {
+    rx_payload[rx_pos] = byte;
+  }
+  rx_pos++;
+
+  if (rx_type == CTRL_REMAP_WRITE && rx_pos == CTRL_REMAP_PREFIX) {
+    uint16_t offset = get_u16(rx_payload);
+    uint16_t count = rx_len - CTRL_REMAP_PREFIX;
+    rx_bulk = (uint32_t)offset + count <= KEY_REMAP_SIZE
+                  ? key_remap_staging() + offset
+                  : nullptr;
+  }
+}
+
+bool ctrl_proto_feed(uint8_t byte) {
+  switch (rx_state) {
+  case RX_SYNC:
+    if (byte != CTRL_SYNC)
+      return false;
+    rx_crc = 0xFFFF;
+    rx_state = RX_LEN_LO;
+    return true;
+  case RX_LEN_LO:
+    rx_len = byte;
+    rx_state = RX_LEN_HI;
+    break;
+  case RX_LEN_HI:
+    rx_len |= (uint16_t)byte << 8;
+    if (rx_len > CTRL_PAYLOAD_MAX) {
+      counters.length_errors++;
+      rx_state = RX_SYNC;
+      return true;
+    }
+    rx_state = RX_TYPE;
+    break;
+  case RX_TYPE:
+    rx_type = byte;
+    rx_pos = 0;
+    rx_bulk = nullptr;
+    if (rx_type == CTRL_REMAP_WRITE && rx_len < CTRL_REMAP_PREFIX)
+      rx_type = 0; // Décalage absent : refusé comme type inconnu
+    rx_state = rx_len > 0 ? RX_PAYLOAD : RX_CRC_LO;
+    break;
+  case RX_PAYLOAD:
+    store_payload(byte);
+    if (rx_pos == rx_len)
+      rx_state = RX_CRC_LO;
+    break;
+  case RX_CRC_LO:
+    rx_frame_crc = byte;
+    rx_state = RX_CRC_HI;
+    return true;
+  case RX_CRC_HI:
+    rx_frame_crc |= (uint16_t)byte << 8;
+    rx_state = RX_SYNC;
+    if (rx_frame_crc != rx_crc) {
+      counters.crc_errors++;
+      nak(rx_type, CTRL_ERR_CRC);
+      return true;
+    }
+    counters.frames++;
+    client_seen = true;
+    dispatch(rx_type, rx_payload, rx_len);
+    return true;
+  }
+
+  rx_crc = ctrl_crc16(rx_crc, &byte, 1);
+  return true;
+}
+
+bool ctrl_proto_busy() { return tx_pending; }
+
+bool ctrl_proto_owns_port() { return client_seen || tx_pending; }
+
+/**
+ * @brief Émet la partie d'un segment de la réponse qui tient dans la place
+ * disponible.
+ *
+ * @return true si le segment est entièrement émis.
+ */
+static bool send_segment(const uint8_t *data, uint16_t len, uint16_t start,
+                         size_t *room) {
+  if (tx_sent >= start + len)
+    return true;
+  uint16_t done = tx_sent - start;
+  size_t chunk = len - done;
+  if (chunk > *room)
+    chunk = *room;
+  if (chunk > 0) {
+    size_t written = write_out(data + done, chunk);
+    tx_sent += written;
+    *room -= written;
+  }
+  return tx_sent == start + len;
+}
+
+void ctrl_proto_service() {
+  if (!tx_pending || write_out == nullptr)
+    return;
+
+  size_t room = room_out != nullptr ? room_out() : SIZE_MAX;
+  if (send_segment(tx_header, CTRL_HEADER_LEN, 0, &room) &&
+      send_segment(tx_payload, tx_len, CTRL_HEADER_LEN, &room) &&
+      send_segment(tx_crc, 2, CTRL_HEADER_LEN + tx_len, &room))
+    tx_pending = false;
+}
+
+void ctrl_proto_init(ctrl_write_fn write, ctrl_room_fn room) {
+  write_out = write;
+  room_out = room;
+  rx_state = RX_SYNC;
+  tx_pending = false;
+  client_seen = false;
+  counters = ctrl_counters();
+}
+
+const ctrl_counters &ctrl_proto_get_counters() { return counters; }
@@ -0,0 +1,152 @@
+/**
+ * @file ctrl_proto.h
+ * @brief Protocole binaire de contrôle et de télémétrie.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Trame : CTRL_SYNC, longueur de la charge utile (16 bits), type, charge
+ * utile, CRC-16/CCITT (16 bits) calculé de la longueur à la fin de la charge
+ * utile. Entiers en petit-boutiste. Une réponse porte le type de la requête
+ * avec le bit CTRL_RESPONSE ; un refus est une trame CTRL_NAK.
+ *
+ * | Requête            | Charge utile           | Réponse                     |
+ * |--------------------|------------------------|-----------------------------|
+ * | CTRL_PING          | -                      | version                     |
+ * | CTRL_GET_CONFIG    | clé                    | clé, valeur (32 bits)       |
+ * | CTRL_SET_CONFIG    | clé, valeur (32 bits)  | clé, valeur appliquée       |
+ * | CTRL_GET_COUNTERS  | -                      | compteurs (voir .cpp)       |
+ * | CTRL_REMAP_WRITE   | décalage (16), octets  | CTRL_ACK                    |
+ * | CTRL_REMAP_COMMIT  | CRC de la table (16)   | CTRL_ACK                    |
+ * | CTRL_TRACE_INFO    | -                      | total (32), taille, entrée  |
+ * | CTRL_TRACE_READ    | décalage (16), longueur| octets de la trace          |
+ *
+ * Les octets de CTRL_REMAP_WRITE sont écrits directement dans le banc de
+ * préparation de la table, ceux de CTRL_TRACE_READ envoyés directement
+ * depuis le tampon de trace : aucune copie intermédiaire.
+ *
+ * Le protocole partage le port série avec les traces texte : hors trame,
+ * un octet différent de CTRL_SYNC est rendu à l'appelant (commandes `s`,
+ * `r`). Une réponse part en plusieurs passes selon la place en émission ;
+ * pour qu'aucune trace ne s'y intercale, le texte se tait dès la première
+ * trame valide reçue et jusqu'au redémarrage (voir ctrl_proto_owns_port()
+ * et text_console.h).
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef CTRL_PROTO_H
+#define CTRL_PROTO_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define CTRL_SYNC 0x7E          /**< Premier octet d'une trame. */
+#define CTRL_VERSION 1          /**< Version du protocole. */
+#define CTRL_PAYLOAD_MAX 192    /**< Charge utile maximale. */
+#define CTRL_OVERHEAD 6         /**< Synchro, longueur, type, CRC. */
+#define CTRL_SERVICE_BUDGET 256 /**< Octets traités par appel au maximum. */
+
+/**
+ * @enum ctrl_type
+ * @brief Types de trame.
+ */
+enum ctrl_type : uint8_t {
+  CTRL_PING = 0x01,
+  CTRL_GET_CONFIG,
+  CTRL_SET_CONFIG,
+  CTRL_GET_COUNTERS,
+  CTRL_REMAP_WRITE,
+  CTRL_REMAP_COMMIT,
+  CTRL_TRACE_INFO,
+  CTRL_TRACE_READ,
+  CTRL_ACK = 0x70,    /**< Charge utile : type de la requête. */
+  CTRL_NAK = 0x71,    /**< Charge utile : type de la requête, erreur. */
+  CTRL_RESPONSE = 0x80 /**< Bit ajouté au type d'une réponse. */
+};
+
+/**
+ * @enum ctrl_error
+ * @brief Causes de refus (CTRL_NAK).
+ */
+enum ctrl_error : uint8_t {
+  CTRL_ERR_CRC = 1, /**< CRC de trame invalide. */
+  CTRL_ERR_LENGTH,  /**< Charge utile de longueur inattendue. */
+  CTRL_ERR_TYPE,    /**< Type inconnu. */
+  CTRL_ERR_RANGE,   /**< Décalage ou longueur hors du tampon. */
+  CTRL_ERR_KEY,     /**< Clé de configuration inconnue ou en lecture seule. */
+  CTRL_ERR_CHECK    /**< Contrôle de la table téléversée invalide. */
+};
+
+/**
+ * @enum ctrl_config_key
+ * @brief Paramètres accessibles par CTRL_GET_CONFIG / CTRL_SET_CONFIG.
+ */
+enum ctrl_config_key : uint8_t {
+  CTRL_CFG_VERSION = 0,  /**< Version du protocole (lecture seule). */
+  CTRL_CFG_TAP_HOLD_MS,  /**< Maintien des touches à bascule (ms). */
+  CTRL_CFG_REMAP_ENABLE, /**< Réaffectation des touches (0/1). */
+  CTRL_CFG_TRACE_ENABLE, /**< Enregistrement de la trace (0/1). */
+  CTRL_CFG_SOF_SYNC,     /**< Interrogation calée sur les SOF USB (0/1). */
+  CTRL_CFG_JOYSTICK_DEADZONE /**< Zone morte des manettes (Q15). */
+};
+
+/**
+ * @struct ctrl_counters
+ * @brief Compteurs du protocole.
+ */
+struct ctrl_counters {
+  uint32_t frames = 0;        /**< Trames valides traitées. */
+  uint32_t crc_errors = 0;    /**< Trames rejetées (CRC). */
+  uint32_t length_errors = 0; /**< Trames trop longues. */
+};
+
+/** Écrit des octets ; retourne le nombre d'octets acceptés. */
+typedef size_t (*ctrl_write_fn)(const uint8_t *data, size_t len);
+/** Place disponible en émission, en octets. */
+typedef size_t (*ctrl_room_fn)();
+
+/**
+ * @brief Initialise le protocole avec les fonctions d'émission.
+ */
+void ctrl_proto_init(ctrl_write_fn write, ctrl_room_fn room);
+
+/**
+ * @brief Traite un octet reçu.
+ *
+ * @return false si l'octet n'appartient pas à une trame (commande texte).
+ */
+bool ctrl_proto_feed(uint8_t byte);
+
+/**
+ * @brief Indique qu'une réponse attend de la place en émission.
+ *
+ * Tant que c'est le cas, l'appelant cesse de lire le port : la réception
+ * est freinée plutôt que de perdre une réponse.
+ */
+bool ctrl_proto_busy();
+
+/**
+ * @brief Indique que le port appartient au protocole binaire.
+ *
+ * Vrai dès qu'une trame valide a été reçue, ou tant qu'une réponse est en
+ * cours d'émission : toute sortie texte sur le même port est alors
+ * supprimée.
+ */
+bool ctrl_proto_owns_port();
+
+/**
+ * @brief Émet la réponse en attente si la place le permet (non bloquant).
+ */
+void ctrl_proto_service();
+
+/**
+ * @brief CRC-16/CCITT (polynôme 0x1021, valeur initiale 0xFFFF).
+ */
+uint16_t ctrl_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+/** @brief Compteurs du protocole. */
+const ctrl_counters &ctrl_proto_get_counters();
+
+#endif // CTRL_PROTO_H
@@ -0,0 +1,49 @@
+/**
+ * @file display_panel_native.cpp
+ * @brief Écran natif : recopie les transferts dans une image pour les tests
+ * et le simulateur.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "status_display.h"
+
+#if !defined(ARDUINO) || defined(ADB_SIM)
+#include <cstring>
+
+static uint8_t panel_frame[DISPLAY_PAGES * DISPLAY_WIDTH];
+static uint32_t panel_bytes = 0;
+static bool panel_busy = false;
+
+static bool native_begin() { return true; }
+
+static bool native_busy() { return panel_busy; }
+
+static bool native_write(uint8_t page, uint8_t column, const uint8_t *data,
+                         uint8_t len) {
+  if (page >= DISPLAY_PAGES || column + len > DISPLAY_WIDTH)
+    return false;
+  memcpy(panel_frame + page * DISPLAY_WIDTH + column, data, len);
+  panel_bytes += len;
+  return true;
+}
+
+const display_panel display_panel_native = {"native", native_begin,
+                                            native_busy, native_write};
+
+const uint8_t *display_panel_native_frame() { return panel_frame; }
+
+uint32_t display_panel_native_bytes() { return panel_bytes; }
+
+void display_panel_native_set_busy(bool busy) { panel_busy = busy; }
+
+void display_panel_native_reset() {
+  memset(panel_frame, 0, sizeof(panel_frame));
+  panel_bytes = 0;
+  panel_busy = false;
+}
+#endif
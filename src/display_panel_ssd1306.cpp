@@ -0,0 +1,210 @@
+/**
+ * @file display_panel_ssd1306.cpp
+ * @brief Écran OLED SSD1306 128×64 en I2C (adresse 0x3C).
+ * @part of Apple-ADB-Ressurector
+ *
+ * Chaque écriture place une fenêtre (colonnes, page) en adressage
+ * horizontal puis envoie les colonnes de l'image.
+ *
+ * - STM32F1 : I2C1 (PB6/PB7) à 400 kHz, les deux transferts (fenêtre puis
+ *   données) passent par le DMA et s'enchaînent sous interruption ; aucune
+ *   attente dans la boucle principale.
+ * - ESP32 : Wire (GPIO 21/22), appels bloquants faits depuis loop(), qui ne
+ *   porte pas l'interrogation ADB (tâche adbTask).
+ *
+ * Activé par `-D DISPLAY_ENABLED`.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "status_display.h"
+
+#if defined(DISPLAY_ENABLED) &&                                                \
+    ((defined(ARDUINO_ARCH_STM32) && defined(STM32F1xx)) ||                   \
+     defined(ARDUINO_ARCH_ESP32))
+#include <Arduino.h>
+
+#define SSD1306_I2C_ADDRESS 0x3C
+#define SSD1306_CONTROL_COMMAND 0x00
+#define SSD1306_CONTROL_DATA 0x40
+
+// Pompe de charge interne, adressage horizontal, balayage retourné
+static const uint8_t init_sequence[] = {
+    0xAE,       // Écran éteint
+    0xD5, 0x80, // Horloge
+    0xA8, 0x3F, // 64 lignes
+    0xD3, 0x00, // Décalage vertical
+    0x40,       // Première ligne
+    0x8D, 0x14, // Pompe de charge
+    0x20, 0x00, // Adressage horizontal
+    0xA1,       // Colonnes inversées
+    0xC8,       // Balayage COM inversé
+    0xDA, 0x12, // Broches COM
+    0x81, 0xCF, // Contraste
+    0xD9, 0xF1, // Précharge
+    0xDB, 0x40, // VCOMH
+    0xA4,       // Affichage de la RAM
+    0xA6,       // Non inversé
+    0xAF        // Écran allumé
+};
+
+/**
+ * @brief Fenêtre d'écriture : colonnes [column, column + len - 1] de la page.
+ */
+static void set_window(uint8_t *window, uint8_t page, uint8_t column,
+                       uint8_t len) {
+  window[0] = 0x21;
+  window[1] = column;
+  window[2] = column + len - 1;
+  window[3] = 0x22;
+  window[4] = page;
+  window[5] = page;
+}
+
+#if defined(ARDUINO_ARCH_STM32)
+enum : uint8_t { XFER_IDLE = 0, XFER_WINDOW, XFER_DATA };
+
+static I2C_HandleTypeDef i2c;
+static DMA_HandleTypeDef dma_tx;
+static volatile uint8_t xfer = XFER_IDLE;
+static uint8_t window[6];
+static const uint8_t *xfer_data;
+static uint8_t xfer_len;
+
+extern "C" void DMA1_Channel6_IRQHandler() { HAL_DMA_IRQHandler(&dma_tx); }
+extern "C" void I2C1_EV_IRQHandler() { HAL_I2C_EV_IRQHandler(&i2c); }
+extern "C" void I2C1_ER_IRQHandler() { HAL_I2C_ER_IRQHandler(&i2c); }
+
+// Fin d'un transfert DMA : la fenêtre est suivie des données
+extern "C" void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  if (hi2c != &i2c)
+    return;
+  if (xfer == XFER_WINDOW &&
+      HAL_I2C_Mem_Write_DMA(&i2c, SSD1306_I2C_ADDRESS << 1,
+                            SSD1306_CONTROL_DATA, I2C_MEMADD_SIZE_8BIT,
+                            const_cast<uint8_t *>(xfer_data),
+                            xfer_len) == HAL_OK) {
+    xfer = XFER_DATA;
+    return;
+  }
+  xfer = XFER_IDLE;
+}
+
+extern "C" void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+  if (hi2c == &i2c)
+    xfer = XFER_IDLE; // La page est perdue jusqu'au prochain changement
+}
+
+static bool ssd1306_begin() {
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  __HAL_RCC_I2C1_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  GPIO_InitTypeDef gpio = {};
+  gpio.Pin = GPIO_PIN_6 | GPIO_PIN_7;
+  gpio.Mode = GPIO_MODE_AF_OD;
+  gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_Init(GPIOB, &gpio);
+
+  i2c.Instance = I2C1;
+  i2c.Init.ClockSpeed = 400000;
+  i2c.Init.DutyCycle = I2C_DUTYCYCLE_2;
+  i2c.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+  i2c.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+  i2c.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+  i2c.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+  if (HAL_I2C_Init(&i2c) != HAL_OK)
+    return false;
+
+  dma_tx.Instance = DMA1_Channel6; // I2C1_TX
+  dma_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  dma_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+  dma_tx.Init.MemInc = DMA_MINC_ENABLE;
+  dma_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  dma_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  dma_tx.Init.Mode = DMA_NORMAL;
+  dma_tx.Init.Priority = DMA_PRIORITY_LOW;
+  if (HAL_DMA_Init(&dma_tx) != HAL_OK)
+    return false;
+  __HAL_LINKDMA(&i2c, hdmatx, dma_tx);
+
+  // Priorité la plus basse : l'USB et le SysTick passent devant
+  HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 15, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+  HAL_NVIC_SetPriority(I2C1_EV_IRQn, 15, 0);
+  HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+  HAL_NVIC_SetPriority(I2C1_ER_IRQn, 15, 0);
+  HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+
+  // Initialisation au démarrage : transfert bloquant
+  return HAL_I2C_Mem_Write(&i2c, SSD1306_I2C_ADDRESS << 1,
+                           SSD1306_CONTROL_COMMAND, I2C_MEMADD_SIZE_8BIT,
+                           const_cast<uint8_t *>(init_sequence),
+                           sizeof(init_sequence), 50) == HAL_OK;
+}
+
+static bool ssd1306_busy() { return xfer != XFER_IDLE; }
+
+static bool ssd1306_write(uint8_t page, uint8_t column, const uint8_t *data,
+                          uint8_t len) {
+  if (xfer != XFER_IDLE)
+    return false;
+
+  set_window(window, page, column, len);
+  xfer_data = data;
+  xfer_len = len;
+  xfer = XFER_WINDOW;
+  if (HAL_I2C_Mem_Write_DMA(&i2c, SSD1306_I2C_ADDRESS << 1,
+                            SSD1306_CONTROL_COMMAND, I2C_MEMADD_SIZE_8BIT,
+                            window, sizeof(window)) != HAL_OK) {
+    xfer = XFER_IDLE;
+    return false;
+  }
+  return true;
+}
+#else
+// Wire n'est lié que sur ESP32 : sur STM32, son utility/twi.c définit les
+// mêmes interruptions I2C1 (lib_ignore = Wire dans platformio.ini)
+#include <Wire.h>
+
+// Tampon Wire de 128 octets : données envoyées par tranches
+#define SSD1306_WIRE_CHUNK 64
+
+static bool send(uint8_t control, const uint8_t *data, uint8_t len) {
+  Wire.beginTransmission(SSD1306_I2C_ADDRESS);
+  Wire.write(control);
+  Wire.write(data, len);
+  return Wire.endTransmission() == 0;
+}
+
+static bool ssd1306_begin() {
+  Wire.begin();
+  Wire.setClock(400000);
+  return send(SSD1306_CONTROL_COMMAND, init_sequence, sizeof(init_sequence));
+}
+
+static bool ssd1306_busy() { return false; }
+
+static bool ssd1306_write(uint8_t page, uint8_t column, const uint8_t *data,
+                          uint8_t len) {
+  uint8_t window[6];
+  set_window(window, page, column, len);
+  if (!send(SSD1306_CONTROL_COMMAND, window, sizeof(window)))
+    return false;
+  // Adressage horizontal : les tranches se suivent dans la fenêtre
+  for (uint8_t offset = 0; offset < len; offset += SSD1306_WIRE_CHUNK) {
+    uint8_t chunk = len - offset < SSD1306_WIRE_CHUNK ? len - offset
+                                                       : SSD1306_WIRE_CHUNK;
+    if (!send(SSD1306_CONTROL_DATA, data + offset, chunk))
+      return false;
+  }
+  return true;
+}
+#endif
+
+const display_panel display_panel_ssd1306 = {"ssd1306", ssd1306_begin,
+                                             ssd1306_busy, ssd1306_write};
+#endif
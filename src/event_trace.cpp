@@ -0,0 +1,52 @@
+/**
+ * @file event_trace.cpp
+ * @brief Implémentation de la trace des événements d'entrée.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "event_trace.h"
+#include <atomic>
+#include <cstring>
+
+static_assert(sizeof(trace_entry) == 12, "Format de trace fixe : 12 octets");
+
+static trace_entry entries[EVENT_TRACE_SIZE];
+static std::atomic<uint32_t> total{0};
+static std::atomic<bool> enabled{false};
+
+void event_trace_record(const input_event &event, uint32_t report_us) {
+  if (!enabled.load(std::memory_order_relaxed))
+    return;
+
+  uint32_t index = total.load(std::memory_order_relaxed);
+  trace_entry &entry = entries[index % EVENT_TRACE_SIZE];
+  entry.event_us = event.timestamp_us;
+  entry.report_us = report_us;
+  entry.type = event.type;
+  entry.code = event.code;
+  entry.dx = event.dx;
+  entry.dy = event.dy;
+  total.store(index + 1, std::memory_order_release);
+}
+
+void event_trace_set_enabled(bool on) { enabled = on; }
+
+bool event_trace_enabled() { return enabled; }
+
+uint32_t event_trace_total() { return total.load(std::memory_order_acquire); }
+
+const uint8_t *event_trace_bytes(uint16_t offset, uint16_t len) {
+  if ((uint32_t)offset + len > sizeof(entries))
+    return nullptr;
+  return reinterpret_cast<const uint8_t *>(entries) + offset;
+}
+
+void event_trace_reset() {
+  memset(entries, 0, sizeof(entries));
+  total = 0;
+}
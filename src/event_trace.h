@@ -0,0 +1,70 @@
+/**
+ * @file event_trace.h
+ * @brief Trace circulaire des événements d'entrée et de leur traitement.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Chaque événement consommé par hid_reports_service() est enregistré avec
+ * l'instant de son décodage et celui de la construction du rapport. Le
+ * tampon est téléchargé tel quel par le protocole de contrôle ; désactiver
+ * la trace avant de la lire garantit un instantané cohérent.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include "input_events.h"
+#include <cstddef>
+#include <cstdint>
+
+#define EVENT_TRACE_SIZE 64 /**< Entrées conservées. */
+
+/**
+ * @struct trace_entry
+ * @brief Entrée de trace (12 octets, petit-boutiste sur les deux cibles).
+ */
+struct trace_entry {
+  uint32_t event_us;  /**< Décodage de l'événement (micros()). */
+  uint32_t report_us; /**< Construction du rapport (micros()). */
+  uint8_t type;       /**< Voir input_event_type. */
+  uint8_t code;
+  int8_t dx;
+  int8_t dy;
+};
+
+/**
+ * @brief Enregistre un événement traité (consommateur des événements).
+ */
+void event_trace_record(const input_event &event, uint32_t report_us);
+
+/** @brief Active ou suspend l'enregistrement. */
+void event_trace_set_enabled(bool enabled);
+
+/** @brief Indique si l'enregistrement est actif. */
+bool event_trace_enabled();
+
+/**
+ * @brief Nombre total d'entrées enregistrées depuis la remise à zéro.
+ *
+ * L'entrée la plus ancienne encore présente est à l'index
+ * `total % EVENT_TRACE_SIZE` lorsque le tampon a fait le tour.
+ */
+uint32_t event_trace_total();
+
+/**
+ * @brief Accès direct aux octets du tampon (téléchargement sans copie).
+ *
+ * @param offset Décalage en octets.
+ * @param len Nombre d'octets demandés.
+ * @return nullptr si la plage dépasse le tampon.
+ */
+const uint8_t *event_trace_bytes(uint16_t offset, uint16_t len);
+
+/** @brief Vide la trace. */
+void event_trace_reset();
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,28 @@
+/**
+ * @file hid_joystick.cpp
+ * @brief Implémentation des rapports HID de manette de jeu.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_joystick.h"
+#include "hid_transport.h"
+
+// Rapport construit une seule fois, remis par pointeur aux transports
+static uint8_t joystick_report_buf[HID_JOYSTICK_REPORT_LEN];
+
+void hid_joystick_send_report(const joystick_sample &sample) {
+    uint8_t *j = joystick_report_buf;
+    j[0] = sample.buttons;
+    for (uint8_t i = 0; i < ADB_JOYSTICK_AXES; i++) {
+        uint16_t axis = (uint16_t)sample.axes[i];
+        j[1 + 2 * i] = axis & 0xFF;
+        j[2 + 2 * i] = axis >> 8;
+    }
+
+    hid_transport_submit(HID_REPORT_JOYSTICK, j, sizeof(joystick_report_buf));
+}
@@ -0,0 +1,34 @@
+/**
+ * @file hid_joystick.h
+ * @brief Rapports HID de manette de jeu pour les joysticks ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Rapport de 7 octets (Report ID 5 en Bluetooth) :
+ * - octet 0 : boutons 1 à 8 ;
+ * - octets 1-2 : X, -ADB_JOYSTICK_AXIS_MAX..ADB_JOYSTICK_AXIS_MAX
+ *   (petit-boutiste) ;
+ * - octets 3-4 : Y, même étendue ;
+ * - octets 5-6 : Z (manette des gaz), même étendue.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef HID_JOYSTICK_H
+#define HID_JOYSTICK_H
+
+#include "adb_joystick.h"
+#include <cstdint>
+
+#define HID_JOYSTICK_REPORT_LEN 7 /**< Taille du rapport de manette. */
+
+/**
+ * @brief Envoie un rapport de manette pour un échantillon.
+ *
+ * @param sample Échantillon étalonné.
+ */
+void hid_joystick_send_report(const joystick_sample &sample);
+
+#endif // HID_JOYSTICK_H
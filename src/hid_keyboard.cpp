@@ -13,82 +13,99 @@
  */
 
 #include "hid_keyboard.h"
-#ifdef ARDUINO_ARCH_STM32
-#include "usbd_hid_composite_if.h"
-#endif
-#ifdef ARDUINO_ARCH_ESP32
-#include <BLEHIDDevice.h> // Ajout de l'inclusion manquante pour BLECharacteristic
-extern bool isBleConnected; // Déclaration externe pour isBleConnected
-extern BLECharacteristic* input_keyboard; // Déclaration externe pour input_keyboard
-#endif
+#include "hid_transport.h"
+#include "input_events.h"
+#include "key_queue.h"
 #include <Arduino.h>
 
-/**
- * @brief Initialise le clavier HID.
- */
-void hid_keyboard_init() {
-#ifdef ARDUINO_ARCH_STM32
-  Serial.println("Initialisation du clavier HID USB...");
-  HID_Composite_Init(HID_KEYBOARD);
-  Serial.println("Clavier HID USB initialisé.");
+// Traces de chaque rapport : 5 à 7 ms à 115200 bauds, de quoi brider une
+// rafale de frappes ; réservées au débogage (-D ADB_DEBUG_HID)
+#ifdef ADB_DEBUG_HID
+#include "text_console.h"
 #endif
 
-#ifdef ARDUINO_ARCH_ESP32
-  Serial.println("Initialisation du clavier HID Bluetooth...");
-  // L'initialisation Bluetooth HID est déjà gérée dans `setupBluetoothHID` dans
-  // main.cpp
-  Serial.println("Clavier HID Bluetooth initialisé.");
-#endif
-}
-
-/**
- * @brief Ferme le clavier HID.
- */
-void hid_keyboard_close() {
-#ifdef ARDUINO_ARCH_STM32
-  Serial.println("Fermeture du clavier HID USB...");
-  HID_Composite_DeInit(HID_KEYBOARD);
-  Serial.println("Clavier HID USB fermé.");
-#endif
-#ifdef ARDUINO_ARCH_ESP32
-  Serial.println("Fermeture du clavier HID Bluetooth...");
-  // Aucune action spécifique nécessaire pour ESP32, car Bluetooth HID est géré
-  // globalement.
-  Serial.println("Clavier HID Bluetooth fermé.");
-#endif
-}
+// Rapports construits une seule fois, remis par pointeur aux transports (le
+// rapport clavier est copié dans la file des frappes)
+static uint8_t keyboard_report_buf[8];
+static uint8_t consumer_report_buf[2];
+static uint8_t leds_report_buf[1];
 
 /**
  * @brief Envoie un rapport HID pour le clavier.
  *
+ * Le rapport passe par la file des frappes : il part aussitôt si l'hôte
+ * l'accepte, sinon après ceux qui le précèdent.
+ *
  * @param report Pointeur vers le rapport HID à envoyer.
+ * @param event_us Horodatage de l'événement d'entrée à l'origine du rapport.
  */
-void hid_keyboard_send_report(hid_key_report *report) {
-  uint8_t buf[8] = {report->modifiers, 0,
-                    report->keys[0],   report->keys[1],
-                    report->keys[2],   report->keys[3],
-                    report->keys[4],   report->keys[5]};
+void hid_keyboard_send_report(hid_key_report *report, uint32_t event_us) {
+  uint8_t *buf = keyboard_report_buf;
+  buf[0] = report->modifiers;
+  buf[1] = 0;
+  for (int i = 0; i < KEY_REPORT_KEYS_COUNT; i++)
+    buf[2 + i] = report->keys[i];
 
-  Serial.print("Envoi du rapport HID clavier - Modificateurs: ");
-  Serial.print(report->modifiers, HEX);
-  Serial.print(", Touches: ");
+#ifdef ADB_DEBUG_HID
+  Console.print("Envoi du rapport HID clavier - Modificateurs: ");
+  Console.print(report->modifiers, HEX);
+  Console.print(", Touches: ");
   for (int i = 0; i < KEY_REPORT_KEYS_COUNT; i++) {
-    Serial.print(report->keys[i], HEX);
+    Console.print(report->keys[i], HEX);
     if (i < KEY_REPORT_KEYS_COUNT - 1)
-      Serial.print(", ");
+      Console.print(", ");
   }
-  Serial.println();
-
-#ifdef ARDUINO_ARCH_STM32
-  HID_Composite_keyboard_sendReport(buf, 8);
+  Console.println();
 #endif
 
-#ifdef ARDUINO_ARCH_ESP32
-  if (isBleConnected) {
-    input_keyboard->setValue(buf, sizeof(buf));
-    input_keyboard->notify();
+  key_queue_push(buf, event_us);
+  key_queue_pump();
+}
+
+/**
+ * @brief Envoie un rapport Consumer Control (touches multimédia).
+ *
+ * @param usage Usage de la page Consumer (0 pour « aucune touche »).
+ */
+void hid_keyboard_send_consumer(uint16_t usage) {
+  consumer_report_buf[0] = usage & 0xFF;
+  consumer_report_buf[1] = usage >> 8;
+  hid_transport_submit(HID_REPORT_CONSUMER, consumer_report_buf,
+                       sizeof(consumer_report_buf));
+}
+
+/**
+ * @brief Usage Consumer d'une touche ADB (touches son et Power).
+ *
+ * @param adb_keycode Code ADB de la touche (INPUT_ADB_POWER_CODE pour Power).
+ * @return Usage de la page Consumer, 0 pour une touche ordinaire.
+ */
+uint16_t hid_keyboard_consumer_usage(uint8_t adb_keycode) {
+  switch (adb_keycode) {
+  case ADB_KEY_CODE_VOLUME_UP:
+    return CONSUMER_USAGE_VOLUME_UP;
+  case ADB_KEY_CODE_VOLUME_DOWN:
+    return CONSUMER_USAGE_VOLUME_DOWN;
+  case ADB_KEY_CODE_MUTE:
+    return CONSUMER_USAGE_MUTE;
+  case INPUT_ADB_POWER_CODE:
+    return CONSUMER_USAGE_POWER;
+  default:
+    return 0;
   }
-#endif
+}
+
+/**
+ * @brief Envoie l'état des LEDs à l'hôte.
+ *
+ * @param leds Bits des LEDs (Num Lock = 0x01, Caps Lock = 0x02).
+ */
+void hid_keyboard_send_leds(uint8_t leds) {
+  // En USB, l'état des LEDs est piloté par l'hôte : seul le transport
+  // Bluetooth accepte ce rapport.
+  leds_report_buf[0] = leds;
+  hid_transport_submit(HID_REPORT_LEDS, leds_report_buf,
+                       sizeof(leds_report_buf));
 }
 
 /**
@@ -100,38 +117,42 @@ void hid_keyboard_send_report(hid_key_report *report) {
  */
 bool hid_keyboard_set_keys_from_adb_register(
     hid_key_report *report, adb_data<adb_kb_keypress> key_press) {
-  Serial.print("Mise à jour des touches HID depuis le registre ADB - Raw: ");
-  Serial.println(key_press.raw, HEX);
+#ifdef ADB_DEBUG_HID
+  Console.print("Mise à jour des touches HID depuis le registre ADB - Raw: ");
+  Console.println(key_press.raw, HEX);
+#endif
 
   if (key_press.raw == ADBKey::KeyCode::POWER_DOWN)
     return hid_keyboard_update_key_in_report(report, ADB_KEY_POWER, false);
   else if (key_press.raw == ADBKey::KeyCode::POWER_UP)
     return hid_keyboard_update_key_in_report(report, ADB_KEY_POWER, true);
 
-  bool report_changed = false;
-
-  uint8_t key0 = key_press.data.key0;
-  if (ADBKeymap::isModifier(key0))
-    report_changed = hid_keyboard_update_modifier_in_report(
-        report, key0, key_press.data.released0);
-  else
-    report_changed = hid_keyboard_update_key_in_report(
-        report, ADBKeymap::toHID(key0), key_press.data.released0);
-
-  uint8_t key1 = key_press.data.key1;
-  if (ADBKeymap::isModifier(key1))
-    report_changed = hid_keyboard_update_modifier_in_report(
-                         report, key1, key_press.data.released1) ||
-                     report_changed;
-  else
-    report_changed =
-        hid_keyboard_update_key_in_report(report, ADBKeymap::toHID(key1),
-                                          key_press.data.released1) ||
-        report_changed;
+  bool report_changed = hid_keyboard_apply_adb_key(
+      report, key_press.data.key0, key_press.data.released0);
+  report_changed = hid_keyboard_apply_adb_key(report, key_press.data.key1,
+                                              key_press.data.released1) ||
+                   report_changed;
 
   return report_changed;
 }
 
+/**
+ * @brief Applique une transition de touche ADB au rapport HID.
+ *
+ * @param report Pointeur vers le rapport HID.
+ * @param adb_keycode Code ADB de la touche.
+ * @param released Indique si la touche est relâchée.
+ * @return true si le rapport a été modifié, false sinon.
+ */
+bool hid_keyboard_apply_adb_key(hid_key_report *report, uint8_t adb_keycode,
+                                bool released) {
+  if (ADBKeymap::isModifier(adb_keycode))
+    return hid_keyboard_update_modifier_in_report(report, adb_keycode,
+                                                  released);
+  return hid_keyboard_update_key_in_report(
+      report, ADBKeymap::toHID(adb_keycode), released);
+}
+
 /**
  * @brief Met à jour une touche spécifique dans le rapport HID.
  *
@@ -142,10 +163,12 @@ bool hid_keyboard_set_keys_from_adb_register(
  */
 bool hid_keyboard_update_key_in_report(hid_key_report *report,
                                        uint8_t hid_keycode, bool released) {
-  Serial.print("Mise à jour d'une touche HID - Code: ");
-  Serial.print(hid_keycode, HEX);
-  Serial.print(", Relâché: ");
-  Serial.println(released);
+#ifdef ADB_DEBUG_HID
+  Console.print("Mise à jour d'une touche HID - Code: ");
+  Console.print(hid_keycode, HEX);
+  Console.print(", Relâché: ");
+  Console.println(released);
+#endif
 
   if (hid_keycode == ADB_KEY_NONE)
     return false;
@@ -165,8 +188,10 @@ bool hid_keyboard_update_key_in_report(hid_key_report *report,
  */
 bool hid_keyboard_add_key_to_report(hid_key_report *report,
                                     uint8_t hid_keycode) {
-  Serial.print("Ajout d'une touche HID - Code: ");
-  Serial.println(hid_keycode, HEX);
+#ifdef ADB_DEBUG_HID
+  Console.print("Ajout d'une touche HID - Code: ");
+  Console.println(hid_keycode, HEX);
+#endif
 
   int8_t free_slot = -1;
 
@@ -194,8 +219,10 @@ bool hid_keyboard_add_key_to_report(hid_key_report *report,
  */
 bool hid_keyboard_remove_key_from_report(hid_key_report *report,
                                          uint8_t hid_keycode) {
-  Serial.print("Suppression d'une touche HID - Code: ");
-  Serial.println(hid_keycode, HEX);
+#ifdef ADB_DEBUG_HID
+  Console.print("Suppression d'une touche HID - Code: ");
+  Console.println(hid_keycode, HEX);
+#endif
 
   bool report_changed = false;
   for (uint8_t i = 0; i < KEY_REPORT_KEYS_COUNT; i++) {
@@ -219,10 +246,12 @@ bool hid_keyboard_remove_key_from_report(hid_key_report *report,
 bool hid_keyboard_update_modifier_in_report(hid_key_report *report,
                                             uint8_t adb_keycode,
                                             bool released) {
-  Serial.print("Mise à jour d'un modificateur HID - ADB Keycode: ");
-  Serial.print(adb_keycode, HEX);
-  Serial.print(", Relâché: ");
-  Serial.println(released);
+#ifdef ADB_DEBUG_HID
+  Console.print("Mise à jour d'un modificateur HID - ADB Keycode: ");
+  Console.print(adb_keycode, HEX);
+  Console.print(", Relâché: ");
+  Console.println(released);
+#endif
 
   auto update_modifier = [released, report](uint8_t mask) {
     // Vérifie si le modificateur est déjà dans l'état souhaité
@@ -256,6 +285,8 @@ bool hid_keyboard_update_modifier_in_report(hid_key_report *report,
   if (adb_keycode == ADBKey::KeyCode::RIGHT_COMMAND)
     return update_modifier(KEY_MOD_RMETA);
 
-  Serial.println("Modificateur inconnu.");
+#ifdef ADB_DEBUG_HID
+  Console.println("Modificateur inconnu.");
+#endif
   return false; // Aucun changement
 }
\ No newline at end of file
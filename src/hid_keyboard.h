@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <stdbool.h>
 #include "adb.h"
+#include "board.h"
 
 #define KEY_REPORT_KEYS_COUNT 6 /**< Nombre maximum de touches dans un rapport HID. */
 
@@ -27,6 +28,17 @@
 #define KEY_MOD_RALT   0x40
 #define KEY_MOD_RMETA  0x80
 
+// Touches son des claviers ADB étendus (AppleDesign)
+#define ADB_KEY_CODE_VOLUME_UP   0x48
+#define ADB_KEY_CODE_VOLUME_DOWN 0x49
+#define ADB_KEY_CODE_MUTE        0x4A
+
+// Usages de la page Consumer (HID Usage Tables, page 0x0C)
+#define CONSUMER_USAGE_POWER       0x0030
+#define CONSUMER_USAGE_MUTE        0x00E2
+#define CONSUMER_USAGE_VOLUME_UP   0x00E9
+#define CONSUMER_USAGE_VOLUME_DOWN 0x00EA
+
 /**
  * @struct hid_key_report
  * @brief Structure représentant un rapport HID pour un clavier.
@@ -38,20 +50,56 @@ struct hid_key_report {
 
 /**
  * @brief Initialise le clavier HID.
+ *
+ * @tparam Board Carte dont les interfaces HID sont ouvertes.
  */
-void hid_keyboard_init();
+template <typename Board = board> void hid_keyboard_init() {
+    board_log_hid("Initialisation du clavier HID", Board::hid_name, "...");
+    Board::hid_begin(BOARD_HID_KEYBOARD);
+    board_log_hid("Clavier HID", Board::hid_name, " initialisé.");
+}
 
 /**
  * @brief Ferme le clavier HID.
+ *
+ * @tparam Board Carte dont les interfaces HID sont fermées.
  */
-void hid_keyboard_close();
+template <typename Board = board> void hid_keyboard_close() {
+    board_log_hid("Fermeture du clavier HID", Board::hid_name, "...");
+    Board::hid_end(BOARD_HID_KEYBOARD);
+    board_log_hid("Clavier HID", Board::hid_name, " fermé.");
+}
 
 /**
- * @brief Envoie un rapport HID pour le clavier.
+ * @brief Envoie un rapport HID pour le clavier, dans l'ordre des rapports
+ * précédents (voir key_queue.h).
  * 
  * @param report Pointeur vers le rapport HID à envoyer.
+ * @param event_us Horodatage de l'événement d'entrée à l'origine du rapport.
+ */
+void hid_keyboard_send_report(hid_key_report* report, uint32_t event_us);
+
+/**
+ * @brief Envoie un rapport Consumer Control (touches multimédia).
+ * 
+ * @param usage Usage de la page Consumer (0 pour « aucune touche »).
  */
-void hid_keyboard_send_report(hid_key_report* report);
+void hid_keyboard_send_consumer(uint16_t usage);
+
+/**
+ * @brief Usage Consumer d'une touche ADB (touches son et Power).
+ * 
+ * @param adb_keycode Code ADB de la touche (INPUT_ADB_POWER_CODE pour Power).
+ * @return Usage de la page Consumer, 0 pour une touche ordinaire.
+ */
+uint16_t hid_keyboard_consumer_usage(uint8_t adb_keycode);
+
+/**
+ * @brief Envoie l'état des LEDs à l'hôte (Bluetooth uniquement).
+ * 
+ * @param leds Bits des LEDs (Num Lock = 0x01, Caps Lock = 0x02).
+ */
+void hid_keyboard_send_leds(uint8_t leds);
 
 /**
  * @brief Met à jour les touches du rapport HID à partir d'un registre ADB.
@@ -62,6 +110,16 @@ void hid_keyboard_send_report(hid_key_report* report);
  */
 bool hid_keyboard_set_keys_from_adb_register(hid_key_report* report, adb_data<adb_kb_keypress> reg);
 
+/**
+ * @brief Applique une transition de touche ADB au rapport HID.
+ * 
+ * @param report Pointeur vers le rapport HID.
+ * @param adb_keycode Code ADB de la touche.
+ * @param released Indique si la touche est relâchée.
+ * @return true si le rapport a été modifié, false sinon.
+ */
+bool hid_keyboard_apply_adb_key(hid_key_report* report, uint8_t adb_keycode, bool released);
+
 /**
  * @brief Met à jour une touche spécifique dans le rapport HID.
  * 
@@ -12,53 +12,18 @@
  */
 
 #include "hid_mouse.h"
-
-#ifdef ARDUINO_ARCH_STM32
-#include "usbd_hid_composite_if.h"
-#endif
+#include "hid_transport.h"
 
 #include <Arduino.h>
 
-#ifdef ARDUINO_ARCH_ESP32
-#include <BLEHIDDevice.h> // Ajout de l'inclusion manquante pour BLECharacteristic
-#include "ADBKeymap.h" // Assurez-vous que la conversion ADB vers HID est incluse
-extern BLECharacteristic* input_mouse; // Déclaration externe pour input_mouse
-extern bool isBleConnected; // Déclaration externe pour isBleConnected
+// Trace de chaque déplacement réservée au débogage (-D ADB_DEBUG_HID) : sur
+// l'UART, elle coûte plusieurs millisecondes par rapport
+#ifdef ADB_DEBUG_HID
+#include "text_console.h"
 #endif
 
-/**
- * @brief Initialise la souris HID.
- */
-void hid_mouse_init() {
-#ifdef ARDUINO_ARCH_STM32
-    Serial.println("Initialisation de la souris HID USB...");
-    HID_Composite_Init(HID_MOUSE);
-    Serial.println("Souris HID USB initialisée.");
-#endif
-
-#ifdef ARDUINO_ARCH_ESP32
-    Serial.println("Initialisation de la souris HID Bluetooth...");
-    // L'initialisation Bluetooth HID est déjà gérée dans `setupBluetoothHID` dans main.cpp
-    Serial.println("Souris HID Bluetooth initialisée.");
-#endif
-}
-
-/**
- * @brief Ferme la souris HID.
- */
-void hid_mouse_close() {
-#ifdef ARDUINO_ARCH_STM32
-    Serial.println("Fermeture de la souris HID USB...");
-    HID_Composite_DeInit(HID_MOUSE);
-    Serial.println("Souris HID USB fermée.");
-#endif
-
-#ifdef ARDUINO_ARCH_ESP32
-    Serial.println("Fermeture de la souris HID Bluetooth...");
-    // Aucune action spécifique nécessaire pour ESP32, car Bluetooth HID est géré globalement.
-    Serial.println("Souris HID Bluetooth fermée.");
-#endif
-}
+// Rapport construit une seule fois, remis par pointeur aux transports
+static uint8_t mouse_report_buf[4];
 
 /**
  * @brief Envoie un rapport HID pour la souris.
@@ -66,39 +31,24 @@ void hid_mouse_close() {
  * @param button État du bouton de la souris (appuyé ou relâché).
  * @param offset_x Déplacement horizontal de la souris.
  * @param offset_y Déplacement vertical de la souris.
+ * @return false si le point d'accès occupé l'a refusé : à représenter.
  */
-void hid_mouse_send_report(bool button, int8_t offset_x, int8_t offset_y) {
-    uint8_t m[4];
+bool hid_mouse_send_report(bool button, int8_t offset_x, int8_t offset_y) {
+    uint8_t *m = mouse_report_buf;
     m[0] = button; // Bouton de la souris (0 = relâché, 1 = appuyé)
     m[1] = offset_x; // Déplacement horizontal
     m[2] = offset_y; // Déplacement vertical
     m[3] = 0; // Réservé
 
-    Serial.print("Envoi du rapport HID souris - Bouton: ");
-    Serial.print(button);
-    Serial.print(", X: ");
-    Serial.print(offset_x);
-    Serial.print(", Y: ");
-    Serial.println(offset_y);
-
-#ifdef ARDUINO_ARCH_STM32
-    HID_Composite_mouse_sendReport(m, 4);
+#ifdef ADB_DEBUG_HID
+    Console.print("Envoi du rapport HID souris - Bouton: ");
+    Console.print(button);
+    Console.print(", X: ");
+    Console.print(offset_x);
+    Console.print(", Y: ");
+    Console.println(offset_y);
 #endif
 
-#ifdef ARDUINO_ARCH_ESP32
-    if (isBleConnected) {
-        // Traduction des données ADB en HID Bluetooth
-        uint8_t bt_report[4] = {m[0], m[1], m[2], m[3]};
-
-        // Envoi du rapport via Bluetooth
-        input_mouse->setValue(bt_report, sizeof(bt_report));
-        input_mouse->notify();
-
-        // Libération des boutons entre deux actions pour éviter les répétitions
-        delay(5);
-        bt_report[0] = 0; // Aucun bouton appuyé
-        input_mouse->setValue(bt_report, sizeof(bt_report));
-        input_mouse->notify();
-    }
-#endif
+    return hid_transport_offer_all(HID_REPORT_MOUSE, m,
+                                   sizeof(mouse_report_buf));
 }
\ No newline at end of file
@@ -14,17 +14,30 @@
 #ifndef HID_MOUSE_h
 #define HID_MOUSE_h
 
+#include "board.h"
 #include <cstdint>
 
 /**
  * @brief Initialise la souris HID.
+ *
+ * @tparam Board Carte dont les interfaces HID sont ouvertes.
  */
-void hid_mouse_init();
+template <typename Board = board> void hid_mouse_init() {
+    board_log_hid("Initialisation de la souris HID", Board::hid_name, "...");
+    Board::hid_begin(BOARD_HID_MOUSE);
+    board_log_hid("Souris HID", Board::hid_name, " initialisée.");
+}
 
 /**
  * @brief Ferme la souris HID.
+ *
+ * @tparam Board Carte dont les interfaces HID sont fermées.
  */
-void hid_mouse_close();
+template <typename Board = board> void hid_mouse_close() {
+    board_log_hid("Fermeture de la souris HID", Board::hid_name, "...");
+    Board::hid_end(BOARD_HID_MOUSE);
+    board_log_hid("Souris HID", Board::hid_name, " fermée.");
+}
 
 /**
  * @brief Envoie un rapport HID pour la souris.
@@ -32,7 +45,8 @@ void hid_mouse_close();
  * @param button État du bouton de la souris (appuyé ou relâché).
  * @param offset_x Déplacement horizontal de la souris.
  * @param offset_y Déplacement vertical de la souris.
+ * @return false si le point d'accès occupé l'a refusé : à représenter.
  */
-void hid_mouse_send_report(bool button, int8_t offset_x, int8_t offset_y);
+bool hid_mouse_send_report(bool button, int8_t offset_x, int8_t offset_y);
 
 #endif
\ No newline at end of file
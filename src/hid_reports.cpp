@@ -0,0 +1,208 @@
+/**
+ * @file hid_reports.cpp
+ * @brief Construction des rapports HID à partir de la file d'événements.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_reports.h"
+#include "event_trace.h"
+#include "hid_keyboard.h"
+#include "hid_joystick.h"
+#include "hid_mouse.h"
+#include "hid_tablet.h"
+#include "hid_transport.h"
+#include "input_events.h"
+#include "key_queue.h"
+#include <atomic>
+#include <cstdint>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+static hid_key_report key_report = {0};
+static uint8_t tap_hid_keycode = 0; /**< Touche à bascule maintenue. */
+static uint32_t tap_release_ms = 0; /**< Échéance de son relâchement. */
+static std::atomic<uint16_t> tap_hold_ms{KEY_TAP_HOLD_MS};
+
+/**
+ * @struct held_mouse
+ * @brief Rapport souris en attente du point d'accès.
+ */
+struct held_mouse {
+  uint8_t buttons;
+  int16_t dx;
+  int16_t dy;
+};
+
+static uint16_t consumer_usage = 0; /**< Usage Consumer enfoncé. */
+
+// Deux rapports au plus : le rapport retenu et un changement de boutons
+static held_mouse mouse_held[2];
+static uint8_t mouse_held_count = 0;
+
+/**
+ * @brief Horodatage de la construction d'un rapport, pour la trace.
+ */
+static uint32_t report_time_us() {
+#ifdef ARDUINO
+  return static_cast<uint32_t>(micros());
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Relâche la touche à bascule si son maintien est écoulé.
+ *
+ * @return true si aucune frappe n'est plus en cours.
+ */
+static bool release_pending_tap(uint32_t now_ms) {
+  if (tap_hid_keycode == 0)
+    return true;
+  if ((int32_t)(now_ms - tap_release_ms) < 0)
+    return false;
+
+  // Relâchement synthétique : son événement est l'échéance du maintien
+  hid_keyboard_remove_key_from_report(&key_report, tap_hid_keycode);
+  hid_keyboard_send_report(&key_report, report_time_us());
+  tap_hid_keycode = 0;
+  return true;
+}
+
+/**
+ * @brief Achemine les touches son et Power en Consumer Control lorsqu'un
+ * transport porte ce rapport (Bluetooth) ; sinon elles restent des touches
+ * du rapport clavier.
+ *
+ * @return true si la touche a été traitée.
+ */
+static bool send_consumer_key(uint8_t adb_code, bool released) {
+  uint16_t usage = hid_keyboard_consumer_usage(adb_code);
+  if (usage == 0 || !hid_transport_carries(HID_REPORT_CONSUMER))
+    return false;
+
+  // Un seul usage par rapport : le dernier appui l'emporte
+  if (!released) {
+    consumer_usage = usage;
+    hid_keyboard_send_consumer(usage);
+  } else if (consumer_usage == usage) {
+    consumer_usage = 0;
+    hid_keyboard_send_consumer(0);
+  }
+  return true;
+}
+
+static int8_t clamp_axis(int16_t value) {
+  return value > 127 ? 127 : value < -127 ? -127 : (int8_t)value;
+}
+
+static int16_t add_axis(int16_t total, int8_t delta) {
+  int32_t sum = (int32_t)total + delta;
+  return (int16_t)(sum > INT16_MAX    ? INT16_MAX
+                   : sum < -INT16_MAX ? -INT16_MAX
+                                      : sum);
+}
+
+/**
+ * @brief Ajoute un événement souris aux rapports retenus : les déplacements
+ * à boutons identiques sont cumulés, un changement de boutons ouvre un
+ * nouveau rapport.
+ */
+static void hold_mouse(const input_event &event) {
+  uint8_t buttons = event.code & 0x01;
+  if (mouse_held_count > 0 &&
+      mouse_held[mouse_held_count - 1].buttons == buttons) {
+    held_mouse &last = mouse_held[mouse_held_count - 1];
+    last.dx = add_axis(last.dx, event.dx);
+    last.dy = add_axis(last.dy, event.dy);
+    return;
+  }
+  mouse_held[mouse_held_count++] = {buttons, event.dx, event.dy};
+}
+
+/**
+ * @brief Remet les rapports souris retenus, dans l'ordre, jusqu'au premier
+ * refus : le point d'accès occupé retarde le rapport sans le perdre.
+ */
+static void pump_mouse() {
+  while (mouse_held_count > 0) {
+    held_mouse &head = mouse_held[0];
+    int8_t dx = clamp_axis(head.dx);
+    int8_t dy = clamp_axis(head.dy);
+    if (!hid_mouse_send_report(head.buttons, dx, dy))
+      return;
+
+    // Déplacement hors de l'étendue d'un rapport : le reste suit
+    head.dx -= dx;
+    head.dy -= dy;
+    if (head.dx != 0 || head.dy != 0)
+      continue;
+    mouse_held[0] = mouse_held[1];
+    mouse_held_count--;
+  }
+}
+
+void hid_reports_service(uint32_t now_ms) {
+  input_event event;
+
+  // Rafale en cours : les rapports clavier partent au rythme de l'hôte, les
+  // événements suivants attendent une place (relâchement en attente et
+  // changement de boutons souris retenu compris)
+  key_queue_pump();
+  pump_mouse();
+  while (key_queue_free() >= 2 && mouse_held_count < 2 &&
+         release_pending_tap(now_ms) && input_event_pop(event)) {
+    event_trace_record(event, report_time_us());
+    switch (event.type) {
+    case INPUT_EVENT_KEY_DOWN:
+    case INPUT_EVENT_KEY_UP: {
+      bool released = event.type == INPUT_EVENT_KEY_UP;
+      if (send_consumer_key(event.code, released))
+        break;
+      bool changed =
+          event.code == INPUT_ADB_POWER_CODE
+              ? hid_keyboard_update_key_in_report(&key_report, ADB_KEY_POWER,
+                                                  released)
+              : hid_keyboard_apply_adb_key(&key_report, event.code, released);
+      if (changed)
+        hid_keyboard_send_report(&key_report, event.timestamp_us);
+      break;
+    }
+    case INPUT_EVENT_KEY_TAP:
+      // Les touches à bascule ADB (Caps Lock) ne signalent qu'un changement
+      // d'état : chaque transition devient une frappe HID complète.
+      tap_hid_keycode = ADBKeymap::toHID(event.code);
+      hid_keyboard_add_key_to_report(&key_report, tap_hid_keycode);
+      hid_keyboard_send_report(&key_report, event.timestamp_us);
+      tap_release_ms = now_ms + tap_hold_ms;
+      break;
+    case INPUT_EVENT_MOUSE:
+      hold_mouse(event);
+      pump_mouse();
+      break;
+    case INPUT_EVENT_LEDS:
+      hid_keyboard_send_leds(event.code);
+      break;
+    }
+  }
+
+  // Tablette : une transition ou la position la plus récente par tour
+  tablet_sample sample;
+  if (adb_tablet_next(&sample))
+    hid_tablet_send_report(sample);
+
+  // Manette : de même, un changement de bouton ou la dernière position
+  joystick_sample stick;
+  if (adb_joystick_next(&stick))
+    hid_joystick_send_report(stick);
+}
+
+void hid_reports_set_tap_hold_ms(uint16_t hold_ms) { tap_hold_ms = hold_ms; }
+
+uint16_t hid_reports_tap_hold_ms() { return tap_hold_ms; }
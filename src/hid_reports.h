@@ -0,0 +1,43 @@
+/**
+ * @file hid_reports.h
+ * @brief Construction des rapports HID à partir de la file d'événements.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef HID_REPORTS_H
+#define HID_REPORTS_H
+
+#include <cstdint>
+
+/** Durée (ms) de maintien par défaut d'une frappe de touche à bascule. */
+#define KEY_TAP_HOLD_MS 100
+
+/**
+ * @brief Consomme les événements en attente et envoie les rapports HID.
+ *
+ * Non bloquant : une frappe de touche à bascule en cours de maintien
+ * suspend le traitement des événements suivants jusqu'à son relâchement,
+ * afin de préserver l'ordre des frappes. Les rapports clavier en attente
+ * sont d'abord représentés à l'hôte ; les frappes restent dans la file des
+ * événements tant que la file des rapports clavier est pleine. Au plus un rapport de tablette et
+ * un rapport de manette sont envoyés par appel (voir adb_tablet_next() et
+ * adb_joystick_next()).
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+void hid_reports_service(uint32_t now_ms);
+
+/**
+ * @brief Règle la durée de maintien des frappes de touche à bascule.
+ */
+void hid_reports_set_tap_hold_ms(uint16_t hold_ms);
+
+/** @brief Durée de maintien des frappes de touche à bascule. */
+uint16_t hid_reports_tap_hold_ms();
+
+#endif // HID_REPORTS_H
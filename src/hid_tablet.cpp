@@ -0,0 +1,29 @@
+/**
+ * @file hid_tablet.cpp
+ * @brief Implémentation des rapports HID de numériseur.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_tablet.h"
+#include "hid_transport.h"
+
+// Rapport construit une seule fois, remis par pointeur aux transports
+static uint8_t tablet_report_buf[HID_TABLET_REPORT_LEN];
+
+void hid_tablet_send_report(const tablet_sample &sample) {
+    uint8_t *t = tablet_report_buf;
+    t[0] = sample.buttons;
+    t[1] = sample.x & 0xFF;
+    t[2] = sample.x >> 8;
+    t[3] = sample.y & 0xFF;
+    t[4] = sample.y >> 8;
+    t[5] = sample.pressure & 0xFF;
+    t[6] = sample.pressure >> 8;
+
+    hid_transport_submit(HID_REPORT_TABLET, t, sizeof(tablet_report_buf));
+}
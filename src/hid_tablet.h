@@ -0,0 +1,33 @@
+/**
+ * @file hid_tablet.h
+ * @brief Rapports HID de numériseur (stylet) pour les tablettes graphiques.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Rapport de 7 octets (Report ID 4 en Bluetooth) :
+ * - octet 0 : pointe, bouton latéral 1, bouton latéral 2, à portée ;
+ * - octets 1-2 : X absolu, 0..ADB_TABLET_LOGICAL_MAX (petit-boutiste) ;
+ * - octets 3-4 : Y absolu, 0..ADB_TABLET_LOGICAL_MAX (petit-boutiste) ;
+ * - octets 5-6 : pression, 0..ADB_TABLET_PRESSURE_MAX (petit-boutiste).
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef HID_TABLET_H
+#define HID_TABLET_H
+
+#include "adb_tablet.h"
+#include <cstdint>
+
+#define HID_TABLET_REPORT_LEN 7 /**< Taille du rapport numériseur. */
+
+/**
+ * @brief Envoie un rapport numériseur pour un échantillon.
+ *
+ * @param sample Échantillon normalisé.
+ */
+void hid_tablet_send_report(const tablet_sample &sample);
+
+#endif // HID_TABLET_H
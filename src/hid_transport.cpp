@@ -0,0 +1,153 @@
+/**
+ * @file hid_transport.cpp
+ * @brief Répartition des rapports HID vers les transports actifs.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_transport.h"
+
+static const hid_transport *transports[HID_TRANSPORT_MAX];
+static uint8_t transport_count = 0;
+static hid_transport_callback ready_callback = nullptr;
+static hid_transport_callback complete_callback = nullptr;
+static uint32_t sent[HID_REPORT_KIND_COUNT];
+static uint32_t dropped[HID_REPORT_KIND_COUNT];
+
+bool hid_transport_register(const hid_transport *transport) {
+  if (transport == nullptr || transport_count >= HID_TRANSPORT_MAX)
+    return false;
+
+  for (uint8_t i = 0; i < transport_count; i++)
+    if (transports[i] == transport)
+      return true;
+
+  transports[transport_count++] = transport;
+  return true;
+}
+
+void hid_transport_clear() {
+  transport_count = 0;
+  for (uint8_t i = 0; i < HID_REPORT_KIND_COUNT; i++)
+    sent[i] = dropped[i] = 0;
+}
+
+void hid_transport_set_callbacks(hid_transport_callback on_ready,
+                                 hid_transport_callback on_complete) {
+  ready_callback = on_ready;
+  complete_callback = on_complete;
+}
+
+bool hid_transport_offer(uint8_t index, uint8_t kind, const uint8_t *report,
+                         uint8_t len) {
+  if (index >= transport_count || kind >= HID_REPORT_KIND_COUNT)
+    return false;
+
+  const hid_transport *transport = transports[index];
+  if (!transport->send(kind, report, len))
+    return false;
+
+  if (complete_callback != nullptr)
+    complete_callback(transport, kind);
+  return true;
+}
+
+void hid_transport_count_sent(uint8_t kind) {
+  if (kind < HID_REPORT_KIND_COUNT)
+    sent[kind]++;
+}
+
+uint8_t hid_transport_submit(uint8_t kind, const uint8_t *report,
+                             uint8_t len) {
+  if (kind >= HID_REPORT_KIND_COUNT)
+    return 0;
+
+  uint8_t accepted = 0;
+  for (uint8_t i = 0; i < transport_count; i++) {
+    if (transports[i]->ready() && hid_transport_offer(i, kind, report, len))
+      accepted++;
+  }
+
+  if (accepted > 0)
+    sent[kind]++;
+  else
+    dropped[kind]++;
+  return accepted;
+}
+
+bool hid_transport_offer_all(uint8_t kind, const uint8_t *report,
+                             uint8_t len) {
+  if (kind >= HID_REPORT_KIND_COUNT)
+    return true;
+
+  bool any_ready = false;
+  bool accepted = false;
+  for (uint8_t i = 0; i < transport_count; i++) {
+    if (!transports[i]->ready())
+      continue;
+    any_ready = true;
+    if (hid_transport_offer(i, kind, report, len))
+      accepted = true;
+  }
+
+  if (accepted)
+    sent[kind]++;
+  else if (!any_ready)
+    dropped[kind]++;
+  return accepted || !any_ready;
+}
+
+void hid_transport_notify_ready(const hid_transport *transport) {
+  if (ready_callback != nullptr)
+    ready_callback(transport, HID_REPORT_KIND_COUNT);
+}
+
+bool hid_transport_suspended() {
+  if (transport_count == 0)
+    return false;
+
+  for (uint8_t i = 0; i < transport_count; i++) {
+    const hid_transport *transport = transports[i];
+    if (transport->suspended == nullptr || !transport->suspended())
+      return false;
+  }
+  return true;
+}
+
+bool hid_transport_remote_wakeup(bool signal) {
+  bool accepted = false;
+  for (uint8_t i = 0; i < transport_count; i++) {
+    const hid_transport *transport = transports[i];
+    if (transport->remote_wakeup != nullptr &&
+        transport->remote_wakeup(signal))
+      accepted = true;
+  }
+  return accepted;
+}
+
+bool hid_transport_carries(uint8_t kind) {
+  for (uint8_t i = 0; i < transport_count; i++) {
+    const hid_transport *transport = transports[i];
+    if (transport->carries == nullptr || transport->carries(kind))
+      return true;
+  }
+  return false;
+}
+
+uint32_t hid_transport_sent(uint8_t kind) {
+  return kind < HID_REPORT_KIND_COUNT ? sent[kind] : 0;
+}
+
+uint32_t hid_transport_dropped(uint8_t kind) {
+  return kind < HID_REPORT_KIND_COUNT ? dropped[kind] : 0;
+}
+
+uint8_t hid_transport_count() { return transport_count; }
+
+const hid_transport *hid_transport_get(uint8_t index) {
+  return index < transport_count ? transports[index] : nullptr;
+}
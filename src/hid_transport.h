@@ -0,0 +1,241 @@
+/**
+ * @file hid_transport.h
+ * @brief Abstraction des transports HID (USB, Bluetooth, test natif).
+ * @part of Apple-ADB-Ressurector
+ *
+ * Chaque rapport est construit une seule fois dans un tampon statique par
+ * hid_keyboard, hid_mouse, hid_tablet ou hid_joystick, puis remis par
+ * pointeur à tous les transports actifs. Plusieurs transports peuvent être
+ * actifs simultanément (USB et Bluetooth par exemple).
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef HID_TRANSPORT_H
+#define HID_TRANSPORT_H
+
+#include <cstdint>
+
+#define HID_TRANSPORT_MAX 3 /**< Nombre maximum de transports actifs. */
+
+/**
+ * @enum hid_report_kind
+ * @brief Types de rapports acheminés par les transports.
+ */
+enum hid_report_kind : uint8_t {
+  HID_REPORT_KEYBOARD = 0, /**< Rapport clavier, 8 octets. */
+  HID_REPORT_MOUSE,        /**< Rapport souris, 4 octets. */
+  HID_REPORT_CONSUMER,     /**< Rapport Consumer Control, 2 octets. */
+  HID_REPORT_LEDS,         /**< État des LEDs clavier, 1 octet. */
+  HID_REPORT_TABLET,       /**< Numériseur (tablette), 7 octets. */
+  HID_REPORT_JOYSTICK,     /**< Manette de jeu, 7 octets. */
+  HID_REPORT_KIND_COUNT
+};
+
+/**
+ * @struct hid_transport
+ * @brief Interface d'un transport HID.
+ */
+struct hid_transport {
+  const char *name; /**< Nom court, pour les traces. */
+  /** Indique si le transport peut accepter un rapport. */
+  bool (*ready)();
+  /** Envoie un rapport ; le tampon n'est valide que pendant l'appel. */
+  bool (*send)(uint8_t kind, const uint8_t *report, uint8_t len);
+  /** Indique que l'hôte a suspendu le lien (optionnel). */
+  bool (*suspended)();
+  /**
+   * Émet (true) ou arrête (false) la signalisation de réveil à distance
+   * (optionnel) ; false si l'hôte ne l'a pas autorisée.
+   */
+  bool (*remote_wakeup)(bool signal);
+  /**
+   * Indique si le transport porte ce type de rapport (optionnel : tous les
+   * types si absent).
+   */
+  bool (*carries)(uint8_t kind);
+};
+
+/**
+ * @brief Fonction de rappel des événements d'un transport.
+ *
+ * @param transport Transport concerné.
+ * @param kind Type de rapport (HID_REPORT_KIND_COUNT pour « prêt »).
+ */
+typedef void (*hid_transport_callback)(const hid_transport *transport,
+                                       uint8_t kind);
+
+/**
+ * @brief Active un transport.
+ *
+ * @param transport Transport à activer (durée de vie statique).
+ * @return true si le transport a été ajouté, false sinon.
+ */
+bool hid_transport_register(const hid_transport *transport);
+
+/**
+ * @brief Désactive tous les transports.
+ */
+void hid_transport_clear();
+
+/**
+ * @brief Définit les fonctions de rappel « prêt » et « envoi terminé ».
+ *
+ * @param on_ready Appelée lorsqu'un transport devient prêt.
+ * @param on_complete Appelée après chaque envoi réussi.
+ */
+void hid_transport_set_callbacks(hid_transport_callback on_ready,
+                                 hid_transport_callback on_complete);
+
+/**
+ * @brief Remet un rapport à tous les transports prêts, sans copie.
+ *
+ * @param kind Type de rapport (voir hid_report_kind).
+ * @param report Rapport construit par l'appelant.
+ * @param len Longueur du rapport.
+ * @return Nombre de transports ayant accepté le rapport.
+ */
+uint8_t hid_transport_submit(uint8_t kind, const uint8_t *report, uint8_t len);
+
+/**
+ * @brief Remet un rapport à tous les transports prêts ; s'ils le refusent
+ * tous (point d'accès occupé), l'appelant le garde et le représentera.
+ *
+ * Sans transport prêt, le rapport est compté comme perdu, comme avec
+ * hid_transport_submit().
+ *
+ * @return false si le rapport a été refusé et doit être représenté.
+ */
+bool hid_transport_offer_all(uint8_t kind, const uint8_t *report,
+                             uint8_t len);
+
+/**
+ * @brief Propose un rapport à un seul transport, que l'appelant représentera
+ * s'il est refusé.
+ *
+ * Un refus (point d'accès occupé, file pleine) n'est pas compté comme perdu
+ * et l'état « prêt » n'est pas vérifié : l'appelant suit lui-même la
+ * livraison par transport.
+ *
+ * @param index Rang du transport (voir hid_transport_get()).
+ * @return true si le transport a accepté le rapport.
+ */
+bool hid_transport_offer(uint8_t index, uint8_t kind, const uint8_t *report,
+                         uint8_t len);
+
+/**
+ * @brief Compte un rapport remis via hid_transport_offer().
+ */
+void hid_transport_count_sent(uint8_t kind);
+
+/**
+ * @brief Signale qu'un transport est devenu prêt (appelé par le transport).
+ *
+ * @param transport Transport concerné.
+ */
+void hid_transport_notify_ready(const hid_transport *transport);
+
+/**
+ * @brief Indique que l'hôte a suspendu tous les transports actifs.
+ *
+ * Un transport sans fonction `suspended` est considéré comme actif.
+ */
+bool hid_transport_suspended();
+
+/**
+ * @brief Émet ou arrête la signalisation de réveil sur les transports
+ * suspendus.
+ *
+ * @param signal true pour émettre, false pour arrêter.
+ * @return true si au moins un transport a accepté la demande.
+ */
+bool hid_transport_remote_wakeup(bool signal);
+
+/**
+ * @brief Indique qu'au moins un transport enregistré porte ce type de
+ * rapport.
+ *
+ * Un périphérique dont aucun transport ne porte les rapports n'est ni
+ * détecté ni interrogé.
+ */
+bool hid_transport_carries(uint8_t kind);
+
+/**
+ * @brief Nombre de transports enregistrés.
+ */
+uint8_t hid_transport_count();
+
+/**
+ * @brief Transport enregistré par rang (nullptr hors limites).
+ */
+const hid_transport *hid_transport_get(uint8_t index);
+
+/**
+ * @brief Nombre de rapports remis, par type.
+ */
+uint32_t hid_transport_sent(uint8_t kind);
+
+/**
+ * @brief Nombre de rapports qu'aucun transport n'a acceptés, par type.
+ */
+uint32_t hid_transport_dropped(uint8_t kind);
+
+#if defined(ARDUINO_ARCH_STM32) && defined(USBCON)
+extern const hid_transport hid_transport_usb; /**< HID composite USB. */
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+extern const hid_transport hid_transport_ble; /**< HID over GATT. */
+
+/**
+ * @brief Notifie un rapport sur sa caractéristique GATT (tâche Bluetooth).
+ */
+void hid_transport_ble_notify(uint8_t kind, const uint8_t *report,
+                              uint8_t len);
+#endif
+#ifndef ARDUINO
+extern const hid_transport hid_transport_native; /**< Enregistreur natif. */
+
+/**
+ * @brief Dernier rapport reçu par le transport natif.
+ *
+ * @param kind Type de rapport.
+ * @param len Longueur du rapport (sortie, optionnelle).
+ * @return Pointeur vers le rapport enregistré.
+ */
+const uint8_t *hid_transport_native_last(uint8_t kind, uint8_t *len);
+
+/**
+ * @brief Nombre de rapports reçus par le transport natif, par type.
+ */
+uint32_t hid_transport_native_count(uint8_t kind);
+
+/**
+ * @brief Simule la disponibilité du transport natif.
+ */
+void hid_transport_native_set_ready(bool ready);
+
+/**
+ * @brief Simule la suspension du lien par l'hôte.
+ */
+void hid_transport_native_set_suspended(bool suspended);
+
+/**
+ * @brief Simule un point d'accès occupé : prêt, mais refuse les rapports.
+ */
+void hid_transport_native_set_busy(bool busy);
+
+/**
+ * @brief Nombre de signalisations de réveil reçues par le transport natif.
+ */
+uint32_t hid_transport_native_wakeups();
+
+/**
+ * @brief Remet à zéro l'enregistreur natif.
+ */
+void hid_transport_native_reset();
+#endif
+
+#endif // HID_TRANSPORT_H
@@ -0,0 +1,72 @@
+/**
+ * @file hid_transport_ble.cpp
+ * @brief Transport HID Bluetooth (HID over GATT, ESP32).
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_transport.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include "ble_link.h"
+#include <Arduino.h>
+#include <BLEHIDDevice.h>
+
+extern BLECharacteristic *input_keyboard;  // Rapport d'entrée clavier
+extern BLECharacteristic *input_mouse;     // Rapport d'entrée souris
+extern BLECharacteristic *input_consumer;  // Rapport Consumer Control
+extern BLECharacteristic *input_tablet;    // Rapport numériseur
+extern BLECharacteristic *input_joystick;  // Rapport manette de jeu
+extern BLECharacteristic *output_keyboard; // Rapport de sortie LEDs
+
+// Connecté, toujours prêt : une file pleine se vide en quelques événements
+// de connexion et le rapport refusé est représenté. Hors connexion, la file
+// conserve les frappes jusqu'au rétablissement du lien puis le transport
+// est ignoré pour ne pas retenir l'USB
+static bool ble_ready() {
+  return ble_link_connected() || ble_link_pending() < BLE_LINK_QUEUE_SIZE;
+}
+
+static bool ble_send(uint8_t kind, const uint8_t *report, uint8_t len) {
+  // Regroupé par événement de connexion par le gestionnaire de lien
+  return ble_link_enqueue(kind, report, len, millis());
+}
+
+void hid_transport_ble_notify(uint8_t kind, const uint8_t *report,
+                              uint8_t len) {
+  BLECharacteristic *characteristic = nullptr;
+  switch (kind) {
+  case HID_REPORT_KEYBOARD:
+    characteristic = input_keyboard;
+    break;
+  case HID_REPORT_MOUSE:
+    characteristic = input_mouse;
+    break;
+  case HID_REPORT_CONSUMER:
+    characteristic = input_consumer;
+    break;
+  case HID_REPORT_LEDS:
+    characteristic = output_keyboard;
+    break;
+  case HID_REPORT_TABLET:
+    characteristic = input_tablet;
+    break;
+  case HID_REPORT_JOYSTICK:
+    characteristic = input_joystick;
+    break;
+  }
+  if (characteristic == nullptr)
+    return;
+
+  characteristic->setValue(const_cast<uint8_t *>(report), len);
+  characteristic->notify();
+}
+
+// Pas de suspension en Bluetooth : la déconnexion rend le transport non prêt
+const hid_transport hid_transport_ble = {"ble", ble_ready, ble_send, nullptr,
+                                         nullptr};
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file hid_transport_native.cpp
+ * @brief Transport HID natif : enregistre les rapports pour les tests.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_transport.h"
+
+#ifndef ARDUINO
+#include <cstring>
+
+#define NATIVE_REPORT_MAX_LEN 8
+
+static uint8_t last_reports[HID_REPORT_KIND_COUNT][NATIVE_REPORT_MAX_LEN];
+static uint8_t last_lengths[HID_REPORT_KIND_COUNT];
+static uint32_t counts[HID_REPORT_KIND_COUNT];
+static bool native_is_ready = true;
+static bool native_is_suspended = false;
+static bool native_is_busy = false;
+static uint32_t native_wakeups = 0;
+
+static bool native_ready() { return native_is_ready && !native_is_suspended; }
+
+static bool native_send(uint8_t kind, const uint8_t *report, uint8_t len) {
+  if (kind >= HID_REPORT_KIND_COUNT || native_is_busy)
+    return false;
+  if (len > NATIVE_REPORT_MAX_LEN)
+    len = NATIVE_REPORT_MAX_LEN;
+
+  memcpy(last_reports[kind], report, len);
+  last_lengths[kind] = len;
+  counts[kind]++;
+  return true;
+}
+
+static bool native_suspended() { return native_is_suspended; }
+
+static bool native_remote_wakeup(bool signal) {
+  if (signal)
+    native_wakeups++;
+  return true;
+}
+
+const hid_transport hid_transport_native = {
+    "native", native_ready, native_send, native_suspended,
+    native_remote_wakeup};
+
+const uint8_t *hid_transport_native_last(uint8_t kind, uint8_t *len) {
+  if (kind >= HID_REPORT_KIND_COUNT)
+    return nullptr;
+  if (len != nullptr)
+    *len = last_lengths[kind];
+  return last_reports[kind];
+}
+
+uint32_t hid_transport_native_count(uint8_t kind) {
+  return kind < HID_REPORT_KIND_COUNT ? counts[kind] : 0;
+}
+
+void hid_transport_native_set_ready(bool ready) { native_is_ready = ready; }
+
+void hid_transport_native_set_suspended(bool suspended) {
+  native_is_suspended = suspended;
+}
+
+void hid_transport_native_set_busy(bool busy) { native_is_busy = busy; }
+
+uint32_t hid_transport_native_wakeups() { return native_wakeups; }
+
+void hid_transport_native_reset() {
+  memset(last_reports, 0, sizeof(last_reports));
+  memset(last_lengths, 0, sizeof(last_lengths));
+  memset(counts, 0, sizeof(counts));
+  native_is_ready = true;
+  native_is_suspended = false;
+  native_is_busy = false;
+  native_wakeups = 0;
+}
+#endif
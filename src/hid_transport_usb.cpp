@@ -0,0 +1,95 @@
+/**
+ * @file hid_transport_usb.cpp
+ * @brief Transport HID USB (HID composite STM32).
+ * @part of Apple-ADB-Ressurector
+ *
+ * L'état de suspension est lu dans le descripteur de périphérique de la pile
+ * USB du cœur ; le réveil à distance n'est émis que si l'hôte l'a autorisé
+ * (SET_FEATURE DEVICE_REMOTE_WAKEUP). Un rapport clavier ou souris proposé
+ * alors que le précédent attend encore son jeton IN est refusé : la pile
+ * l'ignorerait sans le signaler.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "hid_transport.h"
+
+#if defined(ARDUINO_ARCH_STM32) && defined(USBCON)
+#include "usbd_hid_composite.h"
+#include "usbd_hid_composite_if.h"
+
+// Descripteur de la pile USB défini par le cœur (usbd_hid_composite_if.c)
+extern USBD_HandleTypeDef hUSBD_Device_HID;
+
+static bool usb_suspended() {
+  return hUSBD_Device_HID.dev_state == USBD_STATE_SUSPENDED;
+}
+
+// Aucun rapport vers un point de terminaison suspendu
+static bool usb_ready() { return !usb_suspended(); }
+
+static const USBD_HID_HandleTypeDef *usb_hid() {
+  return static_cast<const USBD_HID_HandleTypeDef *>(
+      hUSBD_Device_HID.pClassData);
+}
+
+// Rapport clavier précédent encore dans le point d'accès
+static bool usb_keyboard_busy() {
+  const USBD_HID_HandleTypeDef *hid = usb_hid();
+  return hid != nullptr && hid->Keyboardstate != HID_IDLE;
+}
+
+// Rapport souris précédent encore dans le point d'accès
+static bool usb_mouse_busy() {
+  const USBD_HID_HandleTypeDef *hid = usb_hid();
+  return hid != nullptr && hid->Mousestate != HID_IDLE;
+}
+
+static bool usb_send(uint8_t kind, const uint8_t *report, uint8_t len) {
+  // L'API HID composite n'accepte pas de pointeur constant mais ne modifie
+  // pas le rapport.
+  uint8_t *data = const_cast<uint8_t *>(report);
+
+  switch (kind) {
+  case HID_REPORT_KEYBOARD:
+    if (usb_keyboard_busy())
+      return false;
+    HID_Composite_keyboard_sendReport(data, len);
+    return true;
+  case HID_REPORT_MOUSE:
+    if (usb_mouse_busy())
+      return false;
+    HID_Composite_mouse_sendReport(data, len);
+    return true;
+  default:
+    // Pas d'interface Consumer Control, numériseur ni manette dans le
+    // composite (voir usb_carries()) ; les LEDs sont pilotées par l'hôte en
+    // USB.
+    return false;
+  }
+}
+
+// Interfaces du composite : clavier et souris seulement
+static bool usb_carries(uint8_t kind) {
+  return kind == HID_REPORT_KEYBOARD || kind == HID_REPORT_MOUSE;
+}
+
+static bool usb_remote_wakeup(bool signal) {
+  if (hUSBD_Device_HID.dev_remote_wakeup == 0)
+    return false;
+
+  PCD_HandleTypeDef *pcd =
+      static_cast<PCD_HandleTypeDef *>(hUSBD_Device_HID.pData);
+  if (signal)
+    HAL_PCD_ActivateRemoteWakeup(pcd);
+  else
+    HAL_PCD_DeActivateRemoteWakeup(pcd);
+  return true;
+}
+
+const hid_transport hid_transport_usb = {
+    "usb", usb_ready, usb_send, usb_suspended, usb_remote_wakeup, usb_carries};
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file host_suspend.cpp
+ * @brief Implémentation du suivi de suspension et du réveil à distance.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "host_suspend.h"
+
+static bool suspended = false;
+static bool wake_requested = false;  // Événement reçu pendant la suspension
+static bool wake_signaled = false;   // Au moins un réveil signalé
+static bool awaiting_report = false; // Reprise obtenue, mesure en cours
+static uint32_t wake_event_us = 0;
+static uint32_t last_signal_ms = 0;
+static host_suspend_stats stats;
+
+void host_suspend_reset() {
+  suspended = false;
+  wake_requested = false;
+  wake_signaled = false;
+  awaiting_report = false;
+  stats = host_suspend_stats();
+}
+
+bool host_suspend_update(bool now_suspended) {
+  if (now_suspended == suspended)
+    return false;
+
+  suspended = now_suspended;
+  if (suspended) {
+    stats.suspends++;
+    wake_requested = false;
+    wake_signaled = false;
+    awaiting_report = false;
+  } else {
+    // Reprise, demandée ou non : seule une demande ouvre une mesure
+    awaiting_report = wake_requested;
+    wake_requested = false;
+  }
+  return true;
+}
+
+bool host_suspend_active() { return suspended; }
+
+void host_suspend_note_wake_event(uint32_t event_us) {
+  if (!suspended || wake_requested)
+    return;
+  wake_requested = true;
+  wake_event_us = event_us;
+}
+
+bool host_suspend_wakeup_due(uint32_t now_ms) {
+  if (!suspended || !wake_requested)
+    return false;
+  if (wake_signaled && now_ms - last_signal_ms < HOST_WAKEUP_RETRY_MS)
+    return false;
+
+  wake_signaled = true;
+  last_signal_ms = now_ms;
+  stats.wakeups++;
+  return true;
+}
+
+bool host_suspend_waking(uint32_t now_ms) {
+  return suspended && wake_signaled &&
+         now_ms - last_signal_ms < HOST_WAKEUP_RETRY_MS;
+}
+
+void host_suspend_note_report(uint32_t now_us) {
+  if (!awaiting_report)
+    return;
+
+  awaiting_report = false;
+  uint32_t latency = now_us - wake_event_us;
+  stats.wake_count++;
+  stats.wake_last_us = latency;
+  if (latency > stats.wake_max_us)
+    stats.wake_max_us = latency;
+}
+
+const host_suspend_stats &host_suspend_get_stats() { return stats; }
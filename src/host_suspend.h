@@ -0,0 +1,104 @@
+/**
+ * @file host_suspend.h
+ * @brief Suspension du bus par l'hôte et réveil à distance.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Tant que l'hôte a suspendu le bus, aucun rapport n'est envoyé : les
+ * événements restent dans la file d'entrée et l'interrogation ADB se limite
+ * à une sonde SRQ au rythme POWER_SUSPEND_POLL_MS. La première frappe ou le
+ * premier clic demande un réveil à distance ; l'événement est remis dès la
+ * reprise, et le délai entre l'événement et le premier rapport accepté est
+ * mesuré.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef HOST_SUSPEND_H
+#define HOST_SUSPEND_H
+
+#include <cstdint>
+
+/** Durée (ms) de la signalisation de réveil (1 à 15 ms selon l'USB 2.0). */
+#define HOST_WAKEUP_SIGNAL_MS 10
+/** Délai (ms) avant une nouvelle demande si l'hôte n'a pas repris. */
+#define HOST_WAKEUP_RETRY_MS 500
+
+/**
+ * @struct host_suspend_stats
+ * @brief Compteurs de suspension et de réveil.
+ */
+struct host_suspend_stats {
+  uint32_t suspends;        /**< Suspensions du bus par l'hôte. */
+  uint32_t wakeups;         /**< Réveils à distance signalés. */
+  uint32_t wake_count;      /**< Réveils mesurés jusqu'au premier rapport. */
+  uint32_t wake_last_us;    /**< Dernier délai événement → premier rapport. */
+  uint32_t wake_max_us;     /**< Délai maximal observé. */
+};
+
+/**
+ * @brief Remet l'état (bus actif) et les compteurs à zéro.
+ */
+void host_suspend_reset();
+
+/**
+ * @brief Prend en compte l'état du bus relevé auprès des transports.
+ *
+ * @param suspended true si l'hôte a suspendu le bus.
+ * @return true si l'état a changé.
+ */
+bool host_suspend_update(bool suspended);
+
+/**
+ * @brief Indique que le bus est suspendu : les rapports sont retenus.
+ */
+bool host_suspend_active();
+
+/**
+ * @brief Signale une frappe ou un clic pendant la suspension.
+ *
+ * Seul le premier événement d'une suspension est retenu comme origine de
+ * la mesure du délai de réveil ; sans effet lorsque le bus est actif.
+ *
+ * @param event_us Horodatage de l'événement en microsecondes.
+ */
+void host_suspend_note_wake_event(uint32_t event_us);
+
+/**
+ * @brief Indique si la signalisation de réveil doit être émise maintenant.
+ *
+ * Vrai une fois par demande, puis toutes les HOST_WAKEUP_RETRY_MS tant que
+ * l'hôte n'a pas repris.
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+bool host_suspend_wakeup_due(uint32_t now_ms);
+
+/**
+ * @brief Indique qu'un réveil a été signalé et que la reprise est attendue.
+ *
+ * L'interrogation reprend alors son rythme nominal pour détecter la reprise
+ * au plus tôt.
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+bool host_suspend_waking(uint32_t now_ms);
+
+/**
+ * @brief Signale un rapport accepté par un transport.
+ *
+ * Le premier rapport suivant une reprise demandée clôt la mesure du délai
+ * de réveil.
+ *
+ * @param now_us Temps courant en microsecondes.
+ */
+void host_suspend_note_report(uint32_t now_us);
+
+/**
+ * @brief Compteurs de suspension et de réveil.
+ */
+const host_suspend_stats &host_suspend_get_stats();
+
+#endif // HOST_SUSPEND_H
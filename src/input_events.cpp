@@ -0,0 +1,25 @@
+/**
+ * @file input_events.cpp
+ * @brief File des événements d'entrée décodés.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "input_events.h"
+#include "spsc_ring.h"
+
+static SpscRing<input_event, INPUT_EVENT_RING_SIZE> events;
+
+bool input_event_push(const input_event &event) { return events.push(event); }
+
+bool input_event_pop(input_event &event) { return events.pop(event); }
+
+uint32_t input_event_pending() { return events.size(); }
+
+uint32_t input_event_overflows() { return events.overflows(); }
+
+uint32_t input_event_high_water() { return events.highWater(); }
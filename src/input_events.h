@@ -0,0 +1,90 @@
+/**
+ * @file input_events.h
+ * @brief Événements d'entrée décodés, point de passage unique entre le
+ * décodage ADB et la construction des rapports HID.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Le décodage ADB (boucle, tâche ADB ou interruption) dépose des événements
+ * compacts dans une file sans verrou ; les constructeurs de rapports USB et
+ * Bluetooth les consomment à leur propre rythme. Le rythme du transport ne
+ * ralentit donc plus celui du bus.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <cstdint>
+
+#define INPUT_EVENT_RING_SIZE 64 /**< Capacité de la file (puissance de 2). */
+
+/**
+ * @enum input_event_type
+ * @brief Nature d'un événement d'entrée.
+ */
+enum input_event_type : uint8_t {
+  INPUT_EVENT_KEY_DOWN = 0, /**< Touche enfoncée (code = code ADB). */
+  INPUT_EVENT_KEY_UP,       /**< Touche relâchée (code = code ADB). */
+  INPUT_EVENT_KEY_TAP,      /**< Frappe complète d'une touche à bascule. */
+  INPUT_EVENT_MOUSE,        /**< Souris (code = boutons, dx/dy = déplacement). */
+  INPUT_EVENT_LEDS          /**< État des LEDs (code = bits Num/Caps/Scroll). */
+};
+
+/** Bits du champ code d'un événement INPUT_EVENT_LEDS. */
+#define INPUT_LED_NUM 0x01
+#define INPUT_LED_CAPS 0x02
+#define INPUT_LED_SCROLL 0x04
+
+/** Code ADB de la touche Power (trame 0x7F7F / 0xFFFF). */
+#define INPUT_ADB_POWER_CODE 0x7F
+
+/**
+ * @struct input_event
+ * @brief Événement d'entrée compact (8 octets).
+ */
+struct input_event {
+  uint32_t timestamp_us; /**< Horodatage du décodage (micros()). */
+  uint8_t type;          /**< Voir input_event_type. */
+  uint8_t code;          /**< Code de touche, boutons ou LEDs. */
+  int8_t dx;             /**< Déplacement horizontal. */
+  int8_t dy;             /**< Déplacement vertical. */
+};
+
+/**
+ * @brief Dépose un événement (producteur unique : décodage ADB).
+ *
+ * Utilisable depuis une interruption.
+ *
+ * @param event Événement à déposer.
+ * @return true si l'événement a été déposé, false si la file est pleine.
+ */
+bool input_event_push(const input_event &event);
+
+/**
+ * @brief Retire l'événement le plus ancien (consommateur unique : rapports).
+ *
+ * @param event Destination de l'événement.
+ * @return true si un événement a été retiré, false si la file est vide.
+ */
+bool input_event_pop(input_event &event);
+
+/**
+ * @brief Nombre d'événements en attente.
+ */
+uint32_t input_event_pending();
+
+/**
+ * @brief Nombre d'événements perdus faute de place.
+ */
+uint32_t input_event_overflows();
+
+/**
+ * @brief Remplissage maximal observé de la file.
+ */
+uint32_t input_event_high_water();
+
+#endif // INPUT_EVENTS_H
@@ -0,0 +1,111 @@
+/**
+ * @file key_queue.cpp
+ * @brief Implémentation de la file ordonnée des rapports clavier.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "key_queue.h"
+#include "hid_transport.h"
+#include <cstdio>
+#include <cstring>
+
+static uint8_t queue[KEY_QUEUE_SIZE][KEY_QUEUE_REPORT_LEN];
+static uint32_t queue_event_us[KEY_QUEUE_SIZE];
+static uint32_t offered_event_us = 0;
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+// Rapports déjà remis à chaque transport, comptés depuis la tête
+static uint8_t delivered[HID_TRANSPORT_MAX];
+static key_queue_stats stats;
+
+bool key_queue_push(const uint8_t *report, uint32_t event_us) {
+  if (queue_count >= KEY_QUEUE_SIZE) {
+    stats.overflows++;
+    return false;
+  }
+
+  uint8_t slot = (queue_head + queue_count) % KEY_QUEUE_SIZE;
+  memcpy(queue[slot], report, KEY_QUEUE_REPORT_LEN);
+  queue_event_us[slot] = event_us;
+  queue_count++;
+  stats.queued++;
+  if (queue_count > stats.high_water)
+    stats.high_water = queue_count;
+  return true;
+}
+
+uint8_t key_queue_pump() {
+  uint8_t count = hid_transport_count();
+  uint8_t retire = queue_count;
+  bool any_ready = false;
+
+  for (uint8_t t = 0; t < count; t++) {
+    // Un transport indisponible (suspendu, hors connexion) ne retient pas
+    // les autres : il reprendra à la tête de la file
+    const hid_transport *transport = hid_transport_get(t);
+    if (!transport->ready() || (transport->carries != nullptr &&
+                                !transport->carries(HID_REPORT_KEYBOARD)))
+      continue;
+    any_ready = true;
+
+    while (delivered[t] < queue_count) {
+      uint8_t slot = (queue_head + delivered[t]) % KEY_QUEUE_SIZE;
+      const uint8_t *report = queue[slot];
+      offered_event_us = queue_event_us[slot];
+      if (!hid_transport_offer(t, HID_REPORT_KEYBOARD, report,
+                               KEY_QUEUE_REPORT_LEN)) {
+        stats.refused++;
+        break;
+      }
+      delivered[t]++;
+    }
+    if (delivered[t] < retire)
+      retire = delivered[t];
+  }
+
+  // Sans transport prêt, les rapports restent en file jusqu'à la reprise
+  if (!any_ready)
+    return 0;
+
+  queue_head = (queue_head + retire) % KEY_QUEUE_SIZE;
+  queue_count -= retire;
+  for (uint8_t t = 0; t < HID_TRANSPORT_MAX; t++)
+    delivered[t] = delivered[t] > retire ? delivered[t] - retire : 0;
+  for (uint8_t i = 0; i < retire; i++)
+    hid_transport_count_sent(HID_REPORT_KEYBOARD);
+  stats.sent += retire;
+  return retire;
+}
+
+uint32_t key_queue_offered_event_us() { return offered_event_us; }
+
+uint8_t key_queue_pending() { return queue_count; }
+
+uint8_t key_queue_free() { return KEY_QUEUE_SIZE - queue_count; }
+
+const key_queue_stats &key_queue_get_stats() { return stats; }
+
+void key_queue_reset() {
+  queue_head = queue_count = 0;
+  offered_event_us = 0;
+  memset(delivered, 0, sizeof(delivered));
+  stats = key_queue_stats();
+}
+
+size_t key_queue_format(char *buf, size_t len) {
+  if (len == 0)
+    return 0;
+
+  int n = snprintf(buf, len, "KEYQ q=%u max=%lu sent=%lu refus=%lu ovf=%lu",
+                   (unsigned)queue_count, (unsigned long)stats.high_water,
+                   (unsigned long)stats.sent, (unsigned long)stats.refused,
+                   (unsigned long)stats.overflows);
+  if (n < 0)
+    return 0;
+  return (size_t)n < len ? (size_t)n : len - 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file key_queue.h
+ * @brief File ordonnée des rapports clavier, cadencée par l'hôte.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Les lecteurs de codes-barres (Datalogic Heron) et les claviers
+ * alternatifs (IntelliKeys) envoient des rafales de frappes plus rapides
+ * qu'un rapport par interrogation de l'hôte. Chaque état du rapport clavier
+ * est donc mis en file puis proposé à chaque transport dans l'ordre : un
+ * rapport refusé (point d'accès USB occupé, file Bluetooth pleine) sera
+ * représenté à ce transport, si bien que l'appui et le relâchement d'une
+ * même touche partent toujours dans deux rapports distincts, au rythme
+ * maximal accepté par chaque hôte.
+ *
+ * La livraison est suivie par transport : un rapport ne quitte la file
+ * qu'une fois pris par tous les transports prêts. Un transport indisponible
+ * est ignoré et reprend à la tête de la file ; ses rapports sont des états
+ * complets du clavier, aucune touche ne reste donc enfoncée.
+ *
+ * La file n'est utilisée que par le consommateur des événements d'entrée
+ * (hid_reports_service()) ; lorsqu'elle se remplit, celui-ci cesse de
+ * retirer les frappes de la file des événements.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef KEY_QUEUE_H
+#define KEY_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define KEY_QUEUE_SIZE 32       /**< Rapports en attente au plus. */
+#define KEY_QUEUE_REPORT_LEN 8  /**< Rapport clavier (modificateurs, touches). */
+#define KEY_QUEUE_RETRY_US 1000 /**< Période de représentation (une trame USB). */
+
+/**
+ * @struct key_queue_stats
+ * @brief Compteurs de la file.
+ */
+struct key_queue_stats {
+  uint32_t queued = 0;     /**< Rapports mis en file. */
+  uint32_t sent = 0;       /**< Rapports pris par tous les transports prêts. */
+  uint32_t refused = 0;    /**< Propositions refusées, représentées ensuite. */
+  uint32_t overflows = 0;  /**< Rapports perdus, file pleine. */
+  uint32_t high_water = 0; /**< Remplissage maximal observé. */
+};
+
+/**
+ * @brief Met un rapport clavier en file.
+ *
+ * @param report Rapport de KEY_QUEUE_REPORT_LEN octets (copié).
+ * @param event_us Horodatage de l'événement d'entrée à l'origine du rapport.
+ * @return false si la file est pleine (rapport perdu et compté).
+ */
+bool key_queue_push(const uint8_t *report, uint32_t event_us);
+
+/**
+ * @brief Propose les rapports en attente à chaque transport prêt, dans
+ * l'ordre, jusqu'à son premier refus.
+ *
+ * @return Nombre de rapports retirés de la file.
+ */
+uint8_t key_queue_pump();
+
+/**
+ * @brief Horodatage de l'événement à l'origine du rapport proposé en
+ * dernier ; lu par le rappel de fin d'envoi des transports.
+ */
+uint32_t key_queue_offered_event_us();
+
+/** @brief Rapports en attente. */
+uint8_t key_queue_pending();
+
+/** @brief Places libres dans la file. */
+uint8_t key_queue_free();
+
+/** @brief Compteurs de la file. */
+const key_queue_stats &key_queue_get_stats();
+
+/** @brief Vide la file et remet les compteurs à zéro. */
+void key_queue_reset();
+
+/**
+ * @brief Formate les compteurs sur une ligne compacte.
+ *
+ * @return Nombre de caractères écrits (hors zéro terminal).
+ */
+size_t key_queue_format(char *buf, size_t len);
+
+#endif // KEY_QUEUE_H
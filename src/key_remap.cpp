@@ -0,0 +1,60 @@
+/**
+ * @file key_remap.cpp
+ * @brief Implémentation de la table de réaffectation des touches ADB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "key_remap.h"
+#include <atomic>
+#include <cstring>
+
+static uint8_t banks[2][KEY_REMAP_SIZE];
+static std::atomic<uint8_t *> active{nullptr};
+static std::atomic<bool> enabled{false};
+
+/**
+ * @brief Remplit un banc avec l'identité.
+ */
+static void fill_identity(uint8_t *bank) {
+  for (uint16_t i = 0; i < KEY_REMAP_SIZE; i++)
+    bank[i] = (uint8_t)i;
+}
+
+uint8_t key_remap_lookup(uint8_t adb_code) {
+  uint8_t *table = active.load(std::memory_order_acquire);
+  if (!enabled.load(std::memory_order_relaxed) || table == nullptr ||
+      adb_code >= KEY_REMAP_SIZE)
+    return adb_code;
+  return table[adb_code];
+}
+
+uint8_t *key_remap_staging() {
+  uint8_t *table = active.load(std::memory_order_relaxed);
+  if (table == nullptr) {
+    key_remap_reset();
+    table = active.load(std::memory_order_relaxed);
+  }
+  return table == banks[0] ? banks[1] : banks[0];
+}
+
+void key_remap_commit() {
+  uint8_t *staging = key_remap_staging();
+  active.store(staging, std::memory_order_release);
+  memcpy(key_remap_staging(), staging, KEY_REMAP_SIZE);
+}
+
+void key_remap_set_enabled(bool on) { enabled = on; }
+
+bool key_remap_enabled() { return enabled; }
+
+void key_remap_reset() {
+  fill_identity(banks[0]);
+  fill_identity(banks[1]);
+  active.store(banks[0], std::memory_order_release);
+  enabled = false;
+}
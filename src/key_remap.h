@@ -0,0 +1,53 @@
+/**
+ * @file key_remap.h
+ * @brief Table de réaffectation des touches ADB, modifiable à chaud.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Deux bancs de KEY_REMAP_SIZE octets : le banc actif sert aux recherches,
+ * le banc de préparation reçoit directement les téléversements du protocole
+ * de contrôle. La validation bascule les bancs par un simple échange de
+ * pointeur, sans copie ni interruption du décodage.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef KEY_REMAP_H
+#define KEY_REMAP_H
+
+#include <cstdint>
+
+#define KEY_REMAP_SIZE 128 /**< Un octet par code ADB (7 bits). */
+
+/**
+ * @brief Retourne le code ADB réaffecté (identité si la table est inactive).
+ */
+uint8_t key_remap_lookup(uint8_t adb_code);
+
+/**
+ * @brief Banc de préparation, destination des téléversements.
+ */
+uint8_t *key_remap_staging();
+
+/**
+ * @brief Active le banc de préparation.
+ *
+ * Le nouveau banc de préparation repart de la table active, afin qu'un
+ * téléversement partiel s'applique sur la table en service.
+ */
+void key_remap_commit();
+
+/** @brief Active ou désactive la réaffectation. */
+void key_remap_set_enabled(bool enabled);
+
+/** @brief Indique si la réaffectation est active. */
+bool key_remap_enabled();
+
+/**
+ * @brief Remet les deux bancs à l'identité et désactive la réaffectation.
+ */
+void key_remap_reset();
+
+#endif // KEY_REMAP_H
@@ -11,28 +11,39 @@
  * @license GNU GPL v3
  */
 
-#ifndef UNIT_TEST
-
+#if !defined(UNIT_TEST) || defined(ADB_SIM)
+
+#include "adb_joystick.h"
+#include "adb_phy.h"
+#include "adb_sniffer.h"
+#include "adb_stats.h"
+#include "adb_tablet.h"
+#include "board.h"
+#include "ctrl_proto.h"
 #include "hid_keyboard.h"
 #include "hid_mouse.h"
+#include "hid_reports.h"
+#include "hid_transport.h"
+#include "host_suspend.h"
+#include "input_events.h"
+#include "key_queue.h"
+#include "key_remap.h"
+#include "power_manager.h"
+#include "sof_sync.h"
+#include "status_display.h"
+#include "text_console.h"
 #include <ADB.h>
+#include <atomic>
 
-#define POLL_DELAY 5
-// Définition de la pin ADB selon la plateforme
-#ifdef ARDUINO_ARCH_ESP32
-#define ADB_PIN 2
-#endif
-#ifdef ARDUINO_ARCH_STM32
-#define ADB_PIN PB4
-#endif
+// Broches de la carte (board.h). SNIFFER_PIN à la masse au démarrage :
+// l'adaptateur écoute le bus sans jamais y émettre
+#define ADB_PIN board::adb_pin
+#define LED_PIN board::led_pin
+#define SNIFFER_PIN board::sniffer_pin
 
-// Définition de la pin LED selon la plateforme
-#ifdef ARDUINO_ARCH_ESP32
-#define LED_PIN 4 // Pin pour ESP32 (Devkit Wemos)
-#endif
-#ifdef ARDUINO_ARCH_STM32
-#define LED_PIN PC13 // Pin pour STM32
-#endif
+// Événements déposés au plus par une trame clavier (deux touches, chacune
+// suivie de l'état des LEDs)
+#define KEYBOARD_FRAME_EVENTS 4
 
 /**
  * @struct DeviceState
@@ -43,6 +54,10 @@ struct DeviceState {
       false;                     /**< Détection du clavier Apple étendu. */
   bool keyboard_present = false; /**< Présence d'un clavier. */
   bool mouse_present = false;    /**< Présence d'une souris. */
+  bool tablet_present = false;   /**< Présence d'une tablette graphique. */
+  const adb_tablet_format *tablet_format =
+      nullptr; /**< Format de la tablette détectée. */
+  bool joystick_present = false; /**< Manette à l'adresse de la souris. */
   bool led_num = true;     /**< État de la LED Num Lock (actif par défaut). */
   bool led_caps = false;   /**< État de la LED Caps Lock. */
   bool led_scroll = false; /**< État de la LED Scroll Lock. */
@@ -50,16 +65,36 @@ struct DeviceState {
 };
 
 // Instances globales
-ADB adb(ADB_PIN);               /**< Instance du bus ADB. */
-ADBDevices adbDevices(adb);     /**< Gestionnaire des périphériques ADB. */
+TextConsole Console;            /**< Traces texte (voir text_console.h). */
 DeviceState deviceState;        /**< État des périphériques. */
 bool caps_lock_pressed = false; /**< État de la touche Caps Lock. */
+std::atomic<bool> ledsUpdatePending{
+    false}; /**< LEDs clavier à réécrire par la tâche ADB. */
+bool snifferMode = false; /**< Analyseur passif choisi au démarrage. */
+std::atomic<uint32_t> pollCycles{0}; /**< Cycles d'interrogation complets. */
+uint32_t joystickPolledUs = 0; /**< Début de la dernière lecture manette. */
+uint32_t joystickTalkUs = 0;   /**< Durée de la dernière lecture manette. */
+std::atomic<uint32_t> keyboardDeferred{
+    0}; /**< Lectures clavier reportées, file des événements pleine. */
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <BLEDevice.h>
 #include <BLEHIDDevice.h>
 #include <HIDKeyboardTypes.h>
 #include <HIDTypes.h>
+#include "ble_bond.h"
+#include "ble_link.h"
+#include <new>
+
+// Répartition des tâches : la pile Bluetooth (contrôleur et Bluedroid) tourne
+// sur le cœur 0, l'interrogation ADB est isolée sur le cœur 1.
+#define BLE_TASK_CORE 0
+#define ADB_TASK_CORE 1
+#define ADB_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+
+// Piles des tâches en octets, allouées statiquement (voir "PILE" via `s`)
+#define BLE_TASK_STACK_SIZE 8192
+#define ADB_TASK_STACK_SIZE 4096
 
 // Déclaration de la structure InputReport
 struct InputReport {
@@ -136,7 +171,155 @@ static const uint8_t REPORT_MAP[] = {
     REPORT_SIZE(1),
     0x03,
     HIDOUTPUT(1),
-    0x01,             //   Const, Array, Abs
+    0x01,              //   Const, Array, Abs
+    END_COLLECTION(0), // End application collection
+
+    USAGE_PAGE(1),
+    0x0C, // Consumer
+    USAGE(1),
+    0x01, // Consumer Control
+    COLLECTION(1),
+    0x01, // Application
+    REPORT_ID(1),
+    0x03, //   Report ID (3)
+    LOGICAL_MINIMUM(1),
+    0x00,
+    LOGICAL_MAXIMUM(2),
+    0xFF,
+    0x03, //   0x03FF
+    USAGE_MINIMUM(1),
+    0x00,
+    USAGE_MAXIMUM(2),
+    0xFF,
+    0x03,
+    REPORT_COUNT(1),
+    0x01, //   1 usage
+    REPORT_SIZE(1),
+    0x10, //   16 bits
+    HIDINPUT(1),
+    0x00,              //   Data, Array, Abs
+    END_COLLECTION(0), // End application collection
+
+    USAGE_PAGE(1),
+    0x0D, // Digitizers
+    USAGE(1),
+    0x02, // Pen
+    COLLECTION(1),
+    0x01, // Application
+    REPORT_ID(1),
+    0x04, //   Report ID (4)
+    USAGE(1),
+    0x20, //   Stylus
+    COLLECTION(1),
+    0x00, //   Physical
+    USAGE(1),
+    0x42, //     Tip Switch
+    USAGE(1),
+    0x44, //     Barrel Switch
+    USAGE(1),
+    0x5A, //     Secondary Barrel Switch
+    USAGE(1),
+    0x32, //     In Range
+    LOGICAL_MINIMUM(1),
+    0x00,
+    LOGICAL_MAXIMUM(1),
+    0x01,
+    REPORT_SIZE(1),
+    0x01,
+    REPORT_COUNT(1),
+    0x04,
+    HIDINPUT(1),
+    0x02, //     Data, Var, Abs
+    REPORT_COUNT(1),
+    0x04, //     4 bits (Padding)
+    HIDINPUT(1),
+    0x03, //     Const, Var, Abs
+    USAGE_PAGE(1),
+    0x01, //     Generic Desktop
+    USAGE(1),
+    0x30, //     X
+    USAGE(1),
+    0x31, //     Y
+    LOGICAL_MAXIMUM(2),
+    0xFF,
+    0x7F, //     ADB_TABLET_LOGICAL_MAX
+    PHYSICAL_MINIMUM(1),
+    0x00,
+    PHYSICAL_MAXIMUM(2),
+    0x20,
+    0x03, //     8,00 pouces
+    UNIT_EXPONENT(1),
+    0x0E, //     10^-2
+    UNIT(1),
+    0x13, //     Pouce
+    REPORT_SIZE(1),
+    0x10,
+    REPORT_COUNT(1),
+    0x02,
+    HIDINPUT(1),
+    0x02, //     Data, Var, Abs
+    USAGE_PAGE(1),
+    0x0D, //     Digitizers
+    USAGE(1),
+    0x30, //     Tip Pressure
+    LOGICAL_MAXIMUM(2),
+    0xFF,
+    0x03, //     ADB_TABLET_PRESSURE_MAX
+    PHYSICAL_MAXIMUM(1),
+    0x00,
+    UNIT(1),
+    0x00,
+    REPORT_COUNT(1),
+    0x01,
+    HIDINPUT(1),
+    0x02,              //     Data, Var, Abs
+    END_COLLECTION(0), //   End physical collection
+    END_COLLECTION(0), // End application collection
+
+    USAGE_PAGE(1),
+    0x01, // Generic Desktop
+    USAGE(1),
+    0x04, // Joystick
+    COLLECTION(1),
+    0x01, // Application
+    REPORT_ID(1),
+    0x05, //   Report ID (5)
+    USAGE_PAGE(1),
+    0x09, //   Button
+    USAGE_MINIMUM(1),
+    0x01,
+    USAGE_MAXIMUM(1),
+    0x08, //   ADB_JOYSTICK_BUTTONS
+    LOGICAL_MINIMUM(1),
+    0x00,
+    LOGICAL_MAXIMUM(1),
+    0x01,
+    REPORT_SIZE(1),
+    0x01,
+    REPORT_COUNT(1),
+    0x08,
+    HIDINPUT(1),
+    0x02, //   Data, Var, Abs
+    USAGE_PAGE(1),
+    0x01, //   Generic Desktop
+    USAGE(1),
+    0x30, //   X
+    USAGE(1),
+    0x31, //   Y
+    USAGE(1),
+    0x32, //   Z (manette des gaz)
+    LOGICAL_MINIMUM(2),
+    0x01,
+    0x80, //   -ADB_JOYSTICK_AXIS_MAX
+    LOGICAL_MAXIMUM(2),
+    0xFF,
+    0x7F, //   ADB_JOYSTICK_AXIS_MAX
+    REPORT_SIZE(1),
+    0x10,
+    REPORT_COUNT(1),
+    0x03,
+    HIDINPUT(1),
+    0x02,             //   Data, Var, Abs
     END_COLLECTION(0) // End application collection
 };
 
@@ -144,14 +327,22 @@ static const uint8_t REPORT_MAP[] = {
 BLEHIDDevice *hid;
 BLECharacteristic *input_keyboard;
 BLECharacteristic *input_mouse;
+BLECharacteristic *input_consumer;
+BLECharacteristic *input_tablet;
+BLECharacteristic *input_joystick;
 BLECharacteristic *output_keyboard;
 bool isBleConnected = false;
+TaskHandle_t bluetoothTaskHandle = NULL;
+BLEServer *bleServer = NULL;
+esp_bd_addr_t bleRemoteAddress; /**< Adresse du central connecté. */
 
 const InputReport NO_KEY_PRESSED = {};
 
 // Callbacks pour la connexion BLE
 class BleHIDCallbacks : public BLEServerCallbacks {
-  void onConnect(BLEServer *server) {
+  void onConnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) {
+    memcpy(bleRemoteAddress, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+    ble_link_on_connect(millis());
     isBleConnected = true;
 
     BLE2902 *cccDescKeyboard = (BLE2902 *)input_keyboard->getDescriptorByUUID(
@@ -162,11 +353,14 @@ class BleHIDCallbacks : public BLEServerCallbacks {
         (BLE2902 *)input_mouse->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
     cccDescMouse->setNotifications(true);
 
-    Serial.println("Client connecté au clavier et souris HID Bluetooth.");
+    Console.println("Client connecté au clavier et souris HID Bluetooth.");
+    hid_transport_notify_ready(&hid_transport_ble);
   }
 
   void onDisconnect(BLEServer *server) {
     isBleConnected = false;
+    ble_link_on_disconnect();
+    ble_bond_on_disconnect();
 
     BLE2902 *cccDescKeyboard = (BLE2902 *)input_keyboard->getDescriptorByUUID(
         BLEUUID((uint16_t)0x2902));
@@ -176,58 +370,112 @@ class BleHIDCallbacks : public BLEServerCallbacks {
         (BLE2902 *)input_mouse->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
     cccDescMouse->setNotifications(false);
 
-    Serial.println("Client déconnecté du clavier et souris HID Bluetooth.");
+    Console.println("Client déconnecté du clavier et souris HID Bluetooth.");
+  }
+
+  void onMtuChanged(BLEServer *server, esp_ble_gatts_cb_param_t *param) {
+    ble_link_on_mtu(param->mtu.mtu);
   }
 };
 
+// Callbacks de sécurité : mémorisation de l'hôte lié
+class BleSecurityCallbacks : public BLESecurityCallbacks {
+  uint32_t onPassKeyRequest() { return 0; }
+  void onPassKeyNotify(uint32_t pass_key) {}
+  bool onSecurityRequest() { return true; }
+  bool onConfirmPIN(uint32_t pass_key) { return true; }
+
+  void onAuthenticationComplete(esp_ble_auth_cmpl_t cmpl) {
+    if (!cmpl.success) {
+      Console.print("Échec de l'authentification BLE : ");
+      Console.println(cmpl.fail_reason, HEX);
+      return;
+    }
+    ble_bond_remember(cmpl.bd_addr, cmpl.addr_type);
+    ble_link_on_secured();
+  }
+};
+
+/**
+ * @brief Suit les paramètres de connexion appliqués par le central.
+ */
+void bleGapHandler(esp_gap_ble_cb_event_t event,
+                   esp_ble_gap_cb_param_t *param) {
+  if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT &&
+      param->update_conn_params.status == ESP_BT_STATUS_SUCCESS)
+    ble_link_on_conn_params(param->update_conn_params.conn_int,
+                            param->update_conn_params.latency);
+}
+
+/**
+ * @brief Demande de nouveaux paramètres de connexion au central.
+ */
+void bleRequestConnParams(const ble_conn_params &params) {
+  bleServer->updateConnParams(bleRemoteAddress, params.min_interval,
+                              params.max_interval, params.latency,
+                              params.timeout);
+}
+
 // Callbacks pour les LEDs (Num Lock, Caps Lock, etc.)
 class OutputCallbacks : public BLECharacteristicCallbacks {
   void onWrite(BLECharacteristic *characteristic) {
     uint8_t *data = characteristic->getData();
-    Serial.print("LED state (Bluetooth): ");
-    Serial.println(*data, HEX);
+    Console.print("LED state (Bluetooth): ");
+    Console.println(*data, HEX);
 
     // Synchronisation des états des LEDs
     //deviceState.led_num = (*data & 0x01) != 0;  // Num Lock
     //deviceState.led_caps = (*data & 0x02) != 0; // Caps Lock
 
-    // Suppression de la réactivation automatique de Caps Lock
-    adbDevices.keyboardWriteLEDs(deviceState.led_num, deviceState.led_caps,
-                                 deviceState.led_scroll);
-
-    Serial.print("bluetooth LED Num Lock : ");
-    Serial.println(deviceState.led_num ? "Allumée" : "Éteinte");
-    Serial.print("bluetooth LED Caps Lock : ");
-    Serial.println(deviceState.led_caps ? "Allumée" : "Éteinte");
+    // Suppression de la réactivation automatique de Caps Lock.
+    // L'écriture ADB et l'écho de l'état vers l'hôte sont confiés à la tâche
+    // ADB : aucune transaction sur le bus depuis le cœur Bluetooth.
+    ledsUpdatePending = true;
 
-#ifdef ARDUINO_ARCH_ESP32
-    if (isBleConnected) {
-      uint8_t buf[1] = {static_cast<uint8_t>((deviceState.led_caps << 1) |
-                                             deviceState.led_num)};
-      output_keyboard->setValue(buf, sizeof(buf));
-      output_keyboard->notify();
-    }
-#endif
+    Console.print("bluetooth LED Num Lock : ");
+    Console.println(deviceState.led_num ? "Allumée" : "Éteinte");
+    Console.print("bluetooth LED Caps Lock : ");
+    Console.println(deviceState.led_caps ? "Allumée" : "Éteinte");
   }
 };
 
+// Objets Bluetooth à durée de vie illimitée : stockage statique, aucun tas.
+// BLEHIDDevice exige le serveur à la construction : placement dans un tampon.
+static BleHIDCallbacks bleServerCallbacks;
+static BleSecurityCallbacks bleSecurityCallbacks;
+static OutputCallbacks bleOutputCallbacks;
+static BLESecurity bleSecurity;
+alignas(BLEHIDDevice) static uint8_t bleHidStorage[sizeof(BLEHIDDevice)];
+
+static StackType_t bluetoothTaskStack[BLE_TASK_STACK_SIZE];
+static StaticTask_t bluetoothTaskBuffer;
+static StackType_t adbTaskStack[ADB_TASK_STACK_SIZE];
+static StaticTask_t adbTaskBuffer;
+TaskHandle_t adbTaskHandle = NULL;
+
 void bluetoothTask(void *) {
   BLEDevice::init("Apple ADB Ressurector");
+  BLEDevice::setCustomGapHandler(bleGapHandler);
+  BLEDevice::setSecurityCallbacks(&bleSecurityCallbacks);
   BLEServer *server = BLEDevice::createServer();
-  server->setCallbacks(new BleHIDCallbacks());
+  bleServer = server;
+  server->setCallbacks(&bleServerCallbacks);
+  ble_link_set_hooks(hid_transport_ble_notify, bleRequestConnParams);
 
-  hid = new BLEHIDDevice(server);
+  hid = new (bleHidStorage) BLEHIDDevice(server);
   input_keyboard = hid->inputReport(1);   // Report ID 1 pour le clavier
   input_mouse = hid->inputReport(2);      // Report ID 2 pour la souris
+  input_consumer = hid->inputReport(3);   // Report ID 3 pour Consumer Control
+  input_tablet = hid->inputReport(4);     // Report ID 4 pour la tablette
+  input_joystick = hid->inputReport(5);   // Report ID 5 pour la manette
   output_keyboard = hid->outputReport(1); // Report ID 1 pour les LEDs clavier
-  output_keyboard->setCallbacks(new OutputCallbacks());
+  output_keyboard->setCallbacks(&bleOutputCallbacks);
 
   hid->manufacturer()->setValue("Maker Community");
   hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
   hid->hidInfo(0x00, 0x02);
 
-  BLESecurity *security = new BLESecurity();
-  security->setAuthenticationMode(ESP_LE_AUTH_BOND);
+  bleSecurity.setAuthenticationMode(ESP_LE_AUTH_BOND);
 
   // Rapport HID pour clavier et souris
   hid->reportMap((uint8_t *)REPORT_MAP, sizeof(REPORT_MAP));
@@ -236,32 +484,381 @@ void bluetoothTask(void *) {
   BLEAdvertising *advertising = server->getAdvertising();
   advertising->setAppearance(HID_KEYBOARD);
   advertising->addServiceUUID(hid->hidService()->getUUID());
-  advertising->start();
 
-  Serial.println("Bluetooth HID prêt.");
-  delay(portMAX_DELAY);
+  // Annonce dirigée vers le dernier hôte lié, puis annonce classique
+  ble_bond_begin(advertising);
+  ble_bond_start_advertising(millis());
+
+  Console.println(ble_bond_has_peer()
+                     ? "Bluetooth HID prêt, reconnexion à l'hôte lié."
+                     : "Bluetooth HID prêt.");
+
+  // Construction des rapports à partir des événements décodés par la
+  // tâche ADB, puis envoi groupé par événement de connexion
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1));
+    uint32_t now = millis();
+    hid_reports_service(now);
+    ble_link_service(now);
+    ble_bond_service(now);
+  }
 }
 
 void setupBluetoothTask() {
-  xTaskCreate(bluetoothTask, "bluetooth", 20000, NULL, 5, NULL);
+  bluetoothTaskHandle = xTaskCreateStaticPinnedToCore(
+      bluetoothTask, "bluetooth", BLE_TASK_STACK_SIZE, NULL, 5,
+      bluetoothTaskStack, &bluetoothTaskBuffer, BLE_TASK_CORE);
 }
 
+void adbTask(void *);
+
 #endif
 
+/**
+ * @brief Exécute une transaction ADB en appliquant la politique de relance.
+ *
+ * Chaque tentative, classée par la couche physique (timeout, timing de bit,
+ * collision), est comptabilisée. Les erreurs transitoires sont relancées
+ * immédiatement tant que le budget d'interrogation le permet ; les erreurs
+ * persistantes font sauter les cycles suivants (recul exponentiel).
+ *
+ * @param device Périphérique concerné (voir adb_stats_device).
+ * @param transaction Fonction effectuant la transaction et retournant son
+ * résultat (adb_result).
+ * @return true si une trame valide a été reçue, false sinon.
+ */
+template <typename Transaction>
+bool pollDevice(uint8_t device, Transaction transaction) {
+  if (!adb_stats_should_poll(device))
+    return false;
+
+  uint32_t poll_start = micros();
+  for (uint8_t attempt = 0;; attempt++) {
+    adb_result result = transaction();
+    adb_stats_record(device, result);
+
+    if (result == ADB_RESULT_OK)
+      return true;
+    if (!adb_stats_should_retry(device, result, attempt, micros() - poll_start))
+      return false;
+  }
+}
+
+/**
+ * @brief Lit un registre de longueur quelconque (commande Talk).
+ */
+adb_result talkRegister(uint8_t addr, uint8_t reg, uint8_t *buf,
+                        uint8_t max_len, uint8_t *len) {
+  return adb_phy_talk(ADB_PHY_TALK(addr, reg), buf, max_len, len);
+}
+
+/**
+ * @brief Lit un registre de 16 bits dans l'ordre des structures de la
+ * bibliothèque ADB (premier octet reçu en poids fort).
+ */
+adb_result talkRegister16(uint8_t addr, uint8_t reg, uint16_t *raw) {
+  uint8_t buf[2];
+  uint8_t len = 0;
+  adb_result result = talkRegister(addr, reg, buf, sizeof(buf), &len);
+  *raw = result == ADB_RESULT_OK ? (uint16_t)(buf[0] << 8 | buf[1]) : 0;
+  return result;
+}
+
 /**
  * @brief Initialise un périphérique ADB.
  *
+ * Le registre 3 est relu, son identifiant de gestionnaire (octet de poids
+ * faible) remplacé puis vérifié par une seconde lecture.
+ *
  * @param addr Adresse du périphérique.
  * @param handler_id Identifiant du gestionnaire de périphérique.
+ * @param device Périphérique suivi par les statistiques.
  * @return true si l'initialisation a réussi, false sinon.
  */
-bool initializeDevice(uint8_t addr, uint8_t handler_id) {
-  bool error = false;
-  adb_data<adb_register3> reg3 = {0}, mask = {0};
-  reg3.data.device_handler_id = handler_id;
-  mask.data.device_handler_id = 0xFF;
-  return adbDevices.deviceUpdateRegister3(addr, reg3, mask.raw, &error) &&
-         !error;
+bool initializeDevice(uint8_t addr, uint8_t handler_id, uint8_t device) {
+  uint8_t reg3[2];
+  uint8_t len = 0;
+  bool updated = false;
+  bool ok = pollDevice(device, [&]() {
+    adb_result result = talkRegister(addr, 3, reg3, sizeof(reg3), &len);
+    if (result != ADB_RESULT_OK)
+      return result;
+    reg3[1] = handler_id;
+    adb_phy_listen(ADB_PHY_LISTEN(addr, 3), reg3, sizeof(reg3));
+
+    result = talkRegister(addr, 3, reg3, sizeof(reg3), &len);
+    updated = result == ADB_RESULT_OK && reg3[1] == handler_id;
+    return result;
+  });
+  return ok && updated;
+}
+
+/**
+ * @brief Écrit l'état des LEDs dans le registre 2 du clavier.
+ *
+ * Les bits 0 (Num Lock), 1 (Caps Lock) et 2 (Scroll Lock) de l'octet de
+ * poids faible sont actifs à l'état bas ; les autres bits sont conservés.
+ */
+void writeKeyboardLeds() {
+  uint8_t reg2[2];
+  uint8_t len = 0;
+  if (talkRegister(ADBKey::Address::KEYBOARD, 2, reg2, sizeof(reg2), &len) !=
+      ADB_RESULT_OK)
+    return;
+
+  reg2[1] = (reg2[1] & ~0x07) | (deviceState.led_num ? 0 : 0x01) |
+            (deviceState.led_caps ? 0 : 0x02) |
+            (deviceState.led_scroll ? 0 : 0x04);
+  adb_phy_listen(ADB_PHY_LISTEN(ADBKey::Address::KEYBOARD, 2), reg2,
+                 sizeof(reg2));
+}
+
+/**
+ * @brief Sonde les demandes de service (SRQ) sans interroger de périphérique.
+ *
+ * Un périphérique non adressé qui a des données prolonge le bit de stop de
+ * la commande.
+ *
+ * @return true si un périphérique demande à être interrogé.
+ */
+bool probeServiceRequest() {
+  return adb_phy_command(ADB_PHY_TALK(ADB_PHY_SRQ_PROBE_ADDRESS, 0));
+}
+
+/**
+ * @brief Détecte une tablette graphique par son identifiant de gestionnaire.
+ *
+ * Sans transport pour le rapport numériseur (composite USB STM32), la
+ * tablette n'est ni détectée ni interrogée : ses échantillons seraient tous
+ * perdus.
+ *
+ * @return true si un pointeur absolu répond à son adresse.
+ */
+bool detectTablet() {
+  if (!hid_transport_carries(HID_REPORT_TABLET)) {
+    Console.println(
+        "Tablettes non prises en charge : aucun transport HID ne les porte.");
+    return false;
+  }
+
+  uint8_t reg3[2];
+  uint8_t len = 0;
+  bool ok = pollDevice(ADB_STATS_TABLET, [&]() {
+    return talkRegister(ADB_TABLET_ADDRESS, 3, reg3, sizeof(reg3), &len);
+  });
+  if (!ok)
+    return false;
+
+  // Octet de poids faible du registre 3 : identifiant de gestionnaire
+  deviceState.tablet_format = adb_tablet_format_for(reg3[1]);
+  Console.print("Tablette : ");
+  Console.print(deviceState.tablet_format->name);
+  Console.print(" (gestionnaire 0x");
+  Console.print(reg3[1], HEX);
+  Console.println(")");
+  return true;
+}
+
+/**
+ * @brief Détecte une manette par l'identifiant de gestionnaire de l'adresse
+ * de la souris.
+ *
+ * À appeler avant initializeDevice() de la souris, qui imposerait le
+ * gestionnaire souris. La lecture compte pour la souris : c'est elle qui
+ * répond à cette adresse le plus souvent.
+ *
+ * Le périphérique reste une souris (la MouseStick fonctionne alors comme
+ * une souris à un bouton) si aucun transport ne porte le rapport manette
+ * (composite USB STM32) ou si son identifiant n'a pas été confirmé sur
+ * matériel.
+ *
+ * @return true si le périphérique de l'adresse 3 est une manette connue.
+ */
+bool detectJoystick() {
+  if (!hid_transport_carries(HID_REPORT_JOYSTICK)) {
+    Console.println("Manettes non prises en charge : aucun transport HID ne les porte.");
+    return false;
+  }
+
+  uint8_t reg3[2];
+  uint8_t len = 0;
+  bool ok = pollDevice(ADB_STATS_MOUSE, [&]() {
+    return talkRegister(ADB_JOYSTICK_ADDRESS, 3, reg3, sizeof(reg3), &len);
+  });
+  if (!ok)
+    return false;
+
+  const adb_joystick_format *format = adb_joystick_format_for(reg3[1]);
+  if (format == nullptr)
+    return false;
+#ifndef ADB_JOYSTICK_TRY_UNCONFIRMED
+  if (!format->confirmed) {
+    Console.print("Manette : gestionnaire 0x");
+    Console.print(reg3[1], HEX);
+    Console.println(" non confirmé, traitée en souris.");
+    return false;
+  }
+#endif
+
+  adb_joystick_begin(format);
+  Console.print("Manette : ");
+  Console.print(format->name);
+  Console.print(" (gestionnaire 0x");
+  Console.print(reg3[1], HEX);
+  Console.println(")");
+  return true;
+}
+
+/**
+ * @brief Émission des trames du protocole de contrôle sur le port série.
+ */
+size_t ctrlWrite(const uint8_t *data, size_t len) {
+  return Serial.write(data, len);
+}
+
+/**
+ * @brief Place disponible dans le tampon d'émission du port série.
+ */
+size_t ctrlRoom() { return Serial.availableForWrite(); }
+
+/**
+ * @brief Traite les commandes reçues sur le port série.
+ *
+ * Les trames binaires sont confiées au protocole de contrôle (voir
+ * ctrl_proto.h) ; la lecture s'interrompt tant qu'une réponse attend de la
+ * place en émission, et au plus CTRL_SERVICE_BUDGET octets sont traités par
+ * appel pour ne pas retarder le polling. Hors trame :
+ *
+ * - `s` : affiche les compteurs du bus ADB sur une ligne, puis ceux de la
+ *   file d'événements, le temps passé dans chaque palier d'énergie, les
+ *   suspensions de l'hôte et le calage sur les SOF USB (délai rapport →
+ *   jeton IN, histogramme par 250 µs).
+ * - `r` : remet les compteurs à zéro.
+ */
+void handleSerialCommands() {
+  ctrl_proto_service();
+  uint16_t budget = CTRL_SERVICE_BUDGET;
+  while (!ctrl_proto_busy() && budget-- > 0 && Serial.available() > 0) {
+    int command = Serial.read();
+    if (ctrl_proto_feed(command))
+      continue;
+    if (command == 's') {
+      char line[224];
+      adb_stats_format(line, sizeof(line));
+      Console.println(line);
+      Console.print("EVT q=");
+      Console.print(input_event_pending());
+      Console.print(" max=");
+      Console.print(input_event_high_water());
+      Console.print(" ovf=");
+      Console.println(input_event_overflows());
+      key_queue_format(line, sizeof(line));
+      Console.print(line);
+      Console.print(" report=");
+      Console.println(keyboardDeferred.load());
+      if (deviceState.tablet_present) {
+        Console.print("TAB coal=");
+        Console.print(adb_tablet_coalesced());
+        Console.print(" ovf=");
+        Console.println(adb_tablet_overflows());
+      }
+      if (deviceState.joystick_present) {
+        Console.print("JOY coal=");
+        Console.print(adb_joystick_coalesced());
+        Console.print(" ovf=");
+        Console.print(adb_joystick_overflows());
+        Console.print(" lect=");
+        Console.println(joystickTalkUs);
+      }
+      uint32_t now = millis();
+      Console.print("PWR st=");
+      Console.print(power_get_state());
+      Console.print(" act=");
+      Console.print(power_time_in_state_ms(POWER_ACTIVE, now));
+      Console.print(" idle=");
+      Console.print(power_time_in_state_ms(POWER_IDLE, now));
+      Console.print(" sleep=");
+      Console.print(power_time_in_state_ms(POWER_SLEEP, now));
+      Console.print(" susp=");
+      Console.print(power_time_in_state_ms(POWER_SUSPEND, now));
+      // Part mesurée du temps en attente, et ce que fait le cœur pendant ce
+      // temps
+      uint16_t waiting = power_wait_permille(now);
+      Console.print(" wait=");
+      Console.print(waiting / 10);
+      Console.print('.');
+      Console.print(waiting % 10);
+      Console.print("% mode=");
+      Console.println(power_sleep_mode());
+      // Délais de réveil en µs, de la frappe au premier rapport accepté
+      const host_suspend_stats &host = host_suspend_get_stats();
+      Console.print("HOST susp=");
+      Console.print(host.suspends);
+      Console.print(" wake=");
+      Console.print(host.wakeups);
+      Console.print(" lat=");
+      Console.print(host.wake_last_us);
+      Console.print(" max=");
+      Console.println(host.wake_max_us);
+#ifndef ARDUINO_ARCH_ESP32
+      sof_sync_format(line, sizeof(line));
+      Console.println(line);
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+      ble_link_format(line, sizeof(line));
+      Console.println(line);
+      // Marge minimale de pile observée, en octets
+      Console.print("PILE ble=");
+      Console.print(uxTaskGetStackHighWaterMark(bluetoothTaskHandle));
+      Console.print(" adb=");
+      Console.println(uxTaskGetStackHighWaterMark(adbTaskHandle));
+#endif
+    } else if (command == 'r') {
+      adb_stats_reset();
+      Console.println("ADB stats reset");
+    }
+  }
+}
+
+/**
+ * @brief Appelée lorsqu'un transport HID devient prêt.
+ *
+ * L'état des LEDs est renvoyé à l'hôte par la tâche ADB, seule productrice
+ * d'événements.
+ */
+void onTransportReady(const hid_transport *transport, uint8_t) {
+  Console.print("Transport HID prêt : ");
+  Console.println(transport->name);
+  ledsUpdatePending = true;
+}
+
+/**
+ * @brief Appelée après chaque rapport accepté par un transport.
+ */
+void onReportSent(const hid_transport *, uint8_t kind) {
+  uint32_t now = static_cast<uint32_t>(micros());
+  host_suspend_note_report(now);
+  if (kind == HID_REPORT_KEYBOARD)
+    sof_sync_note_report(key_queue_offered_event_us());
+}
+
+/**
+ * @brief Passe en mode analyseur passif du bus ADB.
+ *
+ * Ni HID ni Bluetooth : le port série ne transporte plus que le flux
+ * binaire des enregistrements (voir adb_sniffer.h).
+ */
+void startSniffer() {
+  Console.print("Mode analyseur ADB : flux binaire à ");
+  Console.print(ADB_SNIFF_BAUD);
+  Console.println(" bauds.");
+  Serial.flush();
+  Serial.end();
+  Serial.begin(ADB_SNIFF_BAUD);
+
+  adb_sniffer_begin(ADB_PIN);
+  snifferMode = true;
+  digitalWrite(LED_PIN, HIGH);
 }
 
 /**
@@ -272,7 +869,19 @@ void setup() {
   digitalWrite(LED_PIN, LOW); // État initial de la LED
 
   Serial.begin(115200);
-  Serial.println("Initialisation du programme...");
+  Console.println("Initialisation du programme...");
+  ctrl_proto_init(ctrlWrite, ctrlRoom);
+
+  pinMode(SNIFFER_PIN, INPUT_PULLUP);
+  if (digitalRead(SNIFFER_PIN) == LOW) {
+    startSniffer();
+    return;
+  }
+
+  board_traits<board>::register_transports();
+  hid_transport_set_callbacks(onTransportReady, onReportSent);
+  host_suspend_reset();
+  sof_sync_reset();
 
 #ifdef ARDUINO_ARCH_ESP32
   setupBluetoothTask(); // Lancer la tâche Bluetooth
@@ -280,164 +889,496 @@ void setup() {
 
   hid_keyboard_init();
   hid_mouse_init();
-  Serial.println("HID  initialisé.");
+  sof_sync_begin();
+  Console.println("HID  initialisé.");
+
+  if (status_display_begin(board::display))
+    Console.println("Écran d'état initialisé.");
 
-  adb.init(ADB_PIN, true);
-  Serial.println("Bus ADB initialisé.");
+  adb_phy_init(ADB_PIN);
+  adb_phy_reset();
+  Console.println("Bus ADB initialisé.");
 
   delay(1000);
 
   deviceState.keyboard_present =
-      initializeDevice(ADBKey::Address::KEYBOARD, 0x03);
-  Serial.print("Clavier détecté : ");
-  Serial.println(deviceState.keyboard_present ? "Oui" : "Non");
+      initializeDevice(ADBKey::Address::KEYBOARD, 0x03, ADB_STATS_KEYBOARD);
+  Console.print("Clavier détecté : ");
+  Console.println(deviceState.keyboard_present ? "Oui" : "Non");
+
+  // Une manette occupe l'adresse de la souris avec son propre gestionnaire
+  deviceState.joystick_present = detectJoystick();
+  Console.print("Manette détectée : ");
+  Console.println(deviceState.joystick_present ? "Oui" : "Non");
 
-  deviceState.mouse_present = initializeDevice(ADBKey::Address::MOUSE, 0x02);
-  Serial.print("Souris détectée : ");
-  Serial.println(deviceState.mouse_present ? "Oui" : "Non");
+  deviceState.mouse_present =
+      !deviceState.joystick_present &&
+      initializeDevice(ADBKey::Address::MOUSE, 0x02, ADB_STATS_MOUSE);
+  Console.print("Souris détectée : ");
+  Console.println(deviceState.mouse_present ? "Oui" : "Non");
+
+  deviceState.tablet_present = detectTablet();
+  Console.print("Tablette détectée : ");
+  Console.println(deviceState.tablet_present ? "Oui" : "Non");
 
   digitalWrite(LED_PIN, HIGH); // Allumer la LED après l'initialisation
+  power_init(millis());
+
+  writeKeyboardLeds();
+  Console.println("LEDs initialisées.");
 
-  adbDevices.keyboardWriteLEDs(deviceState.led_num, deviceState.led_caps,
-                               deviceState.led_scroll);
-  Serial.println("LEDs initialisées.");
+#ifdef ARDUINO_ARCH_ESP32
+  // Le bus ADB n'est plus utilisé que depuis cette tâche
+  adbTaskHandle = xTaskCreateStaticPinnedToCore(
+      adbTask, "adb", ADB_TASK_STACK_SIZE, NULL, ADB_TASK_PRIORITY,
+      adbTaskStack, &adbTaskBuffer, ADB_TASK_CORE);
+#endif
 }
 
 /**
- * @brief Gère les événements du clavier.
+ * @brief Réveille le consommateur des événements d'entrée.
+ */
+void wakeReportConsumer() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (bluetoothTaskHandle != NULL)
+    xTaskNotifyGive(bluetoothTaskHandle);
+#endif
+}
+
+/**
+ * @brief Dépose un événement d'entrée horodaté.
+ */
+void pushInputEvent(uint8_t type, uint8_t code, int8_t dx = 0, int8_t dy = 0) {
+  input_event event = {static_cast<uint32_t>(micros()), type, code, dx, dy};
+  input_event_push(event);
+}
+
+/**
+ * @brief Dépose l'état courant des LEDs dans la file d'événements.
  */
-void handleKeyboard() {
-  static hid_key_report key_report = {0};
-  bool error = false;
+void pushLedState() {
+  pushInputEvent(INPUT_EVENT_LEDS,
+                 (deviceState.led_num ? INPUT_LED_NUM : 0) |
+                     (deviceState.led_caps ? INPUT_LED_CAPS : 0) |
+                     (deviceState.led_scroll ? INPUT_LED_SCROLL : 0));
+}
 
-  auto key_press = adbDevices.keyboardReadKeyPress(&error);
-  if (error) {
+/**
+ * @brief Décode une transition de touche ADB en événement d'entrée.
+ *
+ * @param keycode Code ADB de la touche.
+ * @param released Indique si la touche est relâchée.
+ */
+void decodeKey(uint8_t keycode, bool released) {
+  // Octet inutilisé d'une trame ne portant qu'une seule touche
+  if (keycode == 0x7F && released)
     return;
-  }
 
-  bool report_changed =
-      hid_keyboard_set_keys_from_adb_register(&key_report, key_press);
-
-  // Gestion de Caps Lock
-  if (key_press.data.key0 == ADBKey::KeyCode::CAPS_LOCK ||
-      key_press.data.key1 == ADBKey::KeyCode::CAPS_LOCK) {
-    bool is_pressed = (key_press.data.key0 == ADBKey::KeyCode::CAPS_LOCK &&
-                       !key_press.data.released0) ||
-                      (key_press.data.key1 == ADBKey::KeyCode::CAPS_LOCK &&
-                       !key_press.data.released1);
-
-    if (is_pressed) {
-      // Activer Caps Lock
-      deviceState.led_caps = true;
-      Serial.println("Caps Lock activé.");
-      report_changed = true;
-    
-      // Envoyer un événement de pression pour Caps Lock
-      key_report.keys[0] = ADBKey::KeyCode::CAPS_LOCK;
-      hid_keyboard_send_report(&key_report);
-      Serial.println("Événement de pression de Caps Lock envoyé.");
-
-      delay(100); // Attendre un court instant pour éviter les rebonds
-      // Envoyer un événement de relâchement pour Caps Lock
-      key_report.keys[0] = 0;
-      hid_keyboard_send_report(&key_report);
-      Serial.println("Événement de relâchement de Caps Lock envoyé.");
-    } else {
-      // Désactiver Caps Lock au relâchement
-      deviceState.led_caps = false;
-      Serial.println("Caps Lock désactivé.");
-      report_changed = true;
-
-      // Envoyer un événement de pression pour Caps Lock
-      key_report.keys[0] = ADBKey::KeyCode::CAPS_LOCK;
-      hid_keyboard_send_report(&key_report);
-      Serial.println("Événement de pression de Caps Lock envoyé.");
-      delay(100); // Attendre un court instant pour éviter les rebonds
-                  // Envoyer un événement de relâchement pour Caps Lock
-      key_report.keys[0] = 0;
-      hid_keyboard_send_report(&key_report);
-      Serial.println("Événement de relâchement de Caps Lock envoyé.");
-    }
+  // Réaffectation éventuelle téléversée par le protocole de contrôle ; la
+  // touche Power (0x7F) n'est jamais réaffectée
+  if (keycode != 0x7F)
+    keycode = key_remap_lookup(keycode);
+
+  // Gestion de Caps Lock : touche à bascule, l'état suit la position
+  if (keycode == ADBKey::KeyCode::CAPS_LOCK) {
+    deviceState.led_caps = !released;
+    Console.println(released ? "Caps Lock désactivé." : "Caps Lock activé.");
+    pushInputEvent(INPUT_EVENT_KEY_TAP, keycode);
+    pushLedState();
+    return;
   }
 
+  pushInputEvent(released ? INPUT_EVENT_KEY_UP : INPUT_EVENT_KEY_DOWN,
+                 keycode);
+
   // Gestion de Num Lock
-  if ((key_press.data.key0 == ADBKey::KeyCode::NUM_LOCK &&
-       !key_press.data.released0) ||
-      (key_press.data.key1 == ADBKey::KeyCode::NUM_LOCK &&
-       !key_press.data.released1)) {
+  if (keycode == ADBKey::KeyCode::NUM_LOCK && !released) {
     deviceState.led_num = !deviceState.led_num;
-    Serial.print("Num Lock LED (ADB) : ");
-    Serial.println(deviceState.led_num ? "Allumée" : "Éteinte");
-    report_changed = true;
+    Console.print("Num Lock LED (ADB) : ");
+    Console.println(deviceState.led_num ? "Allumée" : "Éteinte");
+    pushLedState();
   }
+}
 
-  if (report_changed) {
-    Serial.println("Rapport clavier mis à jour.");
-    hid_keyboard_send_report(&key_report);
+/**
+ * @brief Gère les événements du clavier.
+ *
+ * @return true si une trame non vide a été reçue.
+ */
+bool handleKeyboard() {
+  adb_data<adb_kb_keypress> key_press = {0};
 
-#ifdef ARDUINO_ARCH_ESP32
-    if (isBleConnected) {
-      uint8_t buf[1] = {static_cast<uint8_t>((deviceState.led_caps << 1) |
-                                             deviceState.led_num)};
-      output_keyboard->setValue(buf, sizeof(buf));
-      output_keyboard->notify();
-    }
-#endif
+  if (!pollDevice(ADB_STATS_KEYBOARD, [&]() {
+        return talkRegister16(ADBKey::Address::KEYBOARD, 0, &key_press.raw);
+      })) {
+    return false;
   }
+
+  if (key_press.raw == ADBKey::KeyCode::POWER_DOWN ||
+      key_press.raw == ADBKey::KeyCode::POWER_UP) {
+    pushInputEvent(key_press.raw == ADBKey::KeyCode::POWER_UP
+                       ? INPUT_EVENT_KEY_UP
+                       : INPUT_EVENT_KEY_DOWN,
+                   INPUT_ADB_POWER_CODE);
+  } else {
+    decodeKey(key_press.data.key0, key_press.data.released0);
+    decodeKey(key_press.data.key1, key_press.data.released1);
+  }
+  // Pendant la suspension, la frappe reste dans la file et réveille l'hôte
+  host_suspend_note_wake_event(static_cast<uint32_t>(micros()));
+  wakeReportConsumer();
+  return true;
 }
 
 /**
  * @brief Gère les événements de la souris.
+ *
+ * @return true si une trame non vide a été reçue.
  */
-void handleMouse() {
-  bool error = false;
-
-  auto mouse_data = adbDevices.mouseReadData(&error);
-  if (error || mouse_data.raw == 0) {
-    return;
+bool handleMouse() {
+  adb_data<adb_mouse_data> mouse_data = {0};
+
+  if (!pollDevice(ADB_STATS_MOUSE, [&]() {
+        return talkRegister16(ADBKey::Address::MOUSE, 0, &mouse_data.raw);
+      }) ||
+      mouse_data.raw == 0) {
+    return false;
   }
 
   int8_t mouse_x = adbMouseConvertAxis(mouse_data.data.x_offset);
   int8_t mouse_y = adbMouseConvertAxis(mouse_data.data.y_offset);
+  // Bouton ADB actif à l'état bas
+  bool button = !mouse_data.data.button;
+
+  // Pendant la suspension, seul un clic est conservé : il réveille l'hôte
+  if (host_suspend_active()) {
+    if (!button)
+      return true;
+    host_suspend_note_wake_event(static_cast<uint32_t>(micros()));
+  }
+
+  pushInputEvent(INPUT_EVENT_MOUSE, button ? 1 : 0, mouse_x, mouse_y);
+  wakeReportConsumer();
+  return true;
+}
+
+/**
+ * @brief Gère les échantillons de la tablette graphique.
+ *
+ * Chaque trame est décodée et déposée telle quelle ; le regroupement a lieu
+ * à la construction des rapports.
+ *
+ * @return true si une trame a été reçue.
+ */
+bool handleTablet() {
+  uint8_t frame[ADB_TABLET_FRAME_MAX];
+  uint8_t len = 0;
+
+  if (!pollDevice(ADB_STATS_TABLET, [&]() {
+        return talkRegister(ADB_TABLET_ADDRESS, 0, frame, sizeof(frame), &len);
+      }))
+    return false;
+
+  tablet_sample sample;
+  if (!adb_tablet_decode(deviceState.tablet_format, frame, len, &sample))
+    return false;
+
+  sample.timestamp_us = static_cast<uint32_t>(micros());
+  adb_tablet_push(sample);
+  wakeReportConsumer();
+  return true;
+}
+
+/**
+ * @brief Lit et décode l'état de la manette.
+ *
+ * Seuls les changements sont déposés ; le regroupement a lieu à la
+ * construction des rapports.
+ *
+ * @return true si l'état a changé.
+ */
+bool handleJoystick() {
+  uint8_t frame[ADB_JOYSTICK_FRAME_MAX];
+  uint8_t len = 0;
+
+  joystickPolledUs = static_cast<uint32_t>(micros());
+  bool ok = pollDevice(ADB_STATS_JOYSTICK, [&]() {
+    return talkRegister(ADB_JOYSTICK_ADDRESS, 0, frame, sizeof(frame), &len);
+  });
+  joystickTalkUs = static_cast<uint32_t>(micros()) - joystickPolledUs;
+  if (!ok)
+    return false;
+
+  joystick_sample sample;
+  if (!adb_joystick_decode(frame, len, &sample))
+    return false;
+
+  sample.timestamp_us = static_cast<uint32_t>(micros());
+  if (!adb_joystick_push(sample))
+    return false;
+  wakeReportConsumer();
+  return true;
+}
 
-  Serial.print("Mouvement souris - X: ");
-  Serial.print(mouse_x);
-  Serial.print(", Y: ");
-  Serial.println(mouse_y);
+/**
+ * @brief Effectue un cycle d'interrogation des périphériques ADB.
+ *
+ * Pendant la suspension de l'hôte, une sonde SRQ précède le cycle : sans
+ * demande de service, aucun périphérique n'est interrogé. La tablette et la
+ * manette ne sont pas interrogées tant que l'hôte est suspendu ; la manette
+ * ouvre le cycle et dispose en plus de ses propres créneaux entre deux
+ * cycles (voir serviceJoystickSlots()).
+ */
+void pollDevices() {
+  uint32_t now = millis();
+  if (host_suspend_active() && !host_suspend_waking(now) &&
+      !probeServiceRequest()) {
+    power_update(now);
+    return;
+  }
 
-  // Envoyer le rapport HID pour la souris
-  hid_mouse_send_report(mouse_data.data.button ? 0 : 1, mouse_x, mouse_y);
+  if (ledsUpdatePending.exchange(false)) {
+    if (deviceState.keyboard_present)
+      writeKeyboardLeds();
+    pushLedState();
+  }
 
-#ifdef ARDUINO_ARCH_ESP32
-  if (isBleConnected) {
-    uint8_t buf[4] = {
-        static_cast<uint8_t>(mouse_data.data.button ? 0 : 1), // Bouton
-        static_cast<uint8_t>(mouse_x),                       // Déplacement X
-        static_cast<uint8_t>(mouse_y),                       // Déplacement Y
-        0                                                   // Molette (non utilisée)
-    };
-    input_mouse->setValue(buf, sizeof(buf));
-    input_mouse->notify();
-    Serial.println("Rapport HID souris envoyé via Bluetooth.");
+  bool activity = false;
+  pollCycles++;
+
+  if (deviceState.joystick_present && !host_suspend_active())
+    activity = handleJoystick() || activity;
+
+  // Rafale plus rapide que l'hôte : la trame suivante attend dans le
+  // clavier plutôt que de déborder de la file des événements
+  if (deviceState.keyboard_present &&
+      INPUT_EVENT_RING_SIZE - input_event_pending() < KEYBOARD_FRAME_EVENTS) {
+    keyboardDeferred++;
+  } else if (deviceState.keyboard_present) {
+    //  Console.println("Gestion du clavier...");
+    activity = handleKeyboard() || activity;
+  }
+
+  if (deviceState.mouse_present) {
+    //  Console.println("Gestion de la souris...");
+    activity = handleMouse() || activity;
+  }
+
+  if (deviceState.tablet_present && !host_suspend_active())
+    activity = handleTablet() || activity;
+
+  // Retour immédiat au rythme nominal sur la première trame non vide
+  now = millis();
+  if (activity)
+    power_note_activity(now);
+  power_update(now);
+}
+
+/**
+ * @brief Attend `until_us` en représentant les rapports clavier en attente.
+ *
+ * Pendant une rafale (lecteur de codes-barres), le rapport suivant est
+ * proposé toutes les KEY_QUEUE_RETRY_US plutôt qu'au cycle suivant : chaque
+ * jeton IN libéré par l'hôte en reçoit un. Sur ESP32, la tâche Bluetooth
+ * s'en charge.
+ *
+ * @param until_us Fin de l'attente.
+ */
+void waitPacingKeystrokes(uint32_t until_us) {
+#ifndef ARDUINO_ARCH_ESP32
+  while (key_queue_pending() > 0 && !host_suspend_active()) {
+    uint32_t next = micros() + KEY_QUEUE_RETRY_US;
+    if ((int32_t)(until_us - next) <= 0)
+      break;
+    power_idle_wait_until_us(next);
+    hid_reports_service(millis());
   }
 #endif
+  power_idle_wait_until_us(until_us);
+}
+
+/**
+ * @brief Attend `until_us` en interrogeant la manette dans ses créneaux.
+ *
+ * Entre deux cycles, la manette est relue toutes les ADB_JOYSTICK_POLL_US,
+ * indépendamment du rythme de power_manager, et son rapport part aussitôt.
+ * Un créneau dont la lecture (durée mesurée) déborderait sur le cycle
+ * suivant est laissé à ce cycle.
+ *
+ * @param until_us Démarrage du cycle suivant.
+ * @return false si aucune manette n'est à servir (rien n'a été attendu).
+ */
+bool serviceJoystickSlots(uint32_t until_us) {
+  if (!deviceState.joystick_present || host_suspend_active())
+    return false;
+
+  for (;;) {
+    uint32_t slot = joystickPolledUs + ADB_JOYSTICK_POLL_US;
+    uint32_t now = micros();
+    if ((int32_t)(slot - now) < 0)
+      slot = now;
+    if ((int32_t)(until_us - slot) < (int32_t)joystickTalkUs)
+      break;
+
+    waitPacingKeystrokes(slot);
+    if (handleJoystick())
+      power_note_activity(millis());
+#ifndef ARDUINO_ARCH_ESP32
+    hid_reports_service(millis());
+#endif
+  }
+  waitPacingKeystrokes(until_us);
+  return true;
 }
 
+/**
+ * @brief Attend le cycle d'interrogation suivant.
+ *
+ * Rythme de power_manager ; tant que les SOF USB sont reçus, le démarrage
+ * est calé pour que le cycle se termine juste avant un jeton IN du clavier
+ * (voir sof_sync.h). Les créneaux de la manette et la file des frappes
+ * occupent l'attente.
+ *
+ * @param cycle_start_us Démarrage du cycle qui vient de se terminer.
+ */
+void waitNextCycle(uint32_t cycle_start_us) {
+  uint32_t now = micros();
+  sof_sync_note_cycle(now - cycle_start_us);
+
+  uint16_t interval = power_poll_interval_ms();
+  if (power_get_state() == POWER_SUSPEND || !sof_sync_locked(now)) {
+    uint32_t until = now + interval * 1000UL;
+    if (serviceJoystickSlots(until))
+      return;
+    if (key_queue_pending() > 0)
+      waitPacingKeystrokes(until);
+    else
+      power_idle_wait(interval);
+    return;
+  }
+
+  uint32_t earliest = cycle_start_us + interval * 1000UL;
+  if ((int32_t)(earliest - now) < 0)
+    earliest = now;
+  uint32_t start = sof_sync_next_start(earliest);
+  if (!serviceJoystickSlots(start))
+    waitPacingKeystrokes(start);
+}
+
+/**
+ * @brief Met à jour l'écran d'état.
+ *
+ * Le dessin est limité à DISPLAY_REFRESH_MS et au plus un transfert de page
+ * est engagé par appel : l'écran n'est jamais attendu.
+ *
+ * @param now Temps courant en millisecondes.
+ */
+void serviceDisplay(uint32_t now) {
+  static uint32_t rate_ms = 0;
+  static uint32_t rate_cycles = 0;
+  static uint16_t poll_hz = 0;
+
+  if (status_display_due(now)) {
+    // Cadence mesurée sur au moins une seconde
+    if (now - rate_ms >= 1000) {
+      uint32_t cycles = pollCycles;
+      poll_hz = (cycles - rate_cycles) * 1000UL / (now - rate_ms);
+      rate_cycles = cycles;
+      rate_ms = now;
+    }
+
+    display_status status = {};
+    status.present[ADB_STATS_KEYBOARD] = deviceState.keyboard_present;
+    status.present[ADB_STATS_MOUSE] = deviceState.mouse_present;
+    status.present[ADB_STATS_TABLET] = deviceState.tablet_present;
+    status.present[ADB_STATS_JOYSTICK] = deviceState.joystick_present;
+    for (uint8_t i = 0;
+         i < hid_transport_count() && i < DISPLAY_TRANSPORT_MAX; i++) {
+      const hid_transport *transport = hid_transport_get(i);
+      status.transport_name[i] = transport->name;
+      if (transport->suspended != nullptr && transport->suspended())
+        status.transport_link[i] = DISPLAY_LINK_SUSPENDED;
+      else if (transport->ready())
+        status.transport_link[i] = DISPLAY_LINK_READY;
+      status.transport_count++;
+    }
+    status.leds = (deviceState.led_num ? INPUT_LED_NUM : 0) |
+                  (deviceState.led_caps ? INPUT_LED_CAPS : 0) |
+                  (deviceState.led_scroll ? INPUT_LED_SCROLL : 0);
+    status.poll_hz = poll_hz;
+    for (uint8_t device = 0; device < ADB_STATS_DEVICE_COUNT; device++) {
+      const adb_device_stats *stats = adb_stats_get(device);
+      status.errors[device] = stats->bit_errors + stats->collisions;
+    }
+    status_display_render(status, now);
+  }
+  status_display_service();
+}
+
+/**
+ * @brief Suit la suspension du bus par l'hôte et émet le réveil à distance.
+ *
+ * La signalisation de réveil est maintenue HOST_WAKEUP_SIGNAL_MS ; le rythme
+ * nominal est repris jusqu'à la reprise pour remettre l'événement retenu au
+ * plus tôt.
+ */
+void serviceHostSuspend() {
+  bool suspended = hid_transport_suspended();
+  if (host_suspend_update(suspended))
+    Console.println(suspended ? "Hôte suspendu : sonde SRQ seule."
+                             : "Hôte réveillé.");
+
+  uint32_t now = millis();
+  if (host_suspend_wakeup_due(now)) {
+    if (hid_transport_remote_wakeup(true)) {
+      delay(HOST_WAKEUP_SIGNAL_MS);
+      hid_transport_remote_wakeup(false);
+    }
+    now = millis();
+  }
+  power_set_suspended(host_suspend_active() && !host_suspend_waking(now), now);
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+/**
+ * @brief Tâche d'interrogation ADB, épinglée sur son propre cœur.
+ */
+void adbTask(void *) {
+  for (;;) {
+    pollDevices();
+    uint16_t interval = power_poll_interval_ms();
+    if (!serviceJoystickSlots(micros() + interval * 1000UL))
+      power_idle_wait(interval);
+  }
+}
+#endif
+
 /**
  * @brief Boucle principale du programme.
  */
 void loop() {
-  if (deviceState.keyboard_present) {
-    //  Serial.println("Gestion du clavier...");
-    handleKeyboard();
-    delay(POLL_DELAY);
+  if (snifferMode) {
+    adb_sniffer_service();
+    return;
   }
 
-  if (deviceState.mouse_present) {
-    //  Serial.println("Gestion de la souris...");
-    handleMouse();
-    delay(POLL_DELAY);
-  }
+  handleSerialCommands();
+
+#ifdef ARDUINO_ARCH_ESP32
+  // L'interrogation ADB est assurée par adbTask sur ADB_TASK_CORE ; l'écran
+  // d'état est servi ici
+  serviceDisplay(millis());
+  delay(10);
+#else
+  uint32_t cycle_start = micros();
+  pollDevices();
+  serviceHostSuspend();
+  // Rapports retenus dans la file pendant la suspension
+  if (!host_suspend_active())
+    hid_reports_service(millis());
+  serviceDisplay(millis());
+  waitNextCycle(cycle_start);
+#endif
 }
 
 #endif
\ No newline at end of file
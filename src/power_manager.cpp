@@ -0,0 +1,167 @@
+/**
+ * @file power_manager.cpp
+ * @brief Implémentation de la gestion de l'énergie.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "power_manager.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_pm.h>
+#endif
+
+static const uint16_t poll_intervals[POWER_STATE_COUNT] = {
+    POLL_DELAY, POWER_IDLE_POLL_MS, POWER_SLEEP_POLL_MS,
+    POWER_SUSPEND_POLL_MS};
+
+static power_state state = POWER_ACTIVE;
+static uint32_t last_activity_ms = 0;
+static uint32_t state_entered_ms = 0;
+static uint32_t time_in_state[POWER_STATE_COUNT];
+static uint32_t init_ms = 0;
+static uint64_t waited_us = 0;
+static bool light_sleep = false;
+
+static void enter_state(power_state next, uint32_t now_ms) {
+  if (next == state)
+    return;
+
+  time_in_state[state] += now_ms - state_entered_ms;
+  state_entered_ms = now_ms;
+  state = next;
+}
+
+void power_init(uint32_t now_ms) {
+  state = POWER_ACTIVE;
+  last_activity_ms = now_ms;
+  state_entered_ms = now_ms;
+  for (uint8_t i = 0; i < POWER_STATE_COUNT; i++)
+    time_in_state[i] = 0;
+  init_ms = now_ms;
+  waited_us = 0;
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_PM_ENABLE) &&                \
+    defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+  // Veille légère automatique pendant les délais FreeRTOS : build
+  // esp32dev_battery (sdkconfig.defaults) ; le SDK arduino-esp32 précompilé
+  // n'active pas le tickless idle
+  esp_pm_config_esp32_t pm_config = {};
+  pm_config.max_freq_mhz = 240;
+  pm_config.min_freq_mhz = 80;
+  pm_config.light_sleep_enable = true;
+  light_sleep = esp_pm_configure(&pm_config) == ESP_OK;
+#endif
+}
+
+void power_note_activity(uint32_t now_ms) {
+  last_activity_ms = now_ms;
+  if (state != POWER_SUSPEND)
+    enter_state(POWER_ACTIVE, now_ms);
+}
+
+void power_set_suspended(bool suspended, uint32_t now_ms) {
+  if (suspended) {
+    enter_state(POWER_SUSPEND, now_ms);
+  } else if (state == POWER_SUSPEND) {
+    last_activity_ms = now_ms;
+    enter_state(POWER_ACTIVE, now_ms);
+  }
+}
+
+power_state power_update(uint32_t now_ms) {
+  if (state == POWER_SUSPEND)
+    return state;
+
+  uint32_t idle_ms = now_ms - last_activity_ms;
+
+  if (idle_ms >= POWER_SLEEP_AFTER_MS)
+    enter_state(POWER_SLEEP, now_ms);
+  else if (idle_ms >= POWER_IDLE_AFTER_MS)
+    enter_state(POWER_IDLE, now_ms);
+
+  return state;
+}
+
+power_state power_get_state() { return state; }
+
+uint16_t power_poll_interval_ms() { return poll_intervals[state]; }
+
+uint32_t power_time_in_state_ms(uint8_t s, uint32_t now_ms) {
+  if (s >= POWER_STATE_COUNT)
+    return 0;
+  if (s == state)
+    return time_in_state[s] + (now_ms - state_entered_ms);
+  return time_in_state[s];
+}
+
+void power_account_wait_us(uint32_t us) { waited_us += us; }
+
+uint16_t power_wait_permille(uint32_t now_ms) {
+  uint32_t elapsed_ms = now_ms - init_ms;
+  if (elapsed_ms == 0)
+    return 0;
+  // µs attendues par ms écoulée : directement des pour mille
+  uint64_t permille = waited_us / elapsed_ms;
+  return permille > 1000 ? 1000 : (uint16_t)permille;
+}
+
+const char *power_sleep_mode() {
+#if defined(ARDUINO_ARCH_STM32)
+  return "WFI";
+#else
+  return light_sleep ? "veille legere" : "delai";
+#endif
+}
+
+void power_idle_wait(uint16_t ms) {
+#if defined(ARDUINO_ARCH_STM32)
+  // Le SysTick (1 ms) réveille le cœur à chaque tick
+  uint32_t start = millis();
+  uint32_t start_us = micros();
+  while (millis() - start < ms)
+    __WFI();
+  power_account_wait_us(micros() - start_us);
+#elif defined(ARDUINO)
+  uint32_t start_us = micros();
+  delay(ms);
+  power_account_wait_us(micros() - start_us);
+#else
+  (void)ms;
+#endif
+}
+
+void power_idle_wait_until_us(uint32_t deadline_us) {
+#if defined(ARDUINO)
+  uint32_t start_us = micros();
+#endif
+#if defined(ARDUINO_ARCH_STM32)
+  // Plus d'une trame USB (1 ms) : une interruption réveillera le cœur à temps
+  while ((int32_t)(deadline_us - micros()) > 1000)
+    __WFI();
+  while ((int32_t)(deadline_us - micros()) > 0) {
+  }
+#elif defined(ARDUINO)
+  int32_t remaining = (int32_t)(deadline_us - micros());
+#if defined(ARDUINO_ARCH_ESP32)
+  if (remaining >= 1000) {
+    delay(remaining / 1000);
+    remaining = (int32_t)(deadline_us - micros());
+  }
+#endif
+  if (remaining > 0)
+    delayMicroseconds(remaining);
+#else
+  (void)deadline_us;
+#endif
+#if defined(ARDUINO)
+  power_account_wait_us(micros() - start_us);
+#endif
+}
@@ -0,0 +1,153 @@
+/**
+ * @file power_manager.h
+ * @brief Gestion de l'énergie : ralentissement progressif de l'interrogation
+ * ADB en période d'inactivité et mise en veille légère entre deux cycles.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Le délai entre deux cycles d'interrogation augmente par paliers tant
+ * qu'aucune trame non vide n'est reçue, et revient au rythme nominal dès la
+ * première trame. Le palier le plus lent reste assez rapide pour que la
+ * première frappe atteigne l'hôte en moins de 20 ms (le clavier ADB conserve
+ * les frappes dans sa file interne entre deux interrogations).
+ *
+ * Pendant une suspension du bus par l'hôte (voir host_suspend.h), le palier
+ * POWER_SUSPEND impose un rythme lent indépendant de l'activité.
+ *
+ * Sur STM32, le cœur dort en WFI entre deux cycles. Sur ESP32, la veille
+ * légère n'est possible qu'avec un sdkconfig activant CONFIG_PM_ENABLE et
+ * CONFIG_FREERTOS_USE_TICKLESS_IDLE (et la veille du modem Bluetooth) : le
+ * SDK arduino-esp32 précompilé ne les active pas et l'attente n'est alors
+ * qu'un délai FreeRTOS, cœur à pleine fréquence. La part du temps passée en
+ * attente est mesurée (power_wait_permille()) plutôt que supposée.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <cstdint>
+
+#define POLL_DELAY 5 /**< Délai (ms) entre deux cycles en activité. */
+
+#define POWER_IDLE_POLL_MS 8   /**< Délai (ms) entre deux cycles au repos. */
+#define POWER_SLEEP_POLL_MS 12 /**< Délai (ms) entre deux cycles en veille. */
+/** Délai (ms) entre deux sondes SRQ pendant la suspension de l'hôte. */
+#define POWER_SUSPEND_POLL_MS 50
+
+#define POWER_IDLE_AFTER_MS 2000   /**< Inactivité avant le repos. */
+#define POWER_SLEEP_AFTER_MS 30000 /**< Inactivité avant la veille. */
+
+/**
+ * @enum power_state
+ * @brief Paliers de consommation.
+ */
+enum power_state : uint8_t {
+  POWER_ACTIVE = 0, /**< Interrogation au rythme nominal. */
+  POWER_IDLE,       /**< Inactivité courte : rythme réduit. */
+  POWER_SLEEP,      /**< Inactivité longue : rythme minimal. */
+  POWER_SUSPEND,    /**< Hôte suspendu : sonde SRQ seule. */
+  POWER_STATE_COUNT
+};
+
+/**
+ * @brief Initialise le gestionnaire (état actif).
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+void power_init(uint32_t now_ms);
+
+/**
+ * @brief Signale une trame non vide : retour immédiat au rythme nominal.
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+void power_note_activity(uint32_t now_ms);
+
+/**
+ * @brief Entre dans le palier POWER_SUSPEND ou en sort.
+ *
+ * En sortie, l'état redevient actif. Sans effet si l'état demandé est déjà
+ * celui en cours.
+ *
+ * @param suspended true pendant la suspension de l'hôte.
+ * @param now_ms Temps courant en millisecondes.
+ */
+void power_set_suspended(bool suspended, uint32_t now_ms);
+
+/**
+ * @brief Fait évoluer l'état selon la durée d'inactivité.
+ *
+ * Le palier POWER_SUSPEND n'est quitté que par power_set_suspended().
+ *
+ * @param now_ms Temps courant en millisecondes.
+ * @return L'état courant.
+ */
+power_state power_update(uint32_t now_ms);
+
+/**
+ * @brief État courant.
+ */
+power_state power_get_state();
+
+/**
+ * @brief Délai (ms) à observer avant le prochain cycle d'interrogation.
+ */
+uint16_t power_poll_interval_ms();
+
+/**
+ * @brief Temps cumulé passé dans un état, état courant compris.
+ *
+ * @param state État concerné.
+ * @param now_ms Temps courant en millisecondes.
+ * @return Durée en millisecondes.
+ */
+uint32_t power_time_in_state_ms(uint8_t state, uint32_t now_ms);
+
+/**
+ * @brief Comptabilise une attente (appelé par les fonctions d'attente).
+ *
+ * @param us Durée effective de l'attente en microsecondes.
+ */
+void power_account_wait_us(uint32_t us);
+
+/**
+ * @brief Part du temps passée en attente depuis power_init(), en pour mille.
+ *
+ * Borne supérieure du temps de sommeil : sans veille légère (ESP32 sur SDK
+ * précompilé), le cœur reste alimenté pendant ces attentes.
+ *
+ * @param now_ms Temps courant en millisecondes.
+ */
+uint16_t power_wait_permille(uint32_t now_ms);
+
+/**
+ * @brief Mode d'attente effectif : "WFI", "veille legere" ou "delai".
+ */
+const char *power_sleep_mode();
+
+/**
+ * @brief Attend le prochain cycle en veille légère.
+ *
+ * WFI sur STM32 (réveil par le SysTick), délai FreeRTOS sur ESP32 (veille
+ * légère automatique seulement si la gestion d'énergie ESP-IDF est compilée,
+ * voir power_sleep_mode()).
+ *
+ * @param ms Durée de l'attente en millisecondes.
+ */
+void power_idle_wait(uint16_t ms);
+
+/**
+ * @brief Attend une échéance en microsecondes (cycle calé sur les SOF USB,
+ * créneaux de la manette).
+ * Veille légère tant qu'il reste plus d'une trame USB, puis attente active :
+ * le réveil par le SysTick ou le SOF suivant manquerait l'échéance. Sur
+ * ESP32, les millisecondes entières sont rendues au planificateur.
+ * @param deadline_us Échéance en microsecondes.
+ */
+void power_idle_wait_until_us(uint32_t deadline_us);
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,259 @@
+/**
+ * @file sof_sync.cpp
+ * @brief Implémentation du calage de l'interrogation ADB sur les SOF USB.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "sof_sync.h"
+#include <cstdio>
+
+#if defined(ARDUINO_ARCH_STM32) && defined(USBCON)
+#include "usbd_hid_composite.h"
+#include <Arduino.h>
+#endif
+
+// Mis à jour sous interruption
+static volatile uint32_t frames = 0;
+static volatile uint32_t last_sof_us = 0;
+static volatile uint32_t in_phase_us = SOF_SYNC_IN_PHASE_US;
+static volatile uint32_t in_frame = 0; // Trame du dernier jeton IN
+static volatile bool in_seen = false;
+static volatile uint32_t gap_gcd = 0; // PGCD des écarts (0 : aucun)
+static volatile uint32_t interval_frames = SOF_SYNC_INTERVAL_FRAMES;
+static uint32_t declared_frames = SOF_SYNC_INTERVAL_FRAMES;
+static volatile bool pending = false; // Rapport remis, jeton IN attendu
+static uint32_t pending_us = 0;
+
+static bool enabled = true;
+static bool cycle_reported = false;
+static uint32_t cycle_us = 0;
+static uint32_t overruns = 0;
+static uint32_t count = 0;
+static uint32_t max_us = 0;
+static uint64_t sum_us = 0;
+static uint32_t bins[SOF_SYNC_BINS];
+
+void sof_sync_reset() {
+  frames = 0;
+  last_sof_us = 0;
+  in_phase_us = SOF_SYNC_IN_PHASE_US;
+  in_frame = 0;
+  in_seen = false;
+  gap_gcd = 0;
+  interval_frames = declared_frames;
+  pending = false;
+  enabled = true;
+  cycle_reported = false;
+  cycle_us = 0;
+  overruns = 0;
+  count = 0;
+  max_us = 0;
+  sum_us = 0;
+  for (uint8_t i = 0; i < SOF_SYNC_BINS; i++)
+    bins[i] = 0;
+}
+
+#if defined(ARDUINO_ARCH_STM32) && defined(USBCON)
+// Gestionnaire DataIn d'origine de la classe HID composite
+static uint8_t (*class_data_in)(USBD_HandleTypeDef *, uint8_t) = nullptr;
+
+static uint8_t on_sof(USBD_HandleTypeDef *) {
+  sof_sync_frame(micros());
+  return USBD_OK;
+}
+
+static uint8_t on_data_in(USBD_HandleTypeDef *pdev, uint8_t epnum) {
+  if ((epnum | 0x80) == HID_KEYBOARD_EPIN_ADDR)
+    sof_sync_in_token(micros());
+  return class_data_in(pdev, epnum);
+}
+
+void sof_sync_begin() {
+  // À appeler après HID_Composite_Init() : la classe est alors enregistrée
+  // et le registre de contrôle initialisé.
+  if (class_data_in == nullptr) {
+    class_data_in = USBD_COMPOSITE_HID.DataIn;
+    USBD_COMPOSITE_HID.DataIn = on_data_in;
+  }
+  sof_sync_set_declared_interval(HID_FS_BINTERVAL);
+  USBD_COMPOSITE_HID.SOF = on_sof;
+  // Interruption SOF masquée par la configuration du cœur (Sof_enable)
+  USB->CNTR |= USB_CNTR_SOFM;
+}
+#else
+void sof_sync_begin() {}
+#endif
+
+void sof_sync_set_enabled(bool on) { enabled = on; }
+
+bool sof_sync_enabled() { return enabled; }
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+  while (b != 0) {
+    uint32_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+/**
+ * @brief Intervalle entre jetons IN tiré du PGCD des écarts.
+ *
+ * L'hôte peut interroger plus souvent que le bInterval déclaré, jamais
+ * moins : le plus grand diviseur du PGCD qui ne le dépasse pas. Une fois
+ * les cycles calés, les rapports ne partent plus qu'aux jetons visés ; sans
+ * cette borne, un PGCD trop grand ne serait jamais corrigé.
+ */
+static uint32_t interval_from(uint32_t gaps) {
+  if (gaps == 0)
+    return declared_frames;
+  for (uint32_t d = gaps < declared_frames ? gaps : declared_frames; d > 1;
+       d--)
+    if (gaps % d == 0)
+      return d;
+  return 1;
+}
+
+void sof_sync_set_declared_interval(uint32_t frames) {
+  declared_frames = frames ? frames : 1;
+  interval_frames = interval_from(gap_gcd);
+}
+
+void sof_sync_frame(uint32_t now_us) {
+  // Reprise après suspension : la numérotation des trames côté hôte et
+  // son rythme d'interrogation ne sont plus liés aux écarts déjà vus
+  if (frames != 0 && now_us - last_sof_us >= SOF_SYNC_LOST_US) {
+    in_seen = false;
+    gap_gcd = 0;
+    interval_frames = declared_frames;
+  }
+  last_sof_us = now_us;
+  frames = frames + 1;
+}
+
+void sof_sync_in_token(uint32_t now_us) {
+  if (frames != 0) {
+    // Un SOF encore en attente de traitement décale l'écart d'une trame
+    uint32_t since_sof = now_us - last_sof_us;
+    int32_t phase = (int32_t)(since_sof % SOF_SYNC_FRAME_US);
+    in_phase_us = (uint32_t)((int32_t)in_phase_us +
+                             (phase - (int32_t)in_phase_us) / 4);
+
+    uint32_t frame = frames + since_sof / SOF_SYNC_FRAME_US;
+    uint32_t gap = frame - in_frame;
+    if (in_seen && gap != 0) {
+      gap_gcd = gcd(gap_gcd, gap);
+      interval_frames = interval_from(gap_gcd);
+    }
+    in_frame = frame;
+    in_seen = true;
+  }
+
+  if (!pending)
+    return;
+  pending = false;
+
+  uint32_t delay_us = now_us - pending_us;
+  count++;
+  sum_us += delay_us;
+  if (delay_us > max_us)
+    max_us = delay_us;
+  uint32_t bin = delay_us / SOF_SYNC_BIN_US;
+  bins[bin < SOF_SYNC_BINS ? bin : SOF_SYNC_BINS - 1]++;
+}
+
+void sof_sync_note_report(uint32_t event_us) {
+  cycle_reported = true;
+  if (pending)
+    return;
+  pending_us = event_us;
+  pending = true;
+}
+
+void sof_sync_note_cycle(uint32_t duration_us) {
+  if (!cycle_reported)
+    return;
+  cycle_reported = false;
+
+  // Montée immédiate : un cycle trop long manque le jeton IN visé
+  if (duration_us > cycle_us) {
+    if (cycle_us != 0)
+      overruns++;
+    cycle_us = duration_us;
+  } else {
+    cycle_us -= (cycle_us - duration_us) / 8;
+  }
+}
+
+bool sof_sync_locked(uint32_t now_us) {
+  return enabled && frames != 0 && now_us - last_sof_us < SOF_SYNC_LOST_US;
+}
+
+uint32_t sof_sync_next_start(uint32_t earliest_us) {
+  uint32_t n, sof, in_n, iv;
+  do {
+    n = frames;
+    sof = last_sof_us;
+    in_n = in_frame;
+    iv = interval_frames;
+  } while (n != frames);
+
+  const uint32_t period = SOF_SYNC_FRAME_US * iv;
+  // Trames jusqu'au prochain jeton IN attendu (le dernier peut précéder
+  // d'une trame le SOF correspondant, encore en attente)
+  int32_t since_in = (int32_t)(n - in_n);
+  uint32_t skip = since_in >= 0 ? (iv - (uint32_t)since_in % iv) % iv
+                                : (uint32_t)(-since_in) % iv;
+  uint32_t lead = cycle_us + SOF_SYNC_GUARD_US;
+  uint32_t start = sof + skip * SOF_SYNC_FRAME_US + in_phase_us - lead;
+
+  int32_t late = (int32_t)(earliest_us - start);
+  if (late > 0)
+    start += ((uint32_t)late + period - 1) / period * period;
+  else
+    start -= (uint32_t)(-late) / period * period;
+  return start;
+}
+
+sof_sync_stats sof_sync_get_stats() {
+  sof_sync_stats stats = {};
+  stats.frames = frames;
+  stats.in_phase_us = in_phase_us;
+  stats.interval_frames = interval_frames;
+  stats.cycle_us = cycle_us;
+  stats.overruns = overruns;
+  stats.count = count;
+  stats.mean_us = count ? (uint32_t)(sum_us / count) : 0;
+  stats.max_us = max_us;
+  for (uint8_t i = 0; i < SOF_SYNC_BINS; i++)
+    stats.bins[i] = bins[i];
+  return stats;
+}
+
+size_t sof_sync_format(char *buf, size_t len) {
+  if (len == 0)
+    return 0;
+
+  sof_sync_stats stats = sof_sync_get_stats();
+  int n = snprintf(buf, len,
+                   "SOF on=%d n=%lu in=%lu iv=%lu cyc=%lu ovr=%lu lat=%lu "
+                   "moy=%lu max=%lu h=",
+                   enabled ? 1 : 0, (unsigned long)stats.frames,
+                   (unsigned long)stats.in_phase_us,
+                   (unsigned long)stats.interval_frames,
+                   (unsigned long)stats.cycle_us,
+                   (unsigned long)stats.overruns, (unsigned long)stats.count,
+                   (unsigned long)stats.mean_us, (unsigned long)stats.max_us);
+  for (uint8_t i = 0; i < SOF_SYNC_BINS && n >= 0 && (size_t)n < len; i++)
+    n += snprintf(buf + n, len - n, i ? ",%lu" : "%lu",
+                  (unsigned long)stats.bins[i]);
+  if (n < 0)
+    return 0;
+  return (size_t)n < len ? (size_t)n : len - 1;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file sof_sync.h
+ * @brief Interrogation ADB calée sur les trames USB (SOF).
+ * @part of Apple-ADB-Ressurector
+ *
+ * Sans synchronisation, le rapport issu d'un cycle d'interrogation attend
+ * dans le point d'accès clavier un temps quelconque avant le jeton IN de
+ * l'hôte, jusqu'à un intervalle complet. Les SOF (1 kHz en pleine vitesse)
+ * servent ici de base de temps : chaque cycle démarre de façon à se terminer
+ * juste avant le prochain jeton IN du clavier.
+ *
+ * La position du jeton IN dans la trame est apprise à chaque rapport
+ * enlevé par l'hôte, de même que l'intervalle entre jetons : l'hôte ne
+ * respecte pas toujours le bInterval déclaré (Linux et Windows l'arrondissent
+ * à une puissance de deux), et un rappel DataIn ne suit que les jetons ayant
+ * trouvé un rapport. L'intervalle retenu découle donc du PGCD des écarts, en
+ * trames, entre rappels successifs, borné par le bInterval déclaré
+ * (HID_FS_BINTERVAL sur STM32) qui sert seul avant le premier écart. L'avance du démarrage suit la durée mesurée des cycles
+ * ayant produit un rapport (montée immédiate, descente lissée). Le délai
+ * événement d'entrée → jeton IN est relevé dans un histogramme.
+ *
+ * Les entrées sof_sync_frame() et sof_sync_in_token() sont appelées sous
+ * interruption (pile USB) ; le reste depuis la boucle principale.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SOF_SYNC_H
+#define SOF_SYNC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define SOF_SYNC_FRAME_US 1000 /**< Période des SOF (pleine vitesse). */
+/** bInterval déclaré par défaut du point d'accès clavier, en trames. */
+#define SOF_SYNC_INTERVAL_FRAMES 1
+/** Marge (µs) entre la fin d'un cycle et le jeton IN visé. */
+#define SOF_SYNC_GUARD_US 100
+/** Position initiale (µs) du jeton IN après le SOF, avant apprentissage. */
+#define SOF_SYNC_IN_PHASE_US 50
+/** Base de temps perdue sans SOF depuis ce délai (µs) : suspension, câble. */
+#define SOF_SYNC_LOST_US 3000
+#define SOF_SYNC_BIN_US 500 /**< Largeur d'une classe de l'histogramme. */
+#define SOF_SYNC_BINS 16    /**< Classes ; la dernière cumule le reste. */
+
+/**
+ * @struct sof_sync_stats
+ * @brief État de la synchronisation et distribution événement → jeton IN.
+ */
+struct sof_sync_stats {
+  uint32_t frames;      /**< SOF reçus. */
+  uint32_t in_phase_us; /**< Position apprise du jeton IN dans la trame. */
+  uint32_t interval_frames; /**< Intervalle retenu entre jetons IN. */
+  uint32_t cycle_us;    /**< Durée estimée d'un cycle produisant un rapport. */
+  uint32_t overruns;    /**< Cycles plus longs que l'avance prévue. */
+  uint32_t count;       /**< Délais mesurés. */
+  uint32_t mean_us;     /**< Délai moyen événement → jeton IN. */
+  uint32_t max_us;      /**< Délai maximal. */
+  uint32_t bins[SOF_SYNC_BINS]; /**< Histogramme par SOF_SYNC_BIN_US. */
+};
+
+/**
+ * @brief Remet la base de temps et les mesures à zéro (synchronisation
+ * activée).
+ */
+void sof_sync_reset();
+
+/**
+ * @brief Active les SOF de la pile USB de la carte (STM32) ; sans effet
+ * ailleurs.
+ */
+void sof_sync_begin();
+
+/**
+ * @brief Fixe le bInterval déclaré du point d'accès clavier (appelé par
+ * sof_sync_begin() sur STM32) ; conservé par sof_sync_reset().
+ */
+void sof_sync_set_declared_interval(uint32_t frames);
+
+/** @brief Active ou désactive le calage des cycles sur les SOF. */
+void sof_sync_set_enabled(bool enabled);
+
+/** @brief Calage demandé (même sans SOF reçus). */
+bool sof_sync_enabled();
+
+/**
+ * @brief Signale un SOF (sous interruption).
+ * @param now_us Horodatage du SOF en microsecondes.
+ */
+void sof_sync_frame(uint32_t now_us);
+
+/**
+ * @brief Signale un rapport clavier enlevé par l'hôte (sous interruption).
+ * @param now_us Horodatage du jeton IN en microsecondes.
+ */
+void sof_sync_in_token(uint32_t now_us);
+
+/**
+ * @brief Signale un rapport clavier remis au point d'accès.
+ *
+ * Ouvre la mesure du délai jusqu'au jeton IN si aucune n'est en cours.
+ *
+ * @param event_us Horodatage de l'événement d'entrée à l'origine du
+ * rapport (input_event.timestamp_us).
+ */
+void sof_sync_note_report(uint32_t event_us);
+
+/**
+ * @brief Signale la fin d'un cycle d'interrogation.
+ *
+ * Seuls les cycles ayant remis un rapport clavier ajustent l'avance.
+ *
+ * @param duration_us Durée du cycle, du démarrage au dernier rapport remis.
+ */
+void sof_sync_note_cycle(uint32_t duration_us);
+
+/**
+ * @brief Indique si le prochain cycle peut être calé : synchronisation
+ * activée et SOF reçu depuis moins de SOF_SYNC_LOST_US.
+ *
+ * @param now_us Temps courant en microsecondes.
+ */
+bool sof_sync_locked(uint32_t now_us);
+
+/**
+ * @brief Instant de démarrage du prochain cycle.
+ *
+ * Premier démarrage au plus tôt à `earliest_us` qui termine le cycle
+ * SOF_SYNC_GUARD_US avant un jeton IN du clavier.
+ *
+ * @param earliest_us Démarrage au plus tôt (rythme de power_manager).
+ * @return Instant de démarrage en microsecondes.
+ */
+uint32_t sof_sync_next_start(uint32_t earliest_us);
+
+/** @brief État et distribution des délais. */
+sof_sync_stats sof_sync_get_stats();
+
+/**
+ * @brief Formate l'état sur une ligne (commande `s`).
+ * @return Nombre de caractères écrits.
+ */
+size_t sof_sync_format(char *buf, size_t len);
+
+#endif // SOF_SYNC_H
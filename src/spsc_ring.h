@@ -0,0 +1,130 @@
+/**
+ * @file spsc_ring.h
+ * @brief File circulaire sans verrou, un producteur / un consommateur.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Le producteur n'écrit que `head`, le consommateur n'écrit que `tail` :
+ * aucune section critique n'est nécessaire, la file peut donc relier deux
+ * cœurs (ESP32) ou une interruption et la boucle principale (STM32) sans que
+ * le producteur soit jamais bloqué par le consommateur. Les index de chaque
+ * côté sont placés sur des lignes de cache distinctes.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Taille d'une ligne de cache de données.
+ *
+ * Les Cortex-M3/M4 du projet n'ont pas de cache de données : inutile de
+ * gaspiller de la RAM en remplissage sur STM32.
+ */
+#ifndef SPSC_CACHE_LINE
+#if defined(ARDUINO_ARCH_ESP32)
+#define SPSC_CACHE_LINE 32
+#elif defined(ARDUINO_ARCH_STM32)
+#define SPSC_CACHE_LINE 4
+#else
+#define SPSC_CACHE_LINE 64
+#endif
+#endif
+
+/**
+ * @class SpscRing
+ * @brief File circulaire de capacité fixe (puissance de deux).
+ *
+ * @tparam T Type des éléments (copiable).
+ * @tparam N Capacité de la file, puissance de deux.
+ */
+template <typename T, uint32_t N> class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "La capacité doit être une puissance de deux");
+
+public:
+  /**
+   * @brief Ajoute un élément (côté producteur uniquement).
+   *
+   * @param item Élément à ajouter.
+   * @return true si l'élément a été ajouté, false si la file est pleine.
+   */
+  bool push(const T &item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t used = head - tail_.load(std::memory_order_acquire);
+    if (used >= N) {
+      overflows_.store(overflows_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+      return false;
+    }
+
+    items_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+
+    if (used + 1 > high_water_.load(std::memory_order_relaxed))
+      high_water_.store(used + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Retire l'élément le plus ancien (côté consommateur uniquement).
+   *
+   * @param item Destination de l'élément retiré.
+   * @return true si un élément a été retiré, false si la file est vide.
+   */
+  bool pop(T &item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+      return false;
+
+    item = items_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Indique si la file est vide (valeur indicative hors consommateur).
+   */
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Nombre d'éléments en attente (valeur indicative).
+   */
+  uint32_t size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+
+  /** @brief Nombre d'éléments refusés faute de place. */
+  uint32_t overflows() const {
+    return overflows_.load(std::memory_order_relaxed);
+  }
+
+  /** @brief Remplissage maximal observé. */
+  uint32_t highWater() const {
+    return high_water_.load(std::memory_order_relaxed);
+  }
+
+  /** @brief Capacité de la file. */
+  static constexpr uint32_t capacity() { return N; }
+
+private:
+  // Côté producteur
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> overflows_{0};
+  std::atomic<uint32_t> high_water_{0};
+  // Côté consommateur
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> tail_{0};
+  alignas(SPSC_CACHE_LINE) T items_[N];
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,226 @@
+/**
+ * @file status_display.cpp
+ * @brief Implémentation de l'écran d'état.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "status_display.h"
+#include "input_events.h"
+#include <cstdio>
+#include <cstring>
+
+// Police 5×7 en colonnes (bit 0 en haut), de ' ' (0x20) à '_' (0x5F) ; les
+// minuscules sont affichées en majuscules.
+static const uint8_t font[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E},
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+    {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x41, 0x22, 0x14, 0x08, 0x00}, {0x02, 0x01, 0x51, 0x09, 0x06},
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E},
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41},
+    {0x7F, 0x09, 0x09, 0x01, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x32},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x04, 0x02, 0x7F},
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03},
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x00, 0x7F, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x41, 0x41, 0x7F, 0x00, 0x00},
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40}};
+
+#define DIRTY_NONE 0xFF
+
+static uint8_t framebuffer[DISPLAY_PAGES * DISPLAY_WIDTH];
+// Plage de colonnes modifiées par page (DIRTY_NONE : page à jour)
+static uint8_t dirty_lo[DISPLAY_PAGES];
+static uint8_t dirty_hi[DISPLAY_PAGES];
+static uint8_t next_page = 0;
+static const display_panel *panel = nullptr;
+static uint32_t last_render_ms = 0;
+static bool rendered = false;
+static uint32_t transfers = 0;
+
+static void mark(uint8_t page, uint8_t x) {
+  if (dirty_lo[page] == DIRTY_NONE) {
+    dirty_lo[page] = dirty_hi[page] = x;
+    return;
+  }
+  if (x < dirty_lo[page])
+    dirty_lo[page] = x;
+  if (x > dirty_hi[page])
+    dirty_hi[page] = x;
+}
+
+static void put_column(uint8_t page, uint8_t x, uint8_t bits) {
+  uint8_t &cell = framebuffer[page * DISPLAY_WIDTH + x];
+  if (cell == bits)
+    return;
+  cell = bits;
+  mark(page, x);
+}
+
+/**
+ * @brief Écrit une ligne de texte, complétée par des espaces.
+ */
+static void draw_line(uint8_t page, const char *text) {
+  bool ended = false;
+  for (uint8_t c = 0; c < DISPLAY_COLUMNS; c++) {
+    char ch = ended ? ' ' : text[c];
+    if (ch == '\0') {
+      ended = true;
+      ch = ' ';
+    }
+    if (ch >= 'a' && ch <= 'z')
+      ch -= 'a' - 'A';
+    if (ch < 0x20 || ch > 0x5F)
+      ch = '?';
+
+    const uint8_t *glyph = font[ch - 0x20];
+    uint8_t x = c * 6;
+    for (uint8_t i = 0; i < 5; i++)
+      put_column(page, x + i, glyph[i]);
+    put_column(page, x + 5, 0);
+  }
+}
+
+static const char *link_name(uint8_t link) {
+  switch (link) {
+  case DISPLAY_LINK_READY:
+    return "PRET";
+  case DISPLAY_LINK_SUSPENDED:
+    return "SUSPENDU";
+  default:
+    return "ATTENTE";
+  }
+}
+
+// Compteur sur quatre caractères au plus : « 999+ » au-delà, pour que la
+// ligne des erreurs tienne dans DISPLAY_COLUMNS
+static void format_count(char (&out)[5], uint32_t count) {
+  if (count > 999)
+    memcpy(out, "999+", sizeof(out));
+  else
+    snprintf(out, sizeof(out), "%u", (unsigned)count);
+}
+
+bool status_display_begin(const display_panel *p) {
+  memset(framebuffer, 0, sizeof(framebuffer));
+  for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+    dirty_lo[page] = 0;
+    dirty_hi[page] = DISPLAY_WIDTH - 1;
+  }
+  next_page = 0;
+  rendered = false;
+  transfers = 0;
+
+  panel = p;
+  if (panel != nullptr && !panel->begin())
+    panel = nullptr;
+  return panel != nullptr;
+}
+
+bool status_display_enabled() { return panel != nullptr; }
+
+bool status_display_due(uint32_t now_ms) {
+  return panel != nullptr &&
+         (!rendered || now_ms - last_render_ms >= DISPLAY_REFRESH_MS);
+}
+
+void status_display_render(const display_status &status, uint32_t now_ms) {
+  char line[DISPLAY_COLUMNS + 1];
+  rendered = true;
+  last_render_ms = now_ms;
+
+  draw_line(0, "ADB RESSURECTOR");
+  snprintf(line, sizeof(line), "KBD %s MSE %s TAB %s",
+           status.present[ADB_STATS_KEYBOARD] ? "OK" : "--",
+           status.present[ADB_STATS_MOUSE] ? "OK" : "--",
+           status.present[ADB_STATS_TABLET] ? "OK" : "--");
+  draw_line(1, line);
+
+  for (uint8_t i = 0; i < DISPLAY_TRANSPORT_MAX; i++) {
+    if (i < status.transport_count)
+      snprintf(line, sizeof(line), "%-4s %s", status.transport_name[i],
+               link_name(status.transport_link[i]));
+    else
+      snprintf(line, sizeof(line), "%s", i == 0 ? "HID --" : "");
+    draw_line(2 + i, line);
+  }
+
+  snprintf(line, sizeof(line), "LED %s %s %s",
+           status.leds & INPUT_LED_NUM ? "NUM" : "---",
+           status.leds & INPUT_LED_CAPS ? "CAPS" : "----",
+           status.leds & INPUT_LED_SCROLL ? "SCRL" : "----");
+  draw_line(4, line);
+  snprintf(line, sizeof(line), "POLL %u HZ", (unsigned)status.poll_hz);
+  draw_line(5, line);
+  char kbd[5], mse[5], tab[5];
+  format_count(kbd, status.errors[ADB_STATS_KEYBOARD]);
+  format_count(mse, status.errors[ADB_STATS_MOUSE]);
+  format_count(tab, status.errors[ADB_STATS_TABLET]);
+  snprintf(line, sizeof(line), "ERR K%s M%s T%s", kbd, mse, tab);
+  draw_line(6, line);
+  snprintf(line, sizeof(line), "JOY %s ERR %lu",
+           status.present[ADB_STATS_JOYSTICK] ? "OK" : "--",
+           (unsigned long)status.errors[ADB_STATS_JOYSTICK]);
+  draw_line(7, line);
+}
+
+void status_display_service() {
+  if (panel == nullptr || panel->busy())
+    return;
+
+  for (uint8_t n = 0; n < DISPLAY_PAGES; n++) {
+    uint8_t page = (next_page + n) % DISPLAY_PAGES;
+    if (dirty_lo[page] == DIRTY_NONE)
+      continue;
+
+    uint8_t lo = dirty_lo[page];
+    uint8_t len = dirty_hi[page] - lo + 1;
+    // Page libérée avant le transfert : un dessin concurrent la remarque
+    dirty_lo[page] = DIRTY_NONE;
+    dirty_hi[page] = 0;
+    if (!panel->write(page, lo, framebuffer + page * DISPLAY_WIDTH + lo,
+                      len)) {
+      mark(page, lo);
+      mark(page, lo + len - 1);
+      return;
+    }
+    transfers++;
+    next_page = (page + 1) % DISPLAY_PAGES;
+    return;
+  }
+}
+
+const uint8_t *status_display_framebuffer() { return framebuffer; }
+
+uint8_t status_display_dirty_pages() {
+  uint8_t count = 0;
+  for (uint8_t page = 0; page < DISPLAY_PAGES; page++)
+    count += dirty_lo[page] != DIRTY_NONE;
+  return count;
+}
+
+uint32_t status_display_transfers() { return transfers; }
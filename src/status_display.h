@@ -0,0 +1,133 @@
+/**
+ * @file status_display.h
+ * @brief Écran d'état : image en RAM, zones modifiées et transferts non
+ * bloquants.
+ * @part of Apple-ADB-Ressurector
+ *
+ * L'état (périphériques présents, transports, LEDs, cadence d'interrogation,
+ * erreurs du bus) est dessiné en texte 5×7 dans une image de 128×64 points
+ * organisée en pages de 8 lignes, comme la mémoire d'un contrôleur SSD1306.
+ * Seuls les octets qui changent marquent leur page comme modifiée, avec la
+ * plage de colonnes concernée.
+ *
+ * Le dessin est limité à DISPLAY_REFRESH_MS ; status_display_service() ne
+ * fait qu'engager au plus un transfert de page vers l'écran et rend la main
+ * aussitôt (DMA sur STM32). L'interrogation ADB n'attend donc jamais
+ * l'écran. Une page redessinée pendant son transfert reste marquée et sera
+ * renvoyée.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef STATUS_DISPLAY_H
+#define STATUS_DISPLAY_H
+
+#include "adb_stats.h"
+#include <cstdint>
+
+#define DISPLAY_WIDTH 128 /**< Colonnes de l'écran. */
+#define DISPLAY_PAGES 8   /**< Pages de 8 lignes (64 lignes). */
+#define DISPLAY_COLUMNS 21 /**< Caractères par ligne (6 colonnes chacun). */
+#define DISPLAY_REFRESH_MS 100 /**< Délai minimal entre deux dessins. */
+#define DISPLAY_TRANSPORT_MAX 2 /**< Transports affichés. */
+
+/**
+ * @enum display_link
+ * @brief État d'un transport HID affiché.
+ */
+enum display_link : uint8_t {
+  DISPLAY_LINK_DOWN = 0,  /**< Hôte absent ou non prêt. */
+  DISPLAY_LINK_READY,     /**< Prêt à recevoir des rapports. */
+  DISPLAY_LINK_SUSPENDED  /**< Suspendu par l'hôte. */
+};
+
+/**
+ * @struct display_status
+ * @brief Informations affichées.
+ */
+struct display_status {
+  bool present[ADB_STATS_DEVICE_COUNT]; /**< Périphériques détectés. */
+  uint8_t transport_count;
+  const char *transport_name[DISPLAY_TRANSPORT_MAX];
+  uint8_t transport_link[DISPLAY_TRANSPORT_MAX]; /**< Voir display_link. */
+  uint8_t leds;     /**< INPUT_LED_NUM, INPUT_LED_CAPS, INPUT_LED_SCROLL. */
+  uint16_t poll_hz; /**< Cycles d'interrogation par seconde. */
+  uint32_t errors[ADB_STATS_DEVICE_COUNT]; /**< Erreurs de bit et collisions. */
+};
+
+/**
+ * @struct display_panel
+ * @brief Écran physique : reçoit une plage de colonnes d'une page.
+ *
+ * `write` engage le transfert et rend la main ; les données restent lues
+ * dans l'image jusqu'à ce que `busy` redevienne faux.
+ */
+struct display_panel {
+  const char *name;
+  /** Initialise le contrôleur (au démarrage, peut attendre). */
+  bool (*begin)();
+  /** Transfert en cours. */
+  bool (*busy)();
+  /** Engage l'écriture de `len` colonnes à partir de (page, column). */
+  bool (*write)(uint8_t page, uint8_t column, const uint8_t *data,
+                uint8_t len);
+};
+
+/**
+ * @brief Efface l'image et choisit l'écran (nullptr : affichage désactivé).
+ *
+ * L'image entière est marquée pour effacer l'écran au premier service.
+ *
+ * @return false si l'écran ne répond pas (affichage désactivé).
+ */
+bool status_display_begin(const display_panel *panel);
+
+/** @brief Affichage actif. */
+bool status_display_enabled();
+
+/**
+ * @brief Indique si un nouveau dessin est permis (DISPLAY_REFRESH_MS).
+ * @param now_ms Temps courant en millisecondes.
+ */
+bool status_display_due(uint32_t now_ms);
+
+/**
+ * @brief Dessine l'état dans l'image et marque les zones modifiées.
+ * @param now_ms Temps courant en millisecondes.
+ */
+void status_display_render(const display_status &status, uint32_t now_ms);
+
+/**
+ * @brief Engage le transfert de la prochaine page modifiée si l'écran est
+ * libre. Ne bloque jamais.
+ */
+void status_display_service();
+
+/** @brief Image (DISPLAY_PAGES pages de DISPLAY_WIDTH octets). */
+const uint8_t *status_display_framebuffer();
+
+/** @brief Nombre de pages restant à transférer. */
+uint8_t status_display_dirty_pages();
+
+/** @brief Transferts engagés depuis status_display_begin(). */
+uint32_t status_display_transfers();
+
+extern const display_panel display_panel_ssd1306; /**< SSD1306 I2C. */
+extern const display_panel display_panel_native;  /**< Image seule. */
+
+/** @brief Image reçue par l'écran natif. */
+const uint8_t *display_panel_native_frame();
+
+/** @brief Octets reçus par l'écran natif. */
+uint32_t display_panel_native_bytes();
+
+/** @brief Simule un transfert en cours sur l'écran natif. */
+void display_panel_native_set_busy(bool busy);
+
+/** @brief Vide l'écran natif et ses compteurs. */
+void display_panel_native_reset();
+
+#endif // STATUS_DISPLAY_H
@@ -0,0 +1,41 @@
+/**
+ * @file text_console.h
+ * @brief Traces texte du port série, muettes lorsque le protocole de
+ * contrôle binaire occupe le port.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Les réponses du protocole (ctrl_proto.h) partent en plusieurs passes de
+ * la boucle, au gré de la place en émission, et les traces peuvent venir
+ * d'autres tâches (rappels Bluetooth, tâche ADB sur ESP32). Toute trace
+ * passe donc par `Console`, qui n'écrit rien dès que ctrl_proto_owns_port()
+ * est vrai : aucun octet de texte ne peut s'intercaler dans une trame.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef TEXT_CONSOLE_H
+#define TEXT_CONSOLE_H
+
+#include "ctrl_proto.h"
+#include <Arduino.h>
+
+/**
+ * @struct TextConsole
+ * @brief Même interface d'impression que Serial, filtrée.
+ */
+struct TextConsole {
+  template <typename... Args> size_t print(Args... args) {
+    return ctrl_proto_owns_port() ? 0 : Serial.print(args...);
+  }
+  template <typename... Args> size_t println(Args... args) {
+    return ctrl_proto_owns_port() ? 0 : Serial.println(args...);
+  }
+};
+
+/** Traces texte (définie dans main.cpp). */
+extern TextConsole Console;
+
+#endif // TEXT_CONSOLE_H
@@ -2,8 +2,29 @@
 #pragma GCC diagnostic ignored "-Wc++11-extensions"
 
 #include <unity.h>
+#include <cstring>
+#include <thread>
 #include "adb_devices.h"
+#include "adb_joystick.h"
+#include "adb_phy.h"
+#include "adb_sniffer.h"
+#include "adb_stats.h"
+#include "adb_tablet.h"
+#include "ble_link.h"
+#include "board.h"
+#include "ctrl_proto.h"
+#include "event_trace.h"
 #include "hid_keyboard.h"
+#include "hid_mouse.h"
+#include "hid_reports.h"
+#include "hid_transport.h"
+#include "host_suspend.h"
+#include "input_events.h"
+#include "key_queue.h"
+#include "key_remap.h"
+#include "power_manager.h"
+#include "sof_sync.h"
+#include "status_display.h"
 
 // void setUp(void) {
 // // set stuff up here
@@ -101,6 +122,1290 @@ void test_adb_command() {
     TEST_ASSERT_EQUAL(1, cmd_stru.reg);
 }
 
+void test_adb_stats_classify() {
+    TEST_ASSERT_EQUAL(ADB_RESULT_OK, adb_stats_classify(false, 4000, false));
+    TEST_ASSERT_EQUAL(ADB_RESULT_TIMEOUT, adb_stats_classify(true, 1900, false));
+    TEST_ASSERT_EQUAL(ADB_RESULT_BIT_TIMING, adb_stats_classify(true, 2800, false));
+    TEST_ASSERT_EQUAL(ADB_RESULT_COLLISION, adb_stats_classify(true, 2800, true));
+}
+
+void test_adb_stats_retry_and_backoff() {
+    adb_stats_reset();
+
+    // Les timeouts ne sont jamais relancés
+    TEST_ASSERT_FALSE(adb_stats_should_retry(ADB_STATS_KEYBOARD, ADB_RESULT_TIMEOUT, 0, 0));
+
+    // Erreur transitoire : relance tant que le budget le permet
+    adb_stats_record(ADB_STATS_KEYBOARD, ADB_RESULT_BIT_TIMING);
+    TEST_ASSERT_TRUE(adb_stats_should_retry(ADB_STATS_KEYBOARD, ADB_RESULT_BIT_TIMING, 0, 500));
+    TEST_ASSERT_FALSE(adb_stats_should_retry(ADB_STATS_KEYBOARD, ADB_RESULT_BIT_TIMING, ADB_RETRY_MAX, 500));
+    TEST_ASSERT_FALSE(adb_stats_should_retry(ADB_STATS_KEYBOARD, ADB_RESULT_BIT_TIMING, 0, ADB_POLL_BUDGET_US));
+
+    // Erreur persistante : plus de relance, les cycles suivants sont sautés
+    for (uint8_t i = 1; i < ADB_ERROR_PERSISTENT; i++)
+        adb_stats_record(ADB_STATS_KEYBOARD, ADB_RESULT_COLLISION);
+    TEST_ASSERT_FALSE(adb_stats_should_retry(ADB_STATS_KEYBOARD, ADB_RESULT_COLLISION, 0, 0));
+    TEST_ASSERT_FALSE(adb_stats_should_poll(ADB_STATS_KEYBOARD));
+    TEST_ASSERT_FALSE(adb_stats_should_poll(ADB_STATS_KEYBOARD));
+    TEST_ASSERT_TRUE(adb_stats_should_poll(ADB_STATS_KEYBOARD));
+
+    // Une trame valide rétablit le rythme normal
+    adb_stats_record(ADB_STATS_KEYBOARD, ADB_RESULT_OK);
+    TEST_ASSERT_TRUE(adb_stats_should_poll(ADB_STATS_KEYBOARD));
+
+    const adb_device_stats* s = adb_stats_get(ADB_STATS_KEYBOARD);
+    TEST_ASSERT_EQUAL(1, s->frames_ok);
+    TEST_ASSERT_EQUAL(1, s->bit_errors);
+    TEST_ASSERT_EQUAL(ADB_ERROR_PERSISTENT - 1, s->collisions);
+    TEST_ASSERT_EQUAL(1, s->backoffs);
+}
+
+void test_adb_stats_format() {
+    adb_stats_reset();
+    adb_stats_record(ADB_STATS_MOUSE, ADB_RESULT_OK);
+
+    char line[224];
+    adb_stats_format(line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING(
+        "ADB kbd ok=0 to=0 bt=0 col=0 rt=0 bo=0 | mse ok=1 to=0 bt=0 col=0 rt=0 bo=0"
+        " | tab ok=0 to=0 bt=0 col=0 rt=0 bo=0 | joy ok=0 to=0 bt=0 col=0 rt=0 bo=0",
+        line);
+}
+
+void test_input_event_ring_two_threads() {
+    const uint32_t count = 200000;
+    uint32_t overflows_before = input_event_overflows();
+    uint32_t rejected = 0;
+
+    // Producteur : décodage ADB, relance tant que la file est pleine
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count;) {
+            input_event event = {i, INPUT_EVENT_MOUSE, (uint8_t)i, 1, -1};
+            if (input_event_push(event))
+                i++;
+            else
+                rejected++;
+        }
+    });
+
+    // Consommateur : constructeur de rapports, ordre strict attendu
+    uint32_t received = 0;
+    bool ordered = true;
+    while (received < count) {
+        input_event event;
+        if (!input_event_pop(event))
+            continue;
+        if (event.timestamp_us != received || event.code != (uint8_t)received ||
+            event.dx != 1 || event.dy != -1)
+            ordered = false;
+        received++;
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL(count, received);
+    TEST_ASSERT_EQUAL(0, input_event_pending());
+    TEST_ASSERT_EQUAL(rejected, input_event_overflows() - overflows_before);
+    TEST_ASSERT_LESS_OR_EQUAL(INPUT_EVENT_RING_SIZE, input_event_high_water());
+}
+
+static uint32_t transport_completions = 0;
+
+static void count_completion(const hid_transport*, uint8_t) {
+    transport_completions++;
+}
+
+void test_hid_transport_native() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    hid_transport_set_callbacks(nullptr, count_completion);
+    transport_completions = 0;
+
+    TEST_ASSERT_FALSE(hid_transport_carries(HID_REPORT_JOYSTICK));
+    TEST_ASSERT_TRUE(hid_transport_register(&hid_transport_native));
+    TEST_ASSERT_TRUE(hid_transport_register(&hid_transport_native));
+    // Sans fonction `carries`, tous les types de rapport sont portés
+    TEST_ASSERT_TRUE(hid_transport_carries(HID_REPORT_JOYSTICK));
+
+    uint8_t report[8] = {KEY_MOD_LSHIFT, 0, 0x04, 0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(1, hid_transport_submit(HID_REPORT_KEYBOARD, report, sizeof(report)));
+
+    uint8_t len = 0;
+    const uint8_t* last = hid_transport_native_last(HID_REPORT_KEYBOARD, &len);
+    TEST_ASSERT_EQUAL(8, len);
+    TEST_ASSERT_EQUAL_MEMORY(report, last, sizeof(report));
+    TEST_ASSERT_EQUAL(1, transport_completions);
+
+    // Transport indisponible : le rapport est compté comme perdu
+    hid_transport_native_set_ready(false);
+    TEST_ASSERT_EQUAL(0, hid_transport_submit(HID_REPORT_MOUSE, report, 4));
+    TEST_ASSERT_EQUAL(0, hid_transport_native_count(HID_REPORT_MOUSE));
+    TEST_ASSERT_EQUAL(1, hid_transport_dropped(HID_REPORT_MOUSE));
+    TEST_ASSERT_EQUAL(1, hid_transport_sent(HID_REPORT_KEYBOARD));
+
+    hid_transport_set_callbacks(nullptr, nullptr);
+    hid_transport_clear();
+}
+
+// Chiffres ADB d'un code-barres, chaque caractère répété deux fois
+static const uint8_t scan_digits[] = {0x1D, 0x12, 0x13, 0x14, 0x15,
+                                      0x17, 0x16, 0x1A, 0x1C, 0x19};
+static uint32_t scan_received = 0;
+static bool scan_ordered = true;
+
+static uint8_t scan_char(uint32_t n) { return scan_digits[(n / 2) % 10]; }
+
+// Hôte virtuel : un rapport clavier par trame, comme un point d'accès USB
+static void scan_completion(const hid_transport*, uint8_t kind) {
+    if (kind != HID_REPORT_KEYBOARD)
+        return;
+    const uint8_t* report = hid_transport_native_last(HID_REPORT_KEYBOARD, nullptr);
+    uint8_t expected = scan_received % 2 == 0
+                           ? ADBKeymap::toHID(scan_char(scan_received / 2))
+                           : 0;
+    scan_ordered = scan_ordered && report[2] == expected && report[3] == 0;
+    scan_received++;
+    hid_transport_native_set_busy(true);
+}
+
+void test_key_queue_scanner_throughput() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    key_queue_reset();
+    hid_transport_register(&hid_transport_native);
+    hid_transport_set_callbacks(nullptr, scan_completion);
+    scan_received = 0;
+    scan_ordered = true;
+    uint32_t overflows_before = input_event_overflows();
+
+    // 1 000 caractères, un par trame : deux fois plus vite que l'hôte ne
+    // peut les recevoir (appui et relâchement dans deux rapports)
+    const uint32_t chars = 1000;
+    uint32_t produced = 0;
+    uint32_t frames = 0;
+    while (scan_received < 2 * chars && frames < 4 * chars) {
+        // Lecture clavier reportée tant que la file des événements est pleine
+        if (produced < chars && INPUT_EVENT_RING_SIZE - input_event_pending() >= 4) {
+            input_event down = {frames, INPUT_EVENT_KEY_DOWN, scan_char(produced), 0, 0};
+            input_event up = {frames, INPUT_EVENT_KEY_UP, scan_char(produced), 0, 0};
+            input_event_push(down);
+            input_event_push(up);
+            produced++;
+        }
+        hid_transport_native_set_busy(false);
+        hid_reports_service(frames);
+        frames++;
+    }
+
+    // Chaque trame porte un rapport : débit maximal accepté par l'hôte
+    TEST_ASSERT_TRUE(scan_ordered);
+    TEST_ASSERT_EQUAL(2 * chars, scan_received);
+    TEST_ASSERT_EQUAL(2 * chars, frames);
+    TEST_ASSERT_EQUAL(0, key_queue_pending());
+    TEST_ASSERT_EQUAL(0, input_event_pending());
+    TEST_ASSERT_EQUAL(overflows_before, input_event_overflows());
+
+    const key_queue_stats& stats = key_queue_get_stats();
+    TEST_ASSERT_EQUAL(2 * chars, stats.sent);
+    TEST_ASSERT_EQUAL(0, stats.overflows);
+    TEST_ASSERT_GREATER_THAN(0, stats.refused);
+    TEST_ASSERT_GREATER_THAN(KEY_QUEUE_SIZE / 2, stats.high_water);
+    TEST_ASSERT_LESS_OR_EQUAL(KEY_QUEUE_SIZE, stats.high_water);
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_KEYBOARD));
+
+    hid_transport_set_callbacks(nullptr, nullptr);
+    hid_transport_clear();
+}
+
+void test_key_queue_overflow() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    key_queue_reset();
+    hid_transport_register(&hid_transport_native);
+
+    // Hôte muet : la file garde les KEY_QUEUE_SIZE premiers rapports
+    hid_transport_native_set_busy(true);
+    hid_key_report report = {0};
+    for (uint8_t i = 0; i < KEY_QUEUE_SIZE + 3; i++) {
+        report.keys[0] = 0x04 + i;
+        hid_keyboard_send_report(&report, 0);
+    }
+    TEST_ASSERT_EQUAL(KEY_QUEUE_SIZE, key_queue_pending());
+    TEST_ASSERT_EQUAL(3, key_queue_get_stats().overflows);
+    TEST_ASSERT_EQUAL(0, hid_transport_native_count(HID_REPORT_KEYBOARD));
+
+    // Retour de l'hôte : rapports remis dans l'ordre, aucun compté perdu
+    hid_transport_native_set_busy(false);
+    TEST_ASSERT_EQUAL(KEY_QUEUE_SIZE, key_queue_pump());
+    TEST_ASSERT_EQUAL(KEY_QUEUE_SIZE,
+                      hid_transport_native_count(HID_REPORT_KEYBOARD));
+    const uint8_t* last = hid_transport_native_last(HID_REPORT_KEYBOARD, nullptr);
+    TEST_ASSERT_EQUAL(0x04 + KEY_QUEUE_SIZE - 1, last[2]);
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_KEYBOARD));
+
+    char line[96];
+    key_queue_format(line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("KEYQ q=0 max=32 sent=32 refus=35 ovf=3", line);
+
+    hid_transport_clear();
+    key_queue_reset();
+}
+
+// Deux hôtes (USB et Bluetooth) enregistrant la touche de chaque rapport
+struct key_recorder {
+    uint8_t keys[16];
+    uint8_t count;
+    bool ready;
+    bool busy;
+};
+static key_recorder recorders[2];
+
+template <int N> static bool recorder_ready() { return recorders[N].ready; }
+
+template <int N>
+static bool recorder_send(uint8_t kind, const uint8_t* report, uint8_t) {
+    key_recorder& rec = recorders[N];
+    if (rec.busy || kind != HID_REPORT_KEYBOARD || rec.count >= sizeof(rec.keys))
+        return false;
+    rec.keys[rec.count++] = report[2];
+    return true;
+}
+
+static const hid_transport recorder_usb = {"usb", recorder_ready<0>,
+                                           recorder_send<0>, nullptr, nullptr};
+static const hid_transport recorder_ble = {"ble", recorder_ready<1>,
+                                           recorder_send<1>, nullptr, nullptr};
+
+void test_key_queue_per_transport_delivery() {
+    hid_transport_clear();
+    key_queue_reset();
+    for (key_recorder& rec : recorders)
+        rec = {{0}, 0, true, false};
+    hid_transport_register(&recorder_usb);
+    hid_transport_register(&recorder_ble);
+
+    // Le second hôte refuse : appui et relâchement restent en file pour lui
+    recorders[1].busy = true;
+    hid_key_report report = {0};
+    for (uint8_t i = 0; i < 2; i++) {
+        report.keys[0] = 0x04;
+        hid_keyboard_send_report(&report, 0);
+        report.keys[0] = 0;
+        hid_keyboard_send_report(&report, 0);
+    }
+    TEST_ASSERT_EQUAL(4, recorders[0].count);
+    TEST_ASSERT_EQUAL(0, recorders[1].count);
+    TEST_ASSERT_EQUAL(4, key_queue_pending());
+    TEST_ASSERT_EQUAL(0, key_queue_get_stats().sent);
+
+    // Reprise : le second hôte reçoit toute la suite, le premier aucun doublon
+    recorders[1].busy = false;
+    TEST_ASSERT_EQUAL(4, key_queue_pump());
+    TEST_ASSERT_EQUAL(0, key_queue_pending());
+    TEST_ASSERT_EQUAL(4, recorders[0].count);
+    TEST_ASSERT_EQUAL(4, recorders[1].count);
+    const uint8_t expected[] = {0x04, 0, 0x04, 0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, recorders[0].keys, 4);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, recorders[1].keys, 4);
+    TEST_ASSERT_EQUAL(4, key_queue_get_stats().sent);
+
+    // Un hôte indisponible ne retient pas l'autre et reprend à la tête
+    recorders[1].ready = false;
+    report.keys[0] = 0x05;
+    hid_keyboard_send_report(&report, 0);
+    report.keys[0] = 0;
+    hid_keyboard_send_report(&report, 0);
+    TEST_ASSERT_EQUAL(6, recorders[0].count);
+    TEST_ASSERT_EQUAL(0, key_queue_pending());
+    recorders[1].ready = true;
+    report.keys[0] = 0x06;
+    hid_keyboard_send_report(&report, 0);
+    TEST_ASSERT_EQUAL(7, recorders[0].count);
+    TEST_ASSERT_EQUAL(5, recorders[1].count);
+    TEST_ASSERT_EQUAL(0x06, recorders[1].keys[4]);
+    TEST_ASSERT_EQUAL(0, key_queue_pending());
+
+    // Aucun hôte prêt : les rapports attendent la reprise
+    recorders[0].ready = recorders[1].ready = false;
+    report.keys[0] = 0;
+    hid_keyboard_send_report(&report, 0);
+    TEST_ASSERT_EQUAL(1, key_queue_pending());
+    recorders[0].ready = recorders[1].ready = true;
+    TEST_ASSERT_EQUAL(1, key_queue_pump());
+    TEST_ASSERT_EQUAL(0, recorders[0].keys[7]);
+    TEST_ASSERT_EQUAL(0, recorders[1].keys[5]);
+
+    hid_transport_clear();
+    key_queue_reset();
+}
+
+// Composite USB : rapports clavier seulement
+static bool keyboard_only(uint8_t kind) { return kind == HID_REPORT_KEYBOARD; }
+
+static const hid_transport recorder_composite = {
+    "usb", recorder_ready<0>, recorder_send<0>, nullptr, nullptr, keyboard_only};
+
+static void push_key(uint8_t type, uint8_t code) {
+    input_event event = {0, type, code, 0, 0};
+    input_event_push(event);
+}
+
+void test_consumer_keys_follow_transports() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    key_queue_reset();
+    hid_transport_register(&hid_transport_native);
+
+    // Transport portant le Consumer Control : touches son et Power
+    push_key(INPUT_EVENT_KEY_DOWN, ADB_KEY_CODE_VOLUME_UP);
+    hid_reports_service(0);
+    const uint8_t* consumer = hid_transport_native_last(HID_REPORT_CONSUMER, nullptr);
+    TEST_ASSERT_EQUAL_HEX8(CONSUMER_USAGE_VOLUME_UP, consumer[0]);
+    push_key(INPUT_EVENT_KEY_UP, ADB_KEY_CODE_VOLUME_UP);
+    push_key(INPUT_EVENT_KEY_DOWN, INPUT_ADB_POWER_CODE);
+    hid_reports_service(1);
+    TEST_ASSERT_EQUAL_HEX8(CONSUMER_USAGE_POWER, consumer[0]);
+    push_key(INPUT_EVENT_KEY_UP, INPUT_ADB_POWER_CODE);
+    hid_reports_service(2);
+    TEST_ASSERT_EQUAL(0, consumer[0] | consumer[1]);
+    TEST_ASSERT_EQUAL(4, hid_transport_native_count(HID_REPORT_CONSUMER));
+    TEST_ASSERT_EQUAL(0, hid_transport_native_count(HID_REPORT_KEYBOARD));
+
+    // Composite USB : la touche reste dans le rapport clavier
+    hid_transport_clear();
+    key_queue_reset();
+    recorders[0] = {{0}, 0, true, false};
+    hid_transport_register(&recorder_composite);
+    push_key(INPUT_EVENT_KEY_DOWN, ADB_KEY_CODE_MUTE);
+    push_key(INPUT_EVENT_KEY_UP, ADB_KEY_CODE_MUTE);
+    hid_reports_service(3);
+    TEST_ASSERT_EQUAL(2, recorders[0].count);
+    TEST_ASSERT_EQUAL(ADBKeymap::toHID(ADB_KEY_CODE_MUTE), recorders[0].keys[0]);
+    TEST_ASSERT_EQUAL(0, recorders[0].keys[1]);
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_CONSUMER));
+
+    hid_transport_clear();
+    key_queue_reset();
+}
+
+// Rapports souris reçus par le transport natif (boutons, X, Y)
+static uint8_t mouse_log[8][3];
+static uint8_t mouse_logged = 0;
+
+static void log_mouse(const hid_transport*, uint8_t kind) {
+    if (kind != HID_REPORT_MOUSE || mouse_logged >= 8)
+        return;
+    memcpy(mouse_log[mouse_logged++],
+           hid_transport_native_last(HID_REPORT_MOUSE, nullptr), 3);
+}
+
+static void push_mouse(uint8_t button, int8_t dx, int8_t dy) {
+    input_event event = {0, INPUT_EVENT_MOUSE, button, dx, dy};
+    input_event_push(event);
+}
+
+void test_mouse_busy_endpoint_merges_moves() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    hid_transport_register(&hid_transport_native);
+    hid_transport_set_callbacks(nullptr, log_mouse);
+    mouse_logged = 0;
+
+    // Point d'accès occupé : bouton enfoncé, déplacements, relâchement puis
+    // un dernier déplacement et un nouvel appui
+    hid_transport_native_set_busy(true);
+    push_mouse(1, 1, 1);
+    push_mouse(1, 2, -3);
+    push_mouse(0, 0, 0);
+    push_mouse(0, 4, 0);
+    push_mouse(1, 0, 0);
+    hid_reports_service(0);
+    TEST_ASSERT_EQUAL(0, hid_transport_native_count(HID_REPORT_MOUSE));
+    // Deux rapports retenus au plus (appui déplacé, relâchement) : la suite
+    // attend dans la file des événements
+    TEST_ASSERT_EQUAL(2, input_event_pending());
+
+    // Point d'accès libéré : déplacements cumulés, relâchement conservé
+    hid_transport_native_set_busy(false);
+    hid_reports_service(1);
+    TEST_ASSERT_EQUAL(4, mouse_logged);
+    const uint8_t expected[4][3] = {
+        {1, 3, (uint8_t)-2}, {0, 0, 0}, {0, 4, 0}, {1, 0, 0}};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, mouse_log, sizeof(expected));
+    TEST_ASSERT_EQUAL(0, input_event_pending());
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_MOUSE));
+
+    // Cumul hors de l'étendue d'un rapport : le reste part ensuite
+    hid_transport_native_set_busy(true);
+    for (uint8_t i = 0; i < 3; i++)
+        push_mouse(1, 100, 0);
+    hid_reports_service(2);
+    hid_transport_native_set_busy(false);
+    hid_reports_service(3);
+    TEST_ASSERT_EQUAL(7, mouse_logged);
+    TEST_ASSERT_EQUAL(127, mouse_log[4][1]);
+    TEST_ASSERT_EQUAL(127, mouse_log[5][1]);
+    TEST_ASSERT_EQUAL(46, mouse_log[6][1]);
+
+    hid_transport_set_callbacks(nullptr, nullptr);
+    hid_transport_clear();
+}
+
+void test_power_manager_decay_and_wake() {
+    power_init(1000);
+    TEST_ASSERT_EQUAL(POWER_ACTIVE, power_update(1000 + POWER_IDLE_AFTER_MS - 1));
+    TEST_ASSERT_EQUAL(POLL_DELAY, power_poll_interval_ms());
+
+    TEST_ASSERT_EQUAL(POWER_IDLE, power_update(1000 + POWER_IDLE_AFTER_MS));
+    TEST_ASSERT_EQUAL(POWER_IDLE_POLL_MS, power_poll_interval_ms());
+
+    uint32_t sleep_at = 1000 + POWER_SLEEP_AFTER_MS;
+    TEST_ASSERT_EQUAL(POWER_SLEEP, power_update(sleep_at));
+    TEST_ASSERT_EQUAL(POWER_SLEEP_POLL_MS, power_poll_interval_ms());
+
+    // Première trame non vide : retour immédiat au rythme nominal
+    power_note_activity(sleep_at + 500);
+    TEST_ASSERT_EQUAL(POWER_ACTIVE, power_get_state());
+    TEST_ASSERT_EQUAL(POLL_DELAY, power_poll_interval_ms());
+
+    TEST_ASSERT_EQUAL(POWER_IDLE_AFTER_MS, power_time_in_state_ms(POWER_ACTIVE, sleep_at + 500));
+    TEST_ASSERT_EQUAL(POWER_SLEEP_AFTER_MS - POWER_IDLE_AFTER_MS, power_time_in_state_ms(POWER_IDLE, sleep_at + 500));
+    TEST_ASSERT_EQUAL(500, power_time_in_state_ms(POWER_SLEEP, sleep_at + 500));
+
+    // Part du temps en attente, mesurée depuis power_init()
+    power_init(0);
+    TEST_ASSERT_EQUAL(0, power_wait_permille(0));
+    for (uint8_t i = 0; i < 10; i++)
+        power_account_wait_us(POWER_SLEEP_POLL_MS * 1000 - 3000);
+    TEST_ASSERT_EQUAL(750, power_wait_permille(10 * POWER_SLEEP_POLL_MS));
+    TEST_ASSERT_EQUAL_STRING("delai", power_sleep_mode());
+}
+
+void test_adb_phy_timing_tables() {
+    typedef adb_phy_timing<72000000UL> bluepill;
+    typedef adb_phy_timing<240000000UL> esp32;
+    typedef adb_phy_timing<1000000UL> sim;
+
+    TEST_ASSERT_EQUAL(2520, bluepill::ONE_LOW);
+    TEST_ASSERT_EQUAL(4680, bluepill::ZERO_LOW);
+    TEST_ASSERT_EQUAL(7200, bluepill::CELL);
+    TEST_ASSERT_EQUAL(57600, bluepill::ATTENTION);
+    TEST_ASSERT_EQUAL(720000, esp32::RESET);
+    TEST_ASSERT_EQUAL(35, sim::ONE_LOW);
+    TEST_ASSERT_EQUAL(ADB_PHY_LOOP_CYCLES, esp32::RESOLUTION);
+    TEST_ASSERT_EQUAL(1, sim::RESOLUTION);
+
+    // Décodage par comparaison des phases : périphérique 30 % plus lent
+    // ou plus rapide
+    uint32_t slow_one = bluepill::ONE_LOW * 13 / 10;
+    uint32_t slow_cell = bluepill::CELL * 13 / 10;
+    TEST_ASSERT_TRUE(bluepill::bit(slow_one, slow_cell - slow_one));
+    uint32_t fast_zero = bluepill::ZERO_LOW * 7 / 10;
+    uint32_t fast_cell = bluepill::CELL * 7 / 10;
+    TEST_ASSERT_FALSE(bluepill::bit(fast_zero, fast_cell - fast_zero));
+    TEST_ASSERT_LESS_THAN(bluepill::PHASE_MAX, bluepill::PHASE_SLOWEST);
+}
+
+// Interfaces HID ouvertes sur la carte de test, un bit par interface
+static uint8_t test_board_open = 0;
+
+// Carte de test : une entrée vide est ignorée à l'enregistrement
+struct test_board {
+    static constexpr const char *hid_name = "test";
+    static constexpr uint8_t adb_pin = 5;
+    static constexpr uint8_t led_pin = 6;
+    static constexpr uint8_t sniffer_pin = 7;
+    static constexpr uint32_t clock_hz = 48000000UL;
+    static constexpr const hid_transport *transports[] = {
+        &hid_transport_native, nullptr};
+
+    static void hid_begin(uint8_t iface) { test_board_open |= 1 << iface; }
+    static void hid_end(uint8_t iface) { test_board_open &= ~(1 << iface); }
+};
+
+void test_board_traits_dispatch() {
+    // Carte de l'environnement natif
+    TEST_ASSERT_EQUAL_STRING("natif", board::hid_name);
+    TEST_ASSERT_EQUAL(1, board_traits<board>::transport_count);
+    TEST_ASSERT_EQUAL(35, adb_phy_clock::ONE_LOW);
+
+    TEST_ASSERT_EQUAL(2, board_traits<test_board>::transport_count);
+    TEST_ASSERT_EQUAL(1680, adb_phy_board_timing<test_board>::ONE_LOW);
+
+    // Couches HID instanciées pour la carte de test
+    test_board_open = 0;
+    hid_keyboard_init<test_board>();
+    hid_mouse_init<test_board>();
+    TEST_ASSERT_EQUAL(1 << BOARD_HID_KEYBOARD | 1 << BOARD_HID_MOUSE,
+                      test_board_open);
+    hid_keyboard_close<test_board>();
+    TEST_ASSERT_EQUAL(1 << BOARD_HID_MOUSE, test_board_open);
+    hid_mouse_close<test_board>();
+    TEST_ASSERT_EQUAL(0, test_board_open);
+
+    hid_transport_clear();
+    hid_transport_native_reset();
+    board_traits<test_board>::register_transports();
+    uint8_t report[8] = {0, 0, 0x04, 0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(1, hid_transport_submit(HID_REPORT_KEYBOARD, report, sizeof(report)));
+    TEST_ASSERT_EQUAL(1, hid_transport_native_count(HID_REPORT_KEYBOARD));
+    hid_transport_clear();
+}
+
+void test_sof_sync_schedule_and_histogram() {
+    sof_sync_reset();
+    TEST_ASSERT_FALSE(sof_sync_locked(0));
+
+    sof_sync_frame(10000);
+    TEST_ASSERT_TRUE(sof_sync_locked(10500));
+    TEST_ASSERT_FALSE(sof_sync_locked(10000 + SOF_SYNC_LOST_US));
+
+    // Jeton IN observé 300 µs après le SOF : position apprise progressivement
+    for (uint32_t t = 11000; t < 31000; t += 1000) {
+        sof_sync_frame(t);
+        sof_sync_in_token(t + 300);
+    }
+    sof_sync_stats stats = sof_sync_get_stats();
+    TEST_ASSERT_UINT16_WITHIN(5, 300, stats.in_phase_us);
+    TEST_ASSERT_EQUAL(1, stats.interval_frames);
+    TEST_ASSERT_EQUAL(0, stats.count);
+
+    // Cycle de 2 ms ayant produit un rapport : fin visée 100 µs avant le jeton
+    sof_sync_note_report(30000);
+    sof_sync_note_cycle(2000);
+    uint32_t start = sof_sync_next_start(31000);
+    uint32_t in_phase = sof_sync_get_stats().in_phase_us;
+    TEST_ASSERT_EQUAL(33000 + in_phase - 2000 - SOF_SYNC_GUARD_US, start);
+    TEST_ASSERT_EQUAL(start + SOF_SYNC_FRAME_US, sof_sync_next_start(start + 1));
+
+    // Cycle sans rapport : l'avance ne change pas
+    sof_sync_note_cycle(500);
+    TEST_ASSERT_EQUAL(start, sof_sync_next_start(31000));
+    // Cycle plus long : montée immédiate, dépassement compté
+    sof_sync_note_report(31000);
+    sof_sync_note_cycle(2500);
+    stats = sof_sync_get_stats();
+    TEST_ASSERT_EQUAL(2500, stats.cycle_us);
+    TEST_ASSERT_EQUAL(1, stats.overruns);
+
+    // Délais événement → jeton IN : le premier rapport seul ouvre la mesure
+    sof_sync_in_token(31300);
+    sof_sync_note_report(31900);
+    sof_sync_in_token(32300);
+    stats = sof_sync_get_stats();
+    TEST_ASSERT_EQUAL(2, stats.count);
+    TEST_ASSERT_EQUAL(1300, stats.max_us);
+    TEST_ASSERT_EQUAL(850, stats.mean_us);
+    TEST_ASSERT_EQUAL(1, stats.bins[400 / SOF_SYNC_BIN_US]);
+    TEST_ASSERT_EQUAL(1, stats.bins[1300 / SOF_SYNC_BIN_US]);
+
+    sof_sync_set_enabled(false);
+    TEST_ASSERT_FALSE(sof_sync_locked(32500));
+    char line[160];
+    sof_sync_format(line, sizeof(line));
+    TEST_ASSERT_EQUAL(0, strncmp(line, "SOF on=0", 8));
+    sof_sync_reset();
+}
+
+void test_sof_sync_learns_interval() {
+    sof_sync_reset();
+    sof_sync_set_declared_interval(10);
+    TEST_ASSERT_EQUAL(10, sof_sync_get_stats().interval_frames);
+
+    // bInterval 10 déclaré, hôte interrogeant toutes les 4 trames ; un
+    // rappel DataIn ne suit que les jetons ayant trouvé un rapport
+    for (uint32_t i = 1; i <= 64; i++) {
+        uint32_t t = 10000 + i * 1000;
+        sof_sync_frame(t);
+        if (i == 8 || i == 24 || i == 44)
+            sof_sync_in_token(t + 300);
+        // Écart de 16 trames : pas plus que le bInterval déclaré
+        if (i == 24)
+            TEST_ASSERT_EQUAL(8, sof_sync_get_stats().interval_frames);
+    }
+    sof_sync_stats stats = sof_sync_get_stats();
+    TEST_ASSERT_EQUAL(4, stats.interval_frames);
+
+    // Prochain jeton attendu à la trame 64, puis toutes les 4 trames
+    uint32_t start = sof_sync_next_start(74000);
+    TEST_ASSERT_EQUAL(74000 + stats.in_phase_us - SOF_SYNC_GUARD_US, start);
+    TEST_ASSERT_EQUAL(start + 4 * SOF_SYNC_FRAME_US,
+                      sof_sync_next_start(start + 1));
+
+    // Reprise après une interruption des SOF : intervalle à réapprendre
+    sof_sync_frame(74000 + SOF_SYNC_LOST_US);
+    TEST_ASSERT_EQUAL(10, sof_sync_get_stats().interval_frames);
+
+    sof_sync_set_declared_interval(SOF_SYNC_INTERVAL_FRAMES);
+    sof_sync_reset();
+}
+
+static display_status sample_display_status() {
+    display_status status = {};
+    status.present[ADB_STATS_KEYBOARD] = true;
+    status.present[ADB_STATS_MOUSE] = true;
+    status.transport_count = 1;
+    status.transport_name[0] = "usb";
+    status.transport_link[0] = DISPLAY_LINK_READY;
+    status.leds = INPUT_LED_NUM;
+    status.poll_hz = 104;
+    return status;
+}
+
+static void flush_display() {
+    for (uint8_t i = 0; i < 2 * DISPLAY_PAGES; i++)
+        status_display_service();
+}
+
+void test_status_display_dirty_regions() {
+    display_panel_native_reset();
+    TEST_ASSERT_TRUE(status_display_begin(&display_panel_native));
+    TEST_ASSERT_EQUAL(DISPLAY_PAGES, status_display_dirty_pages());
+
+    display_status status = sample_display_status();
+    TEST_ASSERT_TRUE(status_display_due(0));
+    status_display_render(status, 0);
+    flush_display();
+    TEST_ASSERT_EQUAL(0, status_display_dirty_pages());
+    TEST_ASSERT_EQUAL_MEMORY(status_display_framebuffer(),
+                             display_panel_native_frame(),
+                             DISPLAY_PAGES * DISPLAY_WIDTH);
+    // "KBD" en page 1 : première colonne du K
+    TEST_ASSERT_EQUAL_HEX8(0x7F, display_panel_native_frame()[DISPLAY_WIDTH]);
+
+    // Dessin limité à DISPLAY_REFRESH_MS
+    TEST_ASSERT_FALSE(status_display_due(DISPLAY_REFRESH_MS - 1));
+    TEST_ASSERT_TRUE(status_display_due(DISPLAY_REFRESH_MS));
+
+    // Seule la zone de Caps Lock change : une page, quelques colonnes
+    uint32_t bytes = display_panel_native_bytes();
+    uint32_t transfers = status_display_transfers();
+    status.leds |= INPUT_LED_CAPS;
+    status_display_render(status, DISPLAY_REFRESH_MS);
+    TEST_ASSERT_EQUAL(1, status_display_dirty_pages());
+
+    // Écran occupé : rien n'est engagé, l'appel rend la main
+    display_panel_native_set_busy(true);
+    status_display_service();
+    TEST_ASSERT_EQUAL(transfers, status_display_transfers());
+    display_panel_native_set_busy(false);
+
+    flush_display();
+    TEST_ASSERT_EQUAL(transfers + 1, status_display_transfers());
+    TEST_ASSERT_LESS_OR_EQUAL(4 * 6, display_panel_native_bytes() - bytes);
+    TEST_ASSERT_EQUAL_MEMORY(status_display_framebuffer(),
+                             display_panel_native_frame(),
+                             DISPLAY_PAGES * DISPLAY_WIDTH);
+
+    // État inchangé : aucun transfert
+    status_display_render(status, 2 * DISPLAY_REFRESH_MS);
+    TEST_ASSERT_EQUAL(0, status_display_dirty_pages());
+
+    // Compteurs d'erreurs plafonnés à « 999+ » : la ligne tient dans l'écran
+    for (uint8_t i = 0; i < ADB_STATS_JOYSTICK; i++)
+        status.errors[i] = 1000;
+    status_display_render(status, 3 * DISPLAY_REFRESH_MS);
+    flush_display();
+    for (uint8_t i = 0; i < ADB_STATS_JOYSTICK; i++)
+        status.errors[i] = 4000000000UL;
+    status_display_render(status, 4 * DISPLAY_REFRESH_MS);
+    TEST_ASSERT_EQUAL(0, status_display_dirty_pages());
+
+    status_display_begin(nullptr);
+    TEST_ASSERT_FALSE(status_display_enabled());
+    TEST_ASSERT_FALSE(status_display_due(0));
+}
+
+void test_host_suspend_wakeup_and_latency() {
+    hid_transport_clear();
+    hid_transport_native_reset();
+    hid_transport_register(&hid_transport_native);
+    host_suspend_reset();
+    power_init(0);
+
+    hid_transport_native_set_suspended(true);
+    TEST_ASSERT_TRUE(hid_transport_suspended());
+    TEST_ASSERT_TRUE(host_suspend_update(hid_transport_suspended()));
+    power_set_suspended(true, 10);
+    TEST_ASSERT_EQUAL(POWER_SUSPEND, power_get_state());
+    TEST_ASSERT_EQUAL(POWER_SUSPEND_POLL_MS, power_poll_interval_ms());
+    // L'activité ne quitte pas le palier de suspension
+    power_note_activity(20);
+    TEST_ASSERT_EQUAL(POWER_SUSPEND, power_update(20 + POWER_SLEEP_AFTER_MS));
+
+    // Rien n'est remis à un transport suspendu
+    uint8_t report[8] = {0};
+    TEST_ASSERT_EQUAL(0, hid_transport_submit(HID_REPORT_KEYBOARD, report, 8));
+    TEST_ASSERT_FALSE(host_suspend_wakeup_due(100));
+
+    // Premier événement : un réveil, puis une relance faute de reprise
+    host_suspend_note_wake_event(100000);
+    host_suspend_note_wake_event(150000);
+    TEST_ASSERT_TRUE(host_suspend_wakeup_due(100));
+    TEST_ASSERT_TRUE(hid_transport_remote_wakeup(true));
+    TEST_ASSERT_EQUAL(1, hid_transport_native_wakeups());
+    TEST_ASSERT_FALSE(host_suspend_wakeup_due(101));
+    TEST_ASSERT_TRUE(host_suspend_waking(101));
+    TEST_ASSERT_FALSE(host_suspend_waking(100 + HOST_WAKEUP_RETRY_MS));
+    TEST_ASSERT_TRUE(host_suspend_wakeup_due(100 + HOST_WAKEUP_RETRY_MS));
+
+    // Reprise : le délai court depuis le premier événement
+    hid_transport_native_set_suspended(false);
+    TEST_ASSERT_TRUE(host_suspend_update(hid_transport_suspended()));
+    TEST_ASSERT_FALSE(host_suspend_active());
+    power_set_suspended(false, 700);
+    TEST_ASSERT_EQUAL(POWER_ACTIVE, power_get_state());
+    host_suspend_note_report(130000);
+    host_suspend_note_report(190000);
+
+    const host_suspend_stats &stats = host_suspend_get_stats();
+    TEST_ASSERT_EQUAL(1, stats.suspends);
+    TEST_ASSERT_EQUAL(2, stats.wakeups);
+    TEST_ASSERT_EQUAL(1, stats.wake_count);
+    TEST_ASSERT_EQUAL(30000, stats.wake_last_us);
+    TEST_ASSERT_EQUAL(30000, stats.wake_max_us);
+    hid_transport_clear();
+}
+
+static uint32_t ble_notifications = 0;
+static uint8_t ble_last_kind = 0xFF;
+static uint8_t ble_last_report[8] = {0};
+static ble_conn_params ble_last_params = {0, 0, 0, 0};
+
+static void record_ble_notify(uint8_t kind, const uint8_t* report, uint8_t len) {
+    memcpy(ble_last_report, report, len < 8 ? len : 8);
+    ble_notifications++;
+    ble_last_kind = kind;
+}
+
+static void record_ble_params(const ble_conn_params& params) {
+    ble_last_params = params;
+}
+
+void test_ble_link_batching_and_profiles() {
+    ble_link_reset();
+    ble_link_set_hooks(record_ble_notify, record_ble_params);
+    ble_notifications = 0;
+
+    uint8_t key[8] = {0};
+    uint8_t mouse[4] = {0, 10, (uint8_t)-3, 0};
+    TEST_ASSERT_FALSE(ble_link_enqueue(HID_REPORT_MOUSE, mouse, 4, 0));
+    TEST_ASSERT_EQUAL(1, ble_link_get_counters().dropped);
+
+    ble_link_on_connect(0);
+    ble_link_on_secured();
+    ble_link_on_mtu(185);
+    TEST_ASSERT_EQUAL(185, ble_link_mtu());
+
+    // Rapports souris consécutifs fusionnés, rapports clavier conservés
+    ble_link_enqueue(HID_REPORT_MOUSE, mouse, 4, 10);
+    ble_link_enqueue(HID_REPORT_MOUSE, mouse, 4, 10);
+    for (uint8_t i = 0; i < 5; i++)
+        ble_link_enqueue(HID_REPORT_KEYBOARD, key, 8, 10);
+    TEST_ASSERT_EQUAL(6, ble_link_pending());
+    TEST_ASSERT_EQUAL(1, ble_link_get_counters().merged);
+
+    // Au plus BLE_LINK_NOTIFY_PER_EVENT notifications par événement
+    ble_link_service(20);
+    TEST_ASSERT_EQUAL(BLE_LINK_NOTIFY_PER_EVENT, ble_notifications);
+    ble_link_service(21);
+    TEST_ASSERT_EQUAL(BLE_LINK_NOTIFY_PER_EVENT, ble_notifications);
+    ble_link_service(40);
+    TEST_ASSERT_EQUAL(6, ble_notifications);
+    TEST_ASSERT_EQUAL(HID_REPORT_KEYBOARD, ble_last_kind);
+
+    // Basse latence après la découverte des services, économe au repos
+    ble_link_service(BLE_LINK_PARAMS_DELAY_MS);
+    TEST_ASSERT_EQUAL(BLE_PROFILE_LOW_LATENCY, ble_link_profile());
+    TEST_ASSERT_EQUAL(6, ble_last_params.min_interval);
+    TEST_ASSERT_EQUAL(12, ble_last_params.max_interval);
+    TEST_ASSERT_EQUAL(0, ble_last_params.latency);
+
+    ble_link_service(10 + BLE_LINK_IDLE_AFTER_MS);
+    TEST_ASSERT_EQUAL(BLE_PROFILE_POWER_SAVING, ble_link_profile());
+    TEST_ASSERT_GREATER_THAN(0, ble_last_params.latency);
+
+    ble_link_enqueue(HID_REPORT_KEYBOARD, key, 8, 3000);
+    ble_link_service(3000);
+    TEST_ASSERT_EQUAL(BLE_PROFILE_LOW_LATENCY, ble_link_profile());
+    TEST_ASSERT_EQUAL(3, ble_link_get_counters().param_updates);
+    TEST_ASSERT_EQUAL(7, ble_link_get_counters().sent);
+
+    ble_link_set_hooks(nullptr, nullptr);
+    ble_link_reset();
+}
+
+void test_ble_link_prelink_buffering() {
+    ble_link_reset();
+    ble_link_set_hooks(record_ble_notify, record_ble_params);
+    ble_notifications = 0;
+
+    // Frappes tapées pendant la reconnexion : conservées, dans l'ordre
+    ble_link_on_advertising(1000);
+    uint8_t key[8] = {0};
+    for (uint8_t i = 0; i < 3; i++) {
+        key[2] = 4 + i;
+        TEST_ASSERT_TRUE(ble_link_enqueue(HID_REPORT_KEYBOARD, key, 8, 1100));
+    }
+    uint8_t mouse[4] = {0, 1, 1, 0};
+    TEST_ASSERT_FALSE(ble_link_enqueue(HID_REPORT_MOUSE, mouse, 4, 1100));
+    ble_link_service(1200);
+    TEST_ASSERT_EQUAL(3, ble_link_pending());
+    TEST_ASSERT_EQUAL(3, ble_link_get_counters().buffered);
+
+    // Connecté mais pas encore chiffré : rien n'est envoyé
+    ble_link_on_connect(1300);
+    ble_link_service(1310);
+    TEST_ASSERT_EQUAL(0, ble_notifications);
+    TEST_ASSERT_FALSE(ble_link_ready(1310));
+
+    ble_link_on_secured();
+    TEST_ASSERT_TRUE(ble_link_ready(1350));
+    ble_link_service(1350);
+    TEST_ASSERT_EQUAL(3, ble_notifications);
+    TEST_ASSERT_EQUAL(6, ble_last_report[2]);
+    TEST_ASSERT_EQUAL(350, ble_link_get_counters().reconnect_ms);
+
+    // Frappes trop anciennes écartées si le lien ne revient pas
+    ble_link_on_disconnect();
+    ble_link_enqueue(HID_REPORT_KEYBOARD, key, 8, 2000);
+    ble_link_service(2000 + BLE_LINK_PRELINK_MAX_AGE_MS);
+    TEST_ASSERT_EQUAL(0, ble_link_pending());
+
+    // Sans confirmation de chiffrement, envoi après le délai de garde
+    ble_link_enqueue(HID_REPORT_KEYBOARD, key, 8, 20000);
+    ble_link_on_connect(20000);
+    ble_link_service(20000 + BLE_LINK_SECURE_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL(4, ble_notifications);
+
+    ble_link_set_hooks(nullptr, nullptr);
+    ble_link_reset();
+}
+
+static tablet_sample tablet_at(uint16_t x, uint8_t buttons) {
+    tablet_sample sample = {0, x, 0, 0, buttons};
+    return sample;
+}
+
+void test_adb_tablet_decode() {
+    const adb_tablet_format *wacom = adb_tablet_format_for(ADB_TABLET_HANDLER_WACOM);
+    TEST_ASSERT_EQUAL(ADB_TABLET_HANDLER_WACOM, wacom->handler_id);
+    TEST_ASSERT_EQUAL(0, adb_tablet_format_for(0x01)->handler_id);
+
+    // Stylet posé, bouton latéral 1, au milieu de la tablette
+    const uint8_t frame[] = {0x83, 0x27, 0xB0, 0x1D, 0xC4, 0xFF};
+    tablet_sample sample;
+    TEST_ASSERT_FALSE(adb_tablet_decode(wacom, frame, 4, &sample));
+    TEST_ASSERT_TRUE(adb_tablet_decode(wacom, frame, sizeof(frame), &sample));
+    TEST_ASSERT_EQUAL(TABLET_TIP | TABLET_BARREL1 | TABLET_IN_RANGE, sample.buttons);
+    TEST_ASSERT_UINT16_WITHIN(2, ADB_TABLET_LOGICAL_MAX / 2, sample.x);
+    TEST_ASSERT_UINT16_WITHIN(2, ADB_TABLET_LOGICAL_MAX / 2, sample.y);
+    TEST_ASSERT_EQUAL(ADB_TABLET_PRESSURE_MAX, sample.pressure);
+
+    // Hors de portée : ni pointe ni bouton
+    const uint8_t away[] = {0x01, 0, 0, 0, 0, 0};
+    adb_tablet_decode(wacom, away, sizeof(away), &sample);
+    TEST_ASSERT_EQUAL(0, sample.buttons);
+}
+
+void test_adb_tablet_coalescing_keeps_edges() {
+    adb_tablet_reset();
+    hid_transport_clear();
+    hid_transport_native_reset();
+    hid_transport_register(&hid_transport_native);
+
+    const uint8_t hover = TABLET_IN_RANGE;
+    const uint8_t down = TABLET_IN_RANGE | TABLET_TIP;
+
+    // Rafale entre deux tours : survol, posé, tracé, levé, survol
+    adb_tablet_push(tablet_at(10, hover));
+    adb_tablet_push(tablet_at(11, hover));
+    adb_tablet_push(tablet_at(12, down));
+    for (uint16_t x = 13; x < 20; x++)
+        adb_tablet_push(tablet_at(x, down));
+    adb_tablet_push(tablet_at(20, hover));
+    adb_tablet_push(tablet_at(21, hover));
+
+    tablet_sample sample;
+    const uint16_t expected_x[] = {10, 12, 20, 21};
+    const uint8_t expected_buttons[] = {hover, down, hover, hover};
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(adb_tablet_next(&sample));
+        TEST_ASSERT_EQUAL(expected_x[i], sample.x);
+        TEST_ASSERT_EQUAL(expected_buttons[i], sample.buttons);
+    }
+    TEST_ASSERT_FALSE(adb_tablet_next(&sample));
+    TEST_ASSERT_EQUAL(8, adb_tablet_coalesced());
+
+    // Pointe posée puis levée entre deux tours : les deux transitions partent
+    adb_tablet_push(tablet_at(30, down));
+    adb_tablet_push(tablet_at(31, hover));
+    hid_reports_service(0);
+    uint8_t len = 0;
+    const uint8_t *report = hid_transport_native_last(HID_REPORT_TABLET, &len);
+    TEST_ASSERT_EQUAL(7, len);
+    TEST_ASSERT_EQUAL(down, report[0]);
+    TEST_ASSERT_EQUAL(30, report[1]);
+    hid_reports_service(1);
+    TEST_ASSERT_EQUAL(hover, report[0]);
+    TEST_ASSERT_EQUAL(2, hid_transport_native_count(HID_REPORT_TABLET));
+
+    hid_transport_clear();
+    adb_tablet_reset();
+}
+
+void test_adb_joystick_calibration_and_deadzone() {
+    const adb_joystick_format *gravis =
+        adb_joystick_format_for(ADB_JOYSTICK_HANDLER_GRAVIS);
+    TEST_ASSERT_NOT_NULL(gravis);
+    TEST_ASSERT_EQUAL(2, gravis->axis_count);
+    TEST_ASSERT_FALSE(gravis->confirmed); // Reste une souris par défaut
+    TEST_ASSERT_NULL(adb_joystick_format_for(0x02)); // Souris
+
+    joystick_sample sample;
+    const uint8_t rest[] = {0xFF, 0x78, 0x88};
+    adb_joystick_begin(nullptr);
+    TEST_ASSERT_FALSE(adb_joystick_decode(rest, sizeof(rest), &sample));
+
+    // Première trame : centre relevé au repos
+    adb_joystick_begin(gravis);
+    adb_joystick_set_deadzone(ADB_JOYSTICK_DEADZONE_Q15);
+    TEST_ASSERT_FALSE(adb_joystick_decode(rest, 2, &sample));
+    TEST_ASSERT_TRUE(adb_joystick_decode(rest, sizeof(rest), &sample));
+    TEST_ASSERT_EQUAL(0, sample.axes[0]);
+    TEST_ASSERT_EQUAL(0, sample.axes[1]);
+    TEST_ASSERT_EQUAL(0, sample.axes[2]);
+    TEST_ASSERT_EQUAL(0, sample.buttons);
+
+    // Zone morte, puis sortie progressive sans saut
+    const uint8_t nudge[] = {0xFF, 0x78 + 2, 0x88 - 2};
+    adb_joystick_decode(nudge, sizeof(nudge), &sample);
+    TEST_ASSERT_EQUAL(0, sample.axes[0]);
+    TEST_ASSERT_EQUAL(0, sample.axes[1]);
+    const uint8_t beyond[] = {0xFF, 0x78 + 5, 0x88 - 5};
+    adb_joystick_decode(beyond, sizeof(beyond), &sample);
+    TEST_ASSERT_INT_WITHIN(600, 600, sample.axes[0]);
+    TEST_ASSERT_INT_WITHIN(600, -600, sample.axes[1]);
+
+    // Pleine course, boutons actifs à l'état bas (trois boutons)
+    const uint8_t full[] = {0x00, 0x78 + 0x40, 0x88 - 0x40};
+    adb_joystick_decode(full, sizeof(full), &sample);
+    TEST_ASSERT_EQUAL(ADB_JOYSTICK_AXIS_MAX, sample.axes[0]);
+    TEST_ASSERT_EQUAL(-ADB_JOYSTICK_AXIS_MAX, sample.axes[1]);
+    TEST_ASSERT_EQUAL(0x07, sample.buttons);
+
+    // Course plus longue observée : l'étendue s'élargit
+    const uint8_t wider[] = {0xFE, 0x78 + 0x60, 0x88};
+    adb_joystick_decode(wider, sizeof(wider), &sample);
+    TEST_ASSERT_EQUAL(ADB_JOYSTICK_AXIS_MAX, sample.axes[0]);
+    TEST_ASSERT_EQUAL(0x01, sample.buttons);
+    adb_joystick_decode(full, sizeof(full), &sample);
+    TEST_ASSERT_INT_WITHIN(500, 21116, sample.axes[0]);
+
+    // Sans zone morte, le moindre écart compte ; zone bornée à la moitié
+    adb_joystick_set_deadzone(0);
+    adb_joystick_decode(nudge, sizeof(nudge), &sample);
+    TEST_ASSERT_GREATER_THAN(0, sample.axes[0]);
+    adb_joystick_set_deadzone(0xFFFF);
+    TEST_ASSERT_EQUAL(0x4000, adb_joystick_deadzone());
+    adb_joystick_set_deadzone(ADB_JOYSTICK_DEADZONE_Q15);
+
+    // Étalonnage imposé
+    TEST_ASSERT_FALSE(adb_joystick_calibrate(0, 0x80, 0x80, 0xF0));
+    TEST_ASSERT_FALSE(adb_joystick_calibrate(ADB_JOYSTICK_AXES, 0, 1, 2));
+    TEST_ASSERT_TRUE(adb_joystick_calibrate(0, 0x10, 0x80, 0xF0));
+    const uint8_t low[] = {0xFF, 0x10, 0x88};
+    adb_joystick_decode(low, sizeof(low), &sample);
+    TEST_ASSERT_EQUAL(-ADB_JOYSTICK_AXIS_MAX, sample.axes[0]);
+}
+
+static joystick_sample stick_at(int16_t x, uint8_t buttons) {
+    joystick_sample sample = {0, {x, 0, 0}, buttons};
+    return sample;
+}
+
+void test_adb_joystick_coalescing_and_report() {
+    adb_joystick_reset();
+    hid_transport_clear();
+    hid_transport_native_reset();
+    hid_transport_register(&hid_transport_native);
+
+    // Seuls les changements sont déposés
+    TEST_ASSERT_TRUE(adb_joystick_push(stick_at(1, 0)));
+    TEST_ASSERT_FALSE(adb_joystick_push(stick_at(1, 0)));
+
+    // Rafale entre deux tours : déplacements, appui, déplacements, relâché
+    adb_joystick_push(stick_at(2, 0));
+    adb_joystick_push(stick_at(3, 0));
+    adb_joystick_push(stick_at(4, 1));
+    adb_joystick_push(stick_at(5, 1));
+    adb_joystick_push(stick_at(6, 1));
+    adb_joystick_push(stick_at(7, 0));
+
+    joystick_sample sample;
+    const int16_t expected_x[] = {4, 7};
+    const uint8_t expected_buttons[] = {1, 0};
+    for (uint8_t i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(adb_joystick_next(&sample));
+        TEST_ASSERT_EQUAL(expected_x[i], sample.axes[0]);
+        TEST_ASSERT_EQUAL(expected_buttons[i], sample.buttons);
+    }
+    TEST_ASSERT_FALSE(adb_joystick_next(&sample));
+    TEST_ASSERT_EQUAL(5, adb_joystick_coalesced());
+
+    // Rapport : boutons puis axes signés en petit-boutiste
+    joystick_sample full = {0, {-ADB_JOYSTICK_AXIS_MAX, 256, 0}, 0x05};
+    adb_joystick_push(full);
+    hid_reports_service(0);
+    uint8_t len = 0;
+    const uint8_t *report = hid_transport_native_last(HID_REPORT_JOYSTICK, &len);
+    TEST_ASSERT_EQUAL(7, len);
+    const uint8_t expected[] = {0x05, 0x01, 0x80, 0x00, 0x01, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, report, sizeof(expected));
+    TEST_ASSERT_EQUAL(1, hid_transport_native_count(HID_REPORT_JOYSTICK));
+
+    hid_transport_clear();
+    adb_joystick_reset();
+}
+
+// Générateur de fronts ADB synthétiques pour le décodeur de l'analyseur
+static adb_sniff_decoder sniff_decoder;
+static uint32_t sniff_t = 0;
+static adb_sniff_event sniff_events[8];
+static uint8_t sniff_count = 0;
+
+static void record_sniff_event(const adb_sniff_event& event, void*) {
+    if (sniff_count < 8)
+        sniff_events[sniff_count++] = event;
+}
+
+static void sniff_phase(uint32_t low_us, uint32_t high_us) {
+    adb_sniff_decoder_edge(&sniff_decoder, 0, sniff_t);
+    sniff_t += low_us;
+    adb_sniff_decoder_edge(&sniff_decoder, 1, sniff_t);
+    sniff_t += high_us;
+}
+
+static void sniff_byte(uint8_t value) {
+    for (uint8_t i = 0; i < 8; i++)
+        value & (0x80 >> i) ? sniff_phase(35, 65) : sniff_phase(65, 35);
+}
+
+void test_adb_sniffer_decodes_transactions() {
+    sniff_t = 1000;
+    sniff_count = 0;
+    adb_sniff_decoder_init(&sniff_decoder, record_sniff_event, nullptr);
+
+    sniff_phase(3000, 1000);        // Reset
+    sniff_phase(800, 65);           // Attention + synchro
+    sniff_byte(0x3C);               // Talk adresse 3 registre 0
+    sniff_phase(65 + 300, 200);     // Bit de stop prolongé (SRQ), Tlt
+    sniff_phase(35, 65);            // Bit de start
+    sniff_byte(0x80);
+    sniff_byte(0x81);
+    sniff_phase(65, 0);             // Bit de stop
+    adb_sniff_decoder_idle(&sniff_decoder, sniff_t + 500);
+
+    TEST_ASSERT_EQUAL(3, sniff_count);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_RESET, sniff_events[0].type);
+    TEST_ASSERT_EQUAL(1000, sniff_events[0].timestamp_us);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_COMMAND, sniff_events[1].type);
+    TEST_ASSERT_EQUAL(0x3C, sniff_events[1].data[0]);
+    TEST_ASSERT_EQUAL(1, sniff_events[1].data[1]);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_DATA, sniff_events[2].type);
+    TEST_ASSERT_EQUAL(2, sniff_events[2].len);
+    TEST_ASSERT_EQUAL(0x80, sniff_events[2].data[0]);
+    TEST_ASSERT_EQUAL(0x81, sniff_events[2].data[1]);
+
+    // Talk sans réponse puis trame tronquée
+    sniff_count = 0;
+    sniff_phase(800, 65);
+    sniff_byte(0x2C);
+    sniff_phase(65, 1000);
+    sniff_phase(800, 65);
+    sniff_byte(0x2C);
+    sniff_phase(65, 200);
+    sniff_phase(35, 65);
+    sniff_byte(0xFF);
+    sniff_phase(35, 65);
+    sniff_phase(65, 0);
+    adb_sniff_decoder_idle(&sniff_decoder, sniff_t + 500);
+    TEST_ASSERT_EQUAL(3, sniff_count);
+    TEST_ASSERT_EQUAL(0, sniff_events[0].data[1]);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_ERROR, sniff_events[2].type);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_ERR_LENGTH, sniff_events[2].data[0]);
+}
+
+void test_adb_sniffer_stream_round_trip() {
+    adb_sniff_event event = {};
+    event.timestamp_us = 1234567;
+    event.type = ADB_SNIFF_COMMAND;
+    event.len = 2;
+    event.data[0] = 0x3C;
+    event.data[1] = 1;
+
+    // Octets parasites avant l'enregistrement : resynchronisation
+    uint8_t stream_bytes[3 + ADB_SNIFF_RECORD_MAX] = {0x00, ADB_SNIFF_SYNC, 0x42};
+    size_t n = adb_sniff_encode(event, stream_bytes + 3, ADB_SNIFF_RECORD_MAX);
+    TEST_ASSERT_EQUAL(ADB_SNIFF_HEADER_LEN + 2, n);
+
+    adb_sniff_stream stream = {};
+    adb_sniff_event decoded;
+    uint8_t records = 0;
+    for (size_t i = 0; i < 3 + n; i++)
+        records += adb_sniff_stream_feed(&stream, stream_bytes[i], &decoded);
+    TEST_ASSERT_EQUAL(1, records);
+    TEST_ASSERT_EQUAL(1234567, decoded.timestamp_us);
+
+    char line[96];
+    adb_sniff_format(decoded, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("    1234.567 ms  Talk   adr 3 reg 0  SRQ", line);
+}
+
+// Sortie du protocole de contrôle : tampon d'émission limité à 16 octets
+static uint8_t ctrl_out[512];
+static size_t ctrl_out_len = 0;
+static size_t ctrl_out_room = 16;
+
+static size_t ctrl_test_write(const uint8_t *data, size_t len) {
+    memcpy(ctrl_out + ctrl_out_len, data, len);
+    ctrl_out_len += len;
+    ctrl_out_room -= len;
+    return len;
+}
+
+static size_t ctrl_test_room() { return ctrl_out_room; }
+
+// Envoie une trame puis vide le tampon d'émission jusqu'à la fin de la réponse
+static void ctrl_send(uint8_t type, const uint8_t *payload, uint16_t len,
+                      bool corrupt = false) {
+    uint8_t frame[CTRL_PAYLOAD_MAX + CTRL_OVERHEAD];
+    frame[0] = CTRL_SYNC;
+    frame[1] = len & 0xFF;
+    frame[2] = len >> 8;
+    frame[3] = type;
+    memcpy(frame + 4, payload, len);
+    uint16_t crc = ctrl_crc16(0xFFFF, frame + 1, len + 3);
+    if (corrupt)
+        crc ^= 1;
+    frame[4 + len] = crc & 0xFF;
+    frame[5 + len] = crc >> 8;
+
+    ctrl_out_len = 0;
+    for (uint16_t i = 0; i < len + CTRL_OVERHEAD; i++) {
+        TEST_ASSERT_FALSE(ctrl_proto_busy());
+        TEST_ASSERT_TRUE(ctrl_proto_feed(frame[i]));
+    }
+    while (ctrl_proto_busy()) {
+        ctrl_out_room = 16;
+        ctrl_proto_service();
+    }
+    ctrl_out_room = 16;
+}
+
+// Vérifie l'en-tête et le CRC de la réponse, retourne sa charge utile
+static const uint8_t *ctrl_reply(uint8_t type, uint16_t len) {
+    TEST_ASSERT_EQUAL(len + CTRL_OVERHEAD, ctrl_out_len);
+    TEST_ASSERT_EQUAL_HEX8(CTRL_SYNC, ctrl_out[0]);
+    TEST_ASSERT_EQUAL(len, ctrl_out[1] | ctrl_out[2] << 8);
+    TEST_ASSERT_EQUAL_HEX8(type, ctrl_out[3]);
+    uint16_t crc = ctrl_crc16(0xFFFF, ctrl_out + 1, len + 3);
+    TEST_ASSERT_EQUAL_HEX16(crc, ctrl_out[4 + len] | ctrl_out[5 + len] << 8);
+    return ctrl_out + 4;
+}
+
+void test_ctrl_proto_config_and_counters() {
+    ctrl_proto_init(ctrl_test_write, ctrl_test_room);
+    TEST_ASSERT_FALSE(ctrl_proto_feed('s')); // Commande texte hors trame
+    TEST_ASSERT_FALSE(ctrl_proto_owns_port());
+
+    ctrl_send(CTRL_PING, nullptr, 0);
+    TEST_ASSERT_EQUAL(CTRL_VERSION, ctrl_reply(CTRL_PING | CTRL_RESPONSE, 1)[0]);
+    // Client binaire vu : les traces texte se taisent
+    TEST_ASSERT_TRUE(ctrl_proto_owns_port());
+
+    const uint8_t set_hold[] = {CTRL_CFG_TAP_HOLD_MS, 40, 0, 0, 0};
+    ctrl_send(CTRL_SET_CONFIG, set_hold, sizeof(set_hold));
+    const uint8_t *reply = ctrl_reply(CTRL_SET_CONFIG | CTRL_RESPONSE, 5);
+    TEST_ASSERT_EQUAL(40, reply[1]);
+    TEST_ASSERT_EQUAL(40, hid_reports_tap_hold_ms());
+    hid_reports_set_tap_hold_ms(KEY_TAP_HOLD_MS);
+
+    const uint8_t set_version[] = {CTRL_CFG_VERSION, 9, 0, 0, 0};
+    ctrl_send(CTRL_SET_CONFIG, set_version, sizeof(set_version));
+    reply = ctrl_reply(CTRL_NAK, 2);
+    TEST_ASSERT_EQUAL(CTRL_ERR_KEY, reply[1]);
+
+    ctrl_send(CTRL_PING, nullptr, 0, true);
+    reply = ctrl_reply(CTRL_NAK, 2);
+    TEST_ASSERT_EQUAL(CTRL_ERR_CRC, reply[1]);
+    TEST_ASSERT_EQUAL(1, ctrl_proto_get_counters().crc_errors);
+
+    // Réponse plus longue que le tampon d'émission : émise par morceaux
+    ctrl_send(CTRL_GET_COUNTERS, nullptr, 0);
+    TEST_ASSERT_GREATER_THAN(16, ctrl_out_len);
+    reply = ctrl_reply(CTRL_GET_COUNTERS | CTRL_RESPONSE,
+                       ctrl_out_len - CTRL_OVERHEAD);
+    TEST_ASSERT_EQUAL(ADB_STATS_DEVICE_COUNT, reply[0]);
+    TEST_ASSERT_EQUAL(HID_REPORT_KIND_COUNT, reply[1]);
+}
+
+void test_ctrl_proto_remap_upload_and_trace() {
+    ctrl_proto_init(ctrl_test_write, ctrl_test_room);
+    key_remap_reset();
+    key_remap_set_enabled(true);
+
+    // Échange des codes 0x00 (A) et 0x0B (B), écrits dans le banc préparé
+    uint8_t table[KEY_REMAP_SIZE];
+    for (uint16_t i = 0; i < KEY_REMAP_SIZE; i++)
+        table[i] = i;
+    table[0x00] = 0x0B;
+    table[0x0B] = 0x00;
+    uint8_t upload[2 + KEY_REMAP_SIZE] = {0, 0};
+    memcpy(upload + 2, table, KEY_REMAP_SIZE);
+    ctrl_send(CTRL_REMAP_WRITE, upload, sizeof(upload));
+    ctrl_reply(CTRL_ACK, 1);
+    TEST_ASSERT_EQUAL(0x00, key_remap_lookup(0x00)); // Pas encore validée
+
+    uint16_t crc = ctrl_crc16(0xFFFF, table, KEY_REMAP_SIZE);
+    const uint8_t bad_commit[] = {(uint8_t)~crc, (uint8_t)(crc >> 8)};
+    ctrl_send(CTRL_REMAP_COMMIT, bad_commit, 2);
+    TEST_ASSERT_EQUAL(CTRL_ERR_CHECK, ctrl_reply(CTRL_NAK, 2)[1]);
+
+    const uint8_t commit[] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+    ctrl_send(CTRL_REMAP_COMMIT, commit, 2);
+    ctrl_reply(CTRL_ACK, 1);
+    TEST_ASSERT_EQUAL(0x0B, key_remap_lookup(0x00));
+    TEST_ASSERT_EQUAL(0x00, key_remap_lookup(0x0B));
+
+    const uint8_t overflow[] = {KEY_REMAP_SIZE - 1, 0, 1, 2};
+    ctrl_send(CTRL_REMAP_WRITE, overflow, sizeof(overflow));
+    TEST_ASSERT_EQUAL(CTRL_ERR_RANGE, ctrl_reply(CTRL_NAK, 2)[1]);
+    key_remap_reset();
+
+    // Trace : lecture directe des entrées enregistrées
+    event_trace_reset();
+    event_trace_set_enabled(true);
+    input_event event = {1000, INPUT_EVENT_KEY_DOWN, 0x0B, 0, 0};
+    event_trace_record(event, 1250);
+    event_trace_set_enabled(false);
+
+    ctrl_send(CTRL_TRACE_INFO, nullptr, 0);
+    const uint8_t *reply = ctrl_reply(CTRL_TRACE_INFO | CTRL_RESPONSE, 7);
+    TEST_ASSERT_EQUAL(1, reply[0]);
+    TEST_ASSERT_EQUAL(sizeof(trace_entry), reply[6]);
+
+    const uint8_t read[] = {0, 0, sizeof(trace_entry)};
+    ctrl_send(CTRL_TRACE_READ, read, sizeof(read));
+    trace_entry entry;
+    memcpy(&entry, ctrl_reply(CTRL_TRACE_READ | CTRL_RESPONSE,
+                              sizeof(trace_entry)),
+           sizeof(entry));
+    TEST_ASSERT_EQUAL(1000, entry.event_us);
+    TEST_ASSERT_EQUAL(1250, entry.report_us);
+    TEST_ASSERT_EQUAL(0x0B, entry.code);
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_key_report_empty);
@@ -110,6 +1415,35 @@ int main(int argc, char **argv) {
     RUN_TEST(test_adb_kb_keypress);
     RUN_TEST(test_adb_kb_modifiers);
     RUN_TEST(test_adb_command);
+
+    RUN_TEST(test_adb_stats_classify);
+    RUN_TEST(test_adb_stats_retry_and_backoff);
+    RUN_TEST(test_adb_stats_format);
+
+    RUN_TEST(test_input_event_ring_two_threads);
+    RUN_TEST(test_hid_transport_native);
+    RUN_TEST(test_key_queue_scanner_throughput);
+    RUN_TEST(test_key_queue_overflow);
+    RUN_TEST(test_key_queue_per_transport_delivery);
+    RUN_TEST(test_mouse_busy_endpoint_merges_moves);
+    RUN_TEST(test_consumer_keys_follow_transports);
+    RUN_TEST(test_power_manager_decay_and_wake);
+    RUN_TEST(test_adb_phy_timing_tables);
+    RUN_TEST(test_board_traits_dispatch);
+    RUN_TEST(test_sof_sync_schedule_and_histogram);
+    RUN_TEST(test_sof_sync_learns_interval);
+    RUN_TEST(test_status_display_dirty_regions);
+    RUN_TEST(test_host_suspend_wakeup_and_latency);
+    RUN_TEST(test_ble_link_batching_and_profiles);
+    RUN_TEST(test_ble_link_prelink_buffering);
+    RUN_TEST(test_adb_tablet_decode);
+    RUN_TEST(test_adb_tablet_coalescing_keeps_edges);
+    RUN_TEST(test_adb_joystick_calibration_and_deadzone);
+    RUN_TEST(test_adb_joystick_coalescing_and_report);
+    RUN_TEST(test_adb_sniffer_decodes_transactions);
+    RUN_TEST(test_adb_sniffer_stream_round_trip);
+    RUN_TEST(test_ctrl_proto_config_and_counters);
+    RUN_TEST(test_ctrl_proto_remap_upload_and_trace);
     UNITY_END();
 
     return 0;
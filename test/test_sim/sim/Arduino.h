@@ -0,0 +1,116 @@
+/**
+ * @file Arduino.h
+ * @brief Cœur Arduino simulé : horloge virtuelle, broches, port série.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Remplace le cœur Arduino dans l'environnement `sim` : le micrologiciel
+ * complet (setup()/loop(), couche physique ADB comprise) s'exécute sur le PC.
+ * Le temps ne s'écoule que par les appels au cœur : chaque appel coûte
+ * SIM_CALL_NS, delay() et delayMicroseconds() avancent l'horloge d'autant.
+ * La broche du bus ADB est reliée au bus virtuel (voir sim_adb.h).
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define SIM_PIN_COUNT 64 /**< Broches simulées. */
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+unsigned long pulseIn(uint32_t pin, uint32_t state,
+                      unsigned long timeout = 1000000UL);
+
+/** Interruptions de broche non simulées : le gestionnaire est ignoré. */
+void attachInterrupt(uint32_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint32_t interrupt);
+inline uint32_t digitalPinToInterrupt(uint32_t pin) { return pin; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+/**
+ * @class SimSerial
+ * @brief Port série simulé : sortie capturée, entrée scriptée.
+ */
+class SimSerial {
+public:
+  void begin(unsigned long baud);
+  void end();
+  void flush() {}
+  operator bool() const { return true; }
+
+  int available();
+  int read();
+  int peek();
+  int availableForWrite();
+
+  size_t write(uint8_t byte);
+  size_t write(const uint8_t *data, size_t len);
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+  size_t print(const char *str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(double value, int digits = 2);
+  size_t print(unsigned long long value, int base = DEC);
+  size_t print(long long value, int base = DEC);
+  size_t print(int value, int base = DEC) { return print((long long)value, base); }
+
+  /** Entiers de toutes tailles, base DEC ou HEX. */
+  template <typename T,
+            typename std::enable_if<std::is_integral<T>::value &&
+                                        !std::is_same<T, char>::value,
+                                    int>::type = 0>
+  size_t print(T value, int base = DEC) {
+    if (std::is_signed<T>::value)
+      return print((long long)value, base);
+    return print((unsigned long long)value, base);
+  }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T> size_t println(T value, int base) {
+    size_t n = print(value, base);
+    return n + println();
+  }
+};
+
+extern SimSerial Serial;
+
+#endif // SIM_ARDUINO_H
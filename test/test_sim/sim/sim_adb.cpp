@@ -0,0 +1,527 @@
+/**
+ * @file sim_adb.cpp
+ * @brief Implémentation du bus ADB virtuel et des modèles de périphériques.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "sim_adb.h"
+#include <cstring>
+
+/** Seuils de décodage des phases basses de l'hôte (µs). */
+#define SIM_ADB_BIT_ONE_MAX_US 50
+#define SIM_ADB_ATTN_MIN_US 500
+#define SIM_ADB_ATTN_MAX_US 1100
+#define SIM_ADB_RESET_MIN_US 2800
+#define SIM_ADB_LISTEN_BITS 16
+
+#define NS_PER_US 1000ULL
+
+/** États du décodeur des fronts de l'hôte. */
+enum : uint8_t {
+  BUS_IDLE = 0, /**< Hors transaction. */
+  BUS_COMMAND,  /**< Bits de commande après une attention. */
+  BUS_LISTEN    /**< Trame de données émise par l'hôte (Listen). */
+};
+
+static uint8_t bus_pin = 0;
+static sim_adb_device *devices[SIM_ADB_DEVICE_MAX];
+static uint8_t device_count = 0;
+
+// Hôte
+static bool host_low = false;
+static uint64_t host_low_start_ns = 0;
+static uint8_t state = BUS_IDLE;
+static uint8_t command = 0;
+static uint8_t command_bits = 0;
+static sim_adb_device *listen_dev = nullptr;
+static uint8_t listen_reg = 0;
+static uint8_t listen_cells = 0;
+static uint16_t listen_data = 0;
+
+// Périphériques : SRQ et trame de réponse en cours
+static uint64_t srq_until_ns = 0;
+static uint64_t response_start_ns = 0;
+static uint8_t response[8];
+static uint8_t response_bits = 0; /**< 0 : pas de réponse programmée. */
+
+static uint32_t srq_total = 0;
+static uint32_t command_total = 0;
+
+static sim_adb_device *device_at(uint8_t address) {
+  for (uint8_t i = 0; i < device_count; i++)
+    if (devices[i]->address == address)
+      return devices[i];
+  return nullptr;
+}
+
+/**
+ * @brief Bit de la cellule `cell` de la réponse (start, données, stop).
+ */
+static bool response_bit(uint16_t cell) {
+  if (cell == 0)
+    return true;
+  if (cell > response_bits)
+    return false;
+  uint16_t index = cell - 1;
+  return response[index / 8] & (0x80 >> (index % 8));
+}
+
+static void schedule_response(uint64_t stop_end_ns, const uint8_t *data,
+                              uint8_t len) {
+  memcpy(response, data, len);
+  response_bits = len * 8;
+  response_start_ns = stop_end_ns + SIM_ADB_TLT_US * NS_PER_US;
+}
+
+static void talk(sim_adb_device *dev, uint8_t reg, uint64_t now_ns) {
+  uint8_t buf[8];
+  uint8_t len = 0;
+  uint32_t now_us = (uint32_t)(now_ns / NS_PER_US);
+
+  switch (reg) {
+  case 0:
+    dev->talks++;
+    len = dev->ops->talk0(dev, now_us, buf);
+    break;
+  case 2:
+    memcpy(buf, dev->reg2, 2);
+    len = 2;
+    break;
+  case 3:
+    buf[0] = (dev->srq_enable ? 0x20 : 0) | (dev->address & 0x0F);
+    buf[1] = dev->handler_id;
+    len = 2;
+    break;
+  default:
+    break;
+  }
+  if (len > 0)
+    schedule_response(now_ns, buf, len);
+}
+
+static void listen(sim_adb_device *dev, uint8_t reg, uint16_t data) {
+  uint8_t hi = data >> 8, lo = data & 0xFF;
+  if (reg == 2) {
+    dev->reg2[0] = hi;
+    dev->reg2[1] = lo;
+  } else if (reg == 3) {
+    // Identifiants réservés : changement d'adresse, autotest
+    if (lo != 0x00 && lo < 0xFD)
+      dev->handler_id = lo;
+    dev->srq_enable = hi & 0x20;
+  }
+}
+
+/**
+ * @brief Commande complète : fin du bit de stop (SRQ compris).
+ */
+static void on_command(uint64_t now_ns) {
+  command_total++;
+  uint8_t address = command >> 4;
+  uint8_t reg = command & 0x03;
+  sim_adb_device *dev = device_at(address);
+
+  switch ((command >> 2) & 0x03) {
+  case 0:
+    if (reg == 1 && dev != nullptr)
+      dev->ops->flush(dev, (uint32_t)(now_ns / NS_PER_US));
+    return;
+  case 2:
+    state = BUS_LISTEN;
+    listen_dev = dev;
+    listen_reg = reg;
+    listen_cells = 0;
+    listen_data = 0;
+    return;
+  case 3:
+    if (dev != nullptr)
+      talk(dev, reg, now_ns);
+    return;
+  default:
+    return;
+  }
+}
+
+/**
+ * @brief Début du bit de stop : un périphérique non adressé ayant des
+ * données le prolonge.
+ */
+static void on_stop_bit(uint64_t now_ns) {
+  uint8_t address = command >> 4;
+  uint32_t now_us = (uint32_t)(now_ns / NS_PER_US);
+  for (uint8_t i = 0; i < device_count; i++) {
+    sim_adb_device *dev = devices[i];
+    if (dev->address != address && dev->srq_enable &&
+        dev->ops->pending(dev, now_us)) {
+      srq_until_ns = now_ns + SIM_ADB_SRQ_US * NS_PER_US;
+      dev->srqs++;
+      srq_total++;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Fin d'une phase basse de l'hôte.
+ */
+static void on_host_release(uint64_t now_ns) {
+  uint32_t low_us = (uint32_t)((now_ns - host_low_start_ns) / NS_PER_US);
+
+  if (low_us >= SIM_ADB_RESET_MIN_US) {
+    state = BUS_IDLE;
+    for (uint8_t i = 0; i < device_count; i++)
+      devices[i]->ops->flush(devices[i], (uint32_t)(now_ns / NS_PER_US));
+    return;
+  }
+  if (low_us >= SIM_ADB_ATTN_MIN_US && low_us <= SIM_ADB_ATTN_MAX_US) {
+    state = BUS_COMMAND;
+    command = 0;
+    command_bits = 0;
+    response_bits = 0;
+    return;
+  }
+
+  bool bit = low_us < SIM_ADB_BIT_ONE_MAX_US;
+  switch (state) {
+  case BUS_COMMAND:
+    if (command_bits < 8) {
+      command = (uint8_t)(command << 1) | bit;
+      command_bits++;
+      return;
+    }
+    state = BUS_IDLE;
+    on_command(now_ns > srq_until_ns ? now_ns : srq_until_ns);
+    return;
+  case BUS_LISTEN:
+    // Bit de start, 16 bits de données, bit de stop
+    if (listen_cells > 0 && listen_cells <= SIM_ADB_LISTEN_BITS)
+      listen_data = (uint16_t)(listen_data << 1) | bit;
+    if (++listen_cells == SIM_ADB_LISTEN_BITS + 2) {
+      state = BUS_IDLE;
+      if (listen_dev != nullptr)
+        listen(listen_dev, listen_reg, listen_data);
+    }
+    return;
+  default:
+    return;
+  }
+}
+
+void sim_adb_host_drive(bool low, uint64_t now_ns) {
+  if (low == host_low)
+    return;
+  host_low = low;
+  if (low) {
+    host_low_start_ns = now_ns;
+    if (state == BUS_COMMAND && command_bits == 8)
+      on_stop_bit(now_ns);
+  } else {
+    on_host_release(now_ns);
+  }
+}
+
+int sim_adb_line(uint64_t now_ns) {
+  if (host_low || now_ns < srq_until_ns)
+    return 0;
+  if (response_bits > 0 && now_ns >= response_start_ns) {
+    uint64_t offset_us = (now_ns - response_start_ns) / NS_PER_US;
+    uint64_t cell = offset_us / SIM_ADB_CELL_US;
+    if (cell <= (uint64_t)response_bits + 1) {
+      uint32_t low_us = response_bit((uint16_t)cell) ? 35 : 65;
+      return offset_us % SIM_ADB_CELL_US < low_us ? 0 : 1;
+    }
+  }
+  return 1;
+}
+
+void sim_adb_begin(uint8_t pin) {
+  bus_pin = pin;
+  device_count = 0;
+  host_low = false;
+  state = BUS_IDLE;
+  srq_until_ns = 0;
+  response_bits = 0;
+  srq_total = 0;
+  command_total = 0;
+}
+
+uint8_t sim_adb_pin() { return bus_pin; }
+
+bool sim_adb_attach(sim_adb_device *dev) {
+  if (device_count >= SIM_ADB_DEVICE_MAX)
+    return false;
+  devices[device_count++] = dev;
+  return true;
+}
+
+uint32_t sim_adb_srq_count() { return srq_total; }
+
+uint32_t sim_adb_command_count() { return command_total; }
+
+// Clavier
+
+/**
+ * @brief Écarte les transitions arrivées alors que le tampon était plein.
+ *
+ * @return Nombre de transitions en attente.
+ */
+static size_t keyboard_settle(sim_keyboard *kbd, uint32_t now_us) {
+  size_t queued = 0;
+  for (size_t i = kbd->next; i < kbd->script.size(); i++) {
+    sim_key_action &action = kbd->script[i];
+    if ((int32_t)(now_us - action.at_us) < 0)
+      break;
+    if (action.lost)
+      continue;
+    if (queued == SIM_ADB_KEYBOARD_BUFFER) {
+      action.lost = true;
+      kbd->lost++;
+      continue;
+    }
+    queued++;
+  }
+  return queued;
+}
+
+static uint8_t keyboard_talk0(sim_adb_device *dev, uint32_t now_us,
+                              uint8_t *buf) {
+  sim_keyboard *kbd = static_cast<sim_keyboard *>(dev->model);
+  if (keyboard_settle(kbd, now_us) == 0)
+    return 0;
+
+  // Deux transitions par trame, 0xFF pour une place vide
+  buf[0] = buf[1] = 0xFF;
+  uint8_t count = 0;
+  while (count < 2 && kbd->next < kbd->script.size()) {
+    sim_key_action &action = kbd->script[kbd->next];
+    if ((int32_t)(now_us - action.at_us) < 0)
+      break;
+    kbd->next++;
+    if (action.lost)
+      continue;
+    action.fetched_us = now_us;
+    buf[count++] = (action.released ? 0x80 : 0) | (action.code & 0x7F);
+  }
+  return 2;
+}
+
+static bool keyboard_pending(const sim_adb_device *dev, uint32_t now_us) {
+  const sim_keyboard *kbd = static_cast<const sim_keyboard *>(dev->model);
+  for (size_t i = kbd->next; i < kbd->script.size(); i++) {
+    if ((int32_t)(now_us - kbd->script[i].at_us) < 0)
+      return false;
+    if (!kbd->script[i].lost)
+      return true;
+  }
+  return false;
+}
+
+static void keyboard_flush(sim_adb_device *dev, uint32_t now_us) {
+  sim_keyboard *kbd = static_cast<sim_keyboard *>(dev->model);
+  // Les transitions déjà survenues sont perdues
+  while (kbd->next < kbd->script.size() &&
+         (int32_t)(now_us - kbd->script[kbd->next].at_us) >= 0) {
+    sim_key_action &action = kbd->script[kbd->next++];
+    if (!action.lost) {
+      action.lost = true;
+      kbd->lost++;
+    }
+  }
+}
+
+static const sim_adb_ops keyboard_ops = {keyboard_talk0, keyboard_pending,
+                                         keyboard_flush};
+
+void sim_keyboard_init(sim_keyboard *kbd) {
+  kbd->dev = sim_adb_device();
+  kbd->dev.ops = &keyboard_ops;
+  kbd->dev.model = kbd;
+  kbd->dev.address = 2;
+  kbd->dev.handler_id = 2;
+  kbd->dev.srq_enable = true;
+  // Modificateurs relâchés, LEDs éteintes (actives à l'état bas)
+  kbd->dev.reg2[0] = 0xFF;
+  kbd->dev.reg2[1] = 0xFF;
+  kbd->script.clear();
+  kbd->next = 0;
+  kbd->lost = 0;
+}
+
+void sim_keyboard_key(sim_keyboard *kbd, uint32_t at_us, uint8_t code,
+                      bool released) {
+  kbd->script.push_back({at_us, code, released, 0, false});
+}
+
+uint8_t sim_keyboard_leds(const sim_keyboard *kbd) {
+  return ~kbd->dev.reg2[1] & 0x07;
+}
+
+// Souris
+
+/**
+ * @brief Cumule les actions survenues depuis le dernier Talk.
+ */
+static void mouse_accumulate(sim_mouse *mouse, uint32_t now_us) {
+  while (mouse->next < mouse->script.size()) {
+    const sim_mouse_action &action = mouse->script[mouse->next];
+    if ((int32_t)(now_us - action.at_us) < 0)
+      break;
+    mouse->pending_dx += action.dx;
+    mouse->pending_dy += action.dy;
+    mouse->button = action.button;
+    mouse->next++;
+  }
+}
+
+static int8_t mouse_take(int32_t *pending) {
+  // Axe sur 7 bits signés
+  int32_t value = *pending < -64 ? -64 : *pending > 63 ? 63 : *pending;
+  *pending -= value;
+  return (int8_t)value;
+}
+
+static uint8_t mouse_talk0(sim_adb_device *dev, uint32_t now_us,
+                           uint8_t *buf) {
+  sim_mouse *mouse = static_cast<sim_mouse *>(dev->model);
+  mouse_accumulate(mouse, now_us);
+  if (mouse->pending_dx == 0 && mouse->pending_dy == 0 &&
+      mouse->button == mouse->reported_button)
+    return 0;
+
+  int8_t dx = mouse_take(&mouse->pending_dx);
+  int8_t dy = mouse_take(&mouse->pending_dy);
+  mouse->reported_button = mouse->button;
+
+  // Déplacement entièrement rapporté : les actions cumulées sont livrées
+  if (mouse->pending_dx == 0 && mouse->pending_dy == 0)
+    for (; mouse->delivered < mouse->next; mouse->delivered++)
+      mouse->script[mouse->delivered].fetched_us = now_us;
+
+  // Bouton actif à l'état bas ; second bouton absent (relâché)
+  buf[0] = (mouse->button ? 0x00 : 0x80) | ((uint8_t)dy & 0x7F);
+  buf[1] = 0x80 | ((uint8_t)dx & 0x7F);
+  return 2;
+}
+
+static bool mouse_pending(const sim_adb_device *dev, uint32_t now_us) {
+  const sim_mouse *mouse = static_cast<const sim_mouse *>(dev->model);
+  return mouse->pending_dx != 0 || mouse->pending_dy != 0 ||
+         (mouse->next < mouse->script.size() &&
+          (int32_t)(now_us - mouse->script[mouse->next].at_us) >= 0);
+}
+
+static void mouse_flush(sim_adb_device *dev, uint32_t now_us) {
+  sim_mouse *mouse = static_cast<sim_mouse *>(dev->model);
+  mouse_accumulate(mouse, now_us);
+  mouse->pending_dx = mouse->pending_dy = 0;
+}
+
+static const sim_adb_ops mouse_ops = {mouse_talk0, mouse_pending,
+                                      mouse_flush};
+
+void sim_mouse_init(sim_mouse *mouse) {
+  mouse->dev = sim_adb_device();
+  mouse->dev.ops = &mouse_ops;
+  mouse->dev.model = mouse;
+  mouse->dev.address = 3;
+  mouse->dev.handler_id = 1;
+  mouse->dev.srq_enable = true;
+  mouse->script.clear();
+  mouse->next = mouse->delivered = 0;
+  mouse->pending_dx = mouse->pending_dy = 0;
+  mouse->button = mouse->reported_button = false;
+}
+
+void sim_mouse_move(sim_mouse *mouse, uint32_t at_us, int8_t dx, int8_t dy,
+                    bool button) {
+  mouse->script.push_back({at_us, dx, dy, button, 0});
+}
+
+// Manette
+
+/**
+ * @brief Applique les actions survenues depuis le dernier Talk.
+ */
+static void joystick_apply(sim_joystick *stick, uint32_t now_us) {
+  while (stick->next < stick->script.size()) {
+    const sim_joystick_action &action = stick->script[stick->next];
+    if ((int32_t)(now_us - action.at_us) < 0)
+      break;
+    stick->x = action.x;
+    stick->y = action.y;
+    stick->buttons = action.buttons;
+    stick->changed = true;
+    stick->next++;
+  }
+}
+
+static uint8_t joystick_talk0(sim_adb_device *dev, uint32_t now_us,
+                              uint8_t *buf) {
+  sim_joystick *stick = static_cast<sim_joystick *>(dev->model);
+  joystick_apply(stick, now_us);
+  if (!stick->changed)
+    return 0;
+  stick->changed = false;
+
+  for (; stick->delivered < stick->next; stick->delivered++)
+    stick->script[stick->delivered].fetched_us = now_us;
+
+  if (dev->handler_id != SIM_JOYSTICK_HANDLER) {
+    // Mode souris : déplacement depuis le dernier Talk, bouton 1 seul
+    int8_t dx = (int8_t)(stick->x - stick->mouse_x);
+    int8_t dy = (int8_t)(stick->y - stick->mouse_y);
+    stick->mouse_x = stick->x;
+    stick->mouse_y = stick->y;
+    buf[0] = (stick->buttons & 1 ? 0x00 : 0x80) | ((uint8_t)dy & 0x7F);
+    buf[1] = 0x80 | ((uint8_t)dx & 0x7F);
+    return 2;
+  }
+
+  // Boutons actifs à l'état bas
+  buf[0] = ~stick->buttons;
+  buf[1] = stick->x;
+  buf[2] = stick->y;
+  return 3;
+}
+
+static bool joystick_pending(const sim_adb_device *dev, uint32_t now_us) {
+  const sim_joystick *stick = static_cast<const sim_joystick *>(dev->model);
+  return stick->changed ||
+         (stick->next < stick->script.size() &&
+          (int32_t)(now_us - stick->script[stick->next].at_us) >= 0);
+}
+
+static void joystick_flush(sim_adb_device *dev, uint32_t now_us) {
+  sim_joystick *stick = static_cast<sim_joystick *>(dev->model);
+  joystick_apply(stick, now_us);
+  stick->changed = false;
+}
+
+static const sim_adb_ops joystick_ops = {joystick_talk0, joystick_pending,
+                                         joystick_flush};
+
+void sim_joystick_init(sim_joystick *stick) {
+  stick->dev = sim_adb_device();
+  stick->dev.ops = &joystick_ops;
+  stick->dev.model = stick;
+  stick->dev.address = 3;
+  stick->dev.handler_id = SIM_JOYSTICK_HANDLER;
+  stick->dev.srq_enable = true;
+  stick->script.clear();
+  stick->next = stick->delivered = 0;
+  stick->x = stick->y = 0x80;
+  stick->mouse_x = stick->mouse_y = 0x80;
+  stick->buttons = 0;
+  // Position de repos en attente (vidée par un Flush)
+  stick->changed = true;
+}
+
+void sim_joystick_move(sim_joystick *stick, uint32_t at_us, uint8_t x,
+                       uint8_t y, uint8_t buttons) {
+  stick->script.push_back({at_us, x, y, buttons, 0});
+}
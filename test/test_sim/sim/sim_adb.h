@@ -0,0 +1,199 @@
+/**
+ * @file sim_adb.h
+ * @brief Bus ADB virtuel et modèles de clavier, de souris et de manette
+ * scriptables.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Le bus est simulé au niveau électrique : l'hôte (la couche physique ADB du
+ * micrologiciel) pilote la broche par pinMode()/digitalWrite() et la lit par
+ * digitalRead(). Le bus décode attentions, commandes et trames Listen à
+ * partir des fronts de l'hôte, puis fait répondre le périphérique adressé
+ * après Tlt en générant ses cellules de bit. Un périphérique non adressé
+ * ayant des données prolonge le bit de stop (SRQ).
+ *
+ * Les scripts donnent l'instant (µs, base de micros()) de chaque action
+ * de l'utilisateur ; le modèle la rend disponible au premier Talk qui suit
+ * et note l'instant de cette lecture.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SIM_ADB_H
+#define SIM_ADB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define SIM_ADB_TLT_US 200       /**< Arrêt-départ d'une réponse. */
+#define SIM_ADB_SRQ_US 300       /**< Bit de stop prolongé par un SRQ. */
+#define SIM_ADB_CELL_US 100      /**< Cellule de bit. */
+#define SIM_ADB_DEVICE_MAX 4     /**< Périphériques sur le bus. */
+#define SIM_ADB_KEYBOARD_BUFFER 8 /**< Transitions gardées par le clavier. */
+#define SIM_JOYSTICK_HANDLER 0x30 /**< Gestionnaire de la MouseStick II. */
+
+struct sim_adb_device;
+
+/**
+ * @struct sim_adb_ops
+ * @brief Comportement propre à un modèle de périphérique.
+ */
+struct sim_adb_ops {
+  /** Prépare la réponse au Talk 0 ; retourne sa longueur (0 : rien). */
+  uint8_t (*talk0)(sim_adb_device *dev, uint32_t now_us, uint8_t *buf);
+  /** Indique si des données attendent (pour le SRQ). */
+  bool (*pending)(const sim_adb_device *dev, uint32_t now_us);
+  /** Commande Flush ou reset du bus. */
+  void (*flush)(sim_adb_device *dev, uint32_t now_us);
+};
+
+/**
+ * @struct sim_adb_device
+ * @brief Registres communs d'un périphérique virtuel.
+ */
+struct sim_adb_device {
+  const sim_adb_ops *ops;
+  void *model;        /**< Modèle propriétaire (sim_keyboard, sim_mouse). */
+  uint8_t address;    /**< Adresse par défaut (registre 3). */
+  uint8_t handler_id; /**< Identifiant de gestionnaire courant. */
+  bool srq_enable;    /**< Demandes de service autorisées. */
+  uint8_t reg2[2];    /**< Registre 2 (LEDs et modificateurs du clavier). */
+  uint32_t talks;     /**< Talk 0 reçus : cadence d'interrogation. */
+  uint32_t srqs;      /**< SRQ émis. */
+};
+
+/**
+ * @struct sim_key_action
+ * @brief Transition de touche scriptée.
+ */
+struct sim_key_action {
+  uint32_t at_us;     /**< Instant de l'action de l'utilisateur. */
+  uint8_t code;       /**< Code ADB (7 bits). */
+  bool released;
+  uint32_t fetched_us; /**< Lecture par l'hôte (0 : pas encore lue). */
+  bool lost;          /**< Écartée, tampon du clavier plein. */
+};
+
+/**
+ * @struct sim_keyboard
+ * @brief Clavier étendu virtuel (adresse 2).
+ */
+struct sim_keyboard {
+  sim_adb_device dev;
+  std::vector<sim_key_action> script;
+  size_t next;    /**< Première transition non lue. */
+  uint32_t lost;  /**< Transitions perdues par débordement. */
+};
+
+/**
+ * @struct sim_mouse_action
+ * @brief Déplacement ou clic de souris scripté.
+ */
+struct sim_mouse_action {
+  uint32_t at_us;
+  int8_t dx;
+  int8_t dy;
+  bool button;         /**< Bouton enfoncé après l'action. */
+  uint32_t fetched_us; /**< Talk qui a livré la fin du déplacement. */
+};
+
+/**
+ * @struct sim_mouse
+ * @brief Souris virtuelle (adresse 3), déplacements cumulés entre deux Talk.
+ */
+struct sim_mouse {
+  sim_adb_device dev;
+  std::vector<sim_mouse_action> script;
+  size_t next;        /**< Première action non prise en compte. */
+  size_t delivered;   /**< Première action dont la lecture n'est pas notée. */
+  int32_t pending_dx; /**< Déplacement restant à rapporter. */
+  int32_t pending_dy;
+  bool button;
+  bool reported_button;
+};
+
+/**
+ * @struct sim_joystick_action
+ * @brief Position ou boutons de manette scriptés.
+ */
+struct sim_joystick_action {
+  uint32_t at_us;
+  uint8_t x;           /**< Axes bruts (0x80 au repos). */
+  uint8_t y;
+  uint8_t buttons;     /**< Bit i : bouton i + 1 enfoncé. */
+  uint32_t fetched_us; /**< Talk qui a livré cet état (ou un plus récent). */
+};
+
+/**
+ * @struct sim_joystick
+ * @brief Manette virtuelle (adresse 3, gestionnaire de la MouseStick II) :
+ * répond au Talk 0 par son état absolu lorsqu'il a changé. Passée au
+ * gestionnaire souris, elle rapporte comme une souris à un bouton le
+ * déplacement depuis le dernier Talk.
+ */
+struct sim_joystick {
+  sim_adb_device dev;
+  std::vector<sim_joystick_action> script;
+  size_t next;      /**< Première action non prise en compte. */
+  size_t delivered; /**< Première action dont la lecture n'est pas notée. */
+  uint8_t x;
+  uint8_t y;
+  uint8_t buttons;
+  bool changed;     /**< État non encore rapporté. */
+  uint8_t mouse_x;  /**< Position rapportée en mode souris. */
+  uint8_t mouse_y;
+};
+
+/**
+ * @brief Relie le bus virtuel à une broche et retire tous les périphériques.
+ */
+void sim_adb_begin(uint8_t pin);
+
+/** @brief Broche du bus ADB. */
+uint8_t sim_adb_pin();
+
+/** @brief Branche un périphérique sur le bus. */
+bool sim_adb_attach(sim_adb_device *dev);
+
+/** @brief Nombre de SRQ observés sur le bus. */
+uint32_t sim_adb_srq_count();
+
+/** @brief Commandes reçues depuis sim_adb_begin(). */
+uint32_t sim_adb_command_count();
+
+/**
+ * @brief Initialise un clavier virtuel (gestionnaire 2, LEDs éteintes).
+ */
+void sim_keyboard_init(sim_keyboard *kbd);
+
+/** @brief Ajoute une transition de touche au script. */
+void sim_keyboard_key(sim_keyboard *kbd, uint32_t at_us, uint8_t code,
+                      bool released);
+
+/** @brief LEDs du clavier (bit 0 Num Lock, 1 Caps Lock, 2 Scroll Lock). */
+uint8_t sim_keyboard_leds(const sim_keyboard *kbd);
+
+/** @brief Initialise une souris virtuelle (gestionnaire 1). */
+void sim_mouse_init(sim_mouse *mouse);
+
+/** @brief Ajoute un déplacement au script. */
+void sim_mouse_move(sim_mouse *mouse, uint32_t at_us, int8_t dx, int8_t dy,
+                    bool button);
+
+/** @brief Initialise une manette virtuelle au repos. */
+void sim_joystick_init(sim_joystick *stick);
+
+/** @brief Ajoute un changement d'état au script. */
+void sim_joystick_move(sim_joystick *stick, uint32_t at_us, uint8_t x,
+                       uint8_t y, uint8_t buttons);
+
+// Interface du cœur simulé
+/** @brief L'hôte tire la ligne à l'état bas ou la relâche. */
+void sim_adb_host_drive(bool low, uint64_t now_ns);
+/** @brief Niveau de la ligne. */
+int sim_adb_line(uint64_t now_ns);
+
+#endif // SIM_ADB_H
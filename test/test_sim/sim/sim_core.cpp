@@ -0,0 +1,234 @@
+/**
+ * @file sim_core.cpp
+ * @brief Implémentation du cœur Arduino simulé.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "Arduino.h"
+#include "sim_adb.h"
+#include "sim_core.h"
+#include <cstdio>
+#include <deque>
+
+void loop();
+
+SimSerial Serial;
+
+static uint64_t now_ns = 0;
+static void (*irq_handler)(uint64_t now_ns) = nullptr;
+static bool in_irq = false;
+
+static uint8_t pin_modes[SIM_PIN_COUNT];
+static uint8_t pin_outputs[SIM_PIN_COUNT];
+static uint8_t pin_inputs[SIM_PIN_COUNT];
+static bool pin_forced[SIM_PIN_COUNT];
+
+static std::deque<uint8_t> serial_in;
+static std::string serial_out;
+static bool serial_echo = false;
+
+/**
+ * @brief Interruption simulée, servie après chaque progression de l'horloge.
+ */
+static inline void service_irq() {
+  if (irq_handler == nullptr || in_irq)
+    return;
+  in_irq = true;
+  irq_handler(now_ns);
+  in_irq = false;
+}
+
+/**
+ * @brief Coût d'un appel au cœur : fait progresser les boucles d'attente.
+ */
+static inline void tick() {
+  now_ns += SIM_CALL_NS;
+  service_irq();
+}
+
+uint64_t sim_now_ns() { return now_ns; }
+
+void sim_advance_ns(uint64_t ns) {
+  now_ns += ns;
+  service_irq();
+}
+
+void sim_core_set_irq(void (*handler)(uint64_t now_ns)) {
+  irq_handler = handler;
+}
+
+unsigned long millis() {
+  tick();
+  return (unsigned long)(uint32_t)(now_ns / 1000000ULL);
+}
+
+unsigned long micros() {
+  tick();
+  return (unsigned long)(uint32_t)(now_ns / 1000ULL);
+}
+
+void delay(unsigned long ms) {
+  now_ns += ms * 1000000ULL;
+  service_irq();
+}
+
+void delayMicroseconds(unsigned int us) {
+  now_ns += us * 1000ULL;
+  service_irq();
+}
+
+void yield() { tick(); }
+
+/**
+ * @brief Ligne pilotée par l'hôte : sortie à l'état bas (drain ouvert).
+ */
+static void update_bus(uint32_t pin) {
+  if (pin != sim_adb_pin())
+    return;
+  sim_adb_host_drive(pin_modes[pin] == OUTPUT && pin_outputs[pin] == LOW,
+                     now_ns);
+}
+
+void pinMode(uint32_t pin, uint32_t mode) {
+  tick();
+  if (pin >= SIM_PIN_COUNT)
+    return;
+  pin_modes[pin] = mode;
+  update_bus(pin);
+}
+
+void digitalWrite(uint32_t pin, uint32_t value) {
+  tick();
+  if (pin >= SIM_PIN_COUNT)
+    return;
+  pin_outputs[pin] = value ? HIGH : LOW;
+  update_bus(pin);
+}
+
+int digitalRead(uint32_t pin) {
+  tick();
+  if (pin >= SIM_PIN_COUNT)
+    return LOW;
+  if (pin == sim_adb_pin())
+    return sim_adb_line(now_ns);
+  if (pin_modes[pin] == OUTPUT)
+    return pin_outputs[pin];
+  if (pin_forced[pin])
+    return pin_inputs[pin];
+  return pin_modes[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+unsigned long pulseIn(uint32_t pin, uint32_t state, unsigned long timeout) {
+  unsigned long start = micros();
+  while (digitalRead(pin) == (int)state)
+    if (micros() - start > timeout)
+      return 0;
+  while (digitalRead(pin) != (int)state)
+    if (micros() - start > timeout)
+      return 0;
+  unsigned long pulse_start = micros();
+  while (digitalRead(pin) == (int)state)
+    if (micros() - start > timeout)
+      return 0;
+  return micros() - pulse_start;
+}
+
+void attachInterrupt(uint32_t, void (*)(void), int) {}
+
+void detachInterrupt(uint32_t) {}
+
+void sim_set_pin_input(uint8_t pin, int level) {
+  if (pin >= SIM_PIN_COUNT)
+    return;
+  pin_forced[pin] = true;
+  pin_inputs[pin] = level ? HIGH : LOW;
+}
+
+int sim_pin_output(uint8_t pin) {
+  return pin < SIM_PIN_COUNT ? pin_outputs[pin] : LOW;
+}
+
+void sim_run_until_us(uint32_t until_us) {
+  while ((int32_t)(uint32_t)(now_ns / 1000ULL - until_us) < 0)
+    loop();
+}
+
+void sim_run_for_ms(uint32_t ms) {
+  sim_run_until_us((uint32_t)(now_ns / 1000ULL) + ms * 1000);
+}
+
+void sim_core_reset() {
+  memset(pin_modes, INPUT, sizeof(pin_modes));
+  memset(pin_outputs, LOW, sizeof(pin_outputs));
+  memset(pin_forced, 0, sizeof(pin_forced));
+  serial_in.clear();
+  serial_out.clear();
+}
+
+void sim_serial_input(const uint8_t *data, size_t len) {
+  serial_in.insert(serial_in.end(), data, data + len);
+}
+
+const std::string &sim_serial_output() { return serial_out; }
+
+void sim_serial_echo(bool echo) { serial_echo = echo; }
+
+// Port série
+
+void SimSerial::begin(unsigned long) {}
+
+void SimSerial::end() {}
+
+int SimSerial::available() {
+  tick();
+  return (int)serial_in.size();
+}
+
+int SimSerial::read() {
+  tick();
+  if (serial_in.empty())
+    return -1;
+  uint8_t byte = serial_in.front();
+  serial_in.pop_front();
+  return byte;
+}
+
+int SimSerial::peek() { return serial_in.empty() ? -1 : serial_in.front(); }
+
+// Émission instantanée : le tampon n'est jamais plein
+int SimSerial::availableForWrite() { return 4096; }
+
+size_t SimSerial::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t SimSerial::write(const uint8_t *data, size_t len) {
+  tick();
+  serial_out.append((const char *)data, len);
+  if (serial_echo)
+    fwrite(data, 1, len, stdout);
+  return len;
+}
+
+size_t SimSerial::print(double value, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, value);
+  return write(buf);
+}
+
+size_t SimSerial::print(unsigned long long value, int base) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%llX" : "%llu", value);
+  return write(buf);
+}
+
+size_t SimSerial::print(long long value, int base) {
+  if (base != DEC)
+    return print((unsigned long long)value, base);
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%lld", value);
+  return write(buf);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file sim_core.h
+ * @brief Pilotage du cœur simulé : horloge virtuelle, port série, boucle.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SIM_CORE_H
+#define SIM_CORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define SIM_CALL_NS 200 /**< Coût d'un appel au cœur (ns). */
+
+/** @brief Instant virtuel courant (ns depuis le lancement). */
+uint64_t sim_now_ns();
+
+/** @brief Avance l'horloge virtuelle. */
+void sim_advance_ns(uint64_t ns);
+
+/**
+ * @brief Installe une interruption simulée (nullptr : aucune).
+ *
+ * Le gestionnaire est appelé après chaque progression de l'horloge (appel
+ * au cœur, attente), jamais de façon imbriquée : il rattrape les échéances
+ * franchies à partir de l'instant reçu.
+ */
+void sim_core_set_irq(void (*handler)(uint64_t now_ns));
+
+/**
+ * @brief Exécute loop() jusqu'à l'instant indiqué (µs, base de micros()).
+ */
+void sim_run_until_us(uint32_t until_us);
+
+/** @brief Exécute loop() pendant la durée indiquée. */
+void sim_run_for_ms(uint32_t ms);
+
+/** @brief Impose le niveau lu sur une broche d'entrée (hors bus ADB). */
+void sim_set_pin_input(uint8_t pin, int level);
+
+/** @brief Dernier niveau écrit sur une broche de sortie. */
+int sim_pin_output(uint8_t pin);
+
+/** @brief Ajoute des octets à l'entrée du port série. */
+void sim_serial_input(const uint8_t *data, size_t len);
+
+/** @brief Sortie du port série depuis la dernière remise à zéro. */
+const std::string &sim_serial_output();
+
+/** @brief Recopie la sortie du port série sur stdout. */
+void sim_serial_echo(bool echo);
+
+/**
+ * @brief Remet le cœur à son état de démarrage (broches, port série).
+ *
+ * L'horloge n'est jamais remise à zéro : elle reste monotone d'un scénario
+ * à l'autre, comme les horodatages conservés par le micrologiciel.
+ */
+void sim_core_reset();
+
+#endif // SIM_CORE_H
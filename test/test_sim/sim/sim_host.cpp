@@ -0,0 +1,284 @@
+/**
+ * @file sim_host.cpp
+ * @brief Implémentation de l'hôte HID virtuel.
+ * @part of Apple-ADB-Ressurector
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#include "sim_host.h"
+#include "Arduino.h"
+#include "sim_core.h"
+#include "sof_sync.h"
+#include <algorithm>
+
+static std::vector<sim_host_report> reports;
+static uint32_t interval_us = 0;
+static uint32_t last_accept_us = 0;
+static bool accepted_once = false;
+static bool suspended = false;
+static bool remote_wakeup_enabled = true;
+static bool resuming = false;
+static uint32_t wakeup_start_us = 0;
+static uint32_t resume_at_us = 0;
+static uint32_t wakeups = 0;
+static bool usb_frames = false;
+static bool composite = false;
+static uint32_t in_phase_us = 0;
+static uint32_t in_interval = 1; // Trames entre deux jetons IN clavier
+static uint32_t frame_index = 0;
+static uint64_t frame_ns = 0; // Début de la trame en cours
+static bool sof_sent = false;
+static bool endpoint_full = false;
+static sim_host_report endpoint;
+
+static bool sim_suspended() {
+  if (resuming && (int32_t)(micros() - resume_at_us) >= 0)
+    suspended = resuming = false;
+  return suspended;
+}
+
+static bool sim_ready() {
+  if (sim_suspended())
+    return false;
+  return interval_us == 0 || !accepted_once ||
+         micros() - last_accept_us >= interval_us;
+}
+
+static bool sim_remote_wakeup(bool signal) {
+  if (!remote_wakeup_enabled || !suspended)
+    return false;
+
+  if (signal) {
+    wakeup_start_us = micros();
+  } else if (micros() - wakeup_start_us >= 1000 && !resuming) {
+    // Signalisation assez longue : l'hôte pilote la reprise
+    resuming = true;
+    resume_at_us = micros() + SIM_HOST_RESUME_US;
+    wakeups++;
+  }
+  return true;
+}
+
+static bool sim_send(uint8_t kind, const uint8_t *report, uint8_t len) {
+  bool buffered = usb_frames && kind == HID_REPORT_KEYBOARD;
+  if (buffered && endpoint_full)
+    return false; // Point d'accès occupé
+
+  sim_host_report entry = {};
+  entry.t_us = micros();
+  entry.kind = kind;
+  entry.len = len < SIM_HOST_REPORT_MAX ? len : SIM_HOST_REPORT_MAX;
+  memcpy(entry.data, report, entry.len);
+  if (buffered) {
+    endpoint = entry;
+    endpoint_full = true;
+  } else {
+    reports.push_back(entry);
+  }
+  last_accept_us = entry.t_us;
+  accepted_once = true;
+  return true;
+}
+
+/**
+ * @brief Trames USB : SOF puis, toutes les `in_interval` trames, jeton IN
+ * clavier, rattrapés jusqu'à `now_ns`.
+ */
+static void usb_irq(uint64_t now_ns) {
+  for (;;) {
+    if (!sof_sent) {
+      if (now_ns < frame_ns)
+        return;
+      if (!suspended)
+        sof_sync_frame((uint32_t)(frame_ns / 1000));
+      sof_sent = true;
+    }
+
+    uint64_t in_ns = frame_ns + in_phase_us * 1000ULL;
+    if (now_ns < in_ns)
+      return;
+    bool in_token = frame_index % in_interval == 0;
+    if (in_token && endpoint_full && !suspended) {
+      endpoint.t_us = (uint32_t)(in_ns / 1000);
+      reports.push_back(endpoint);
+      endpoint_full = false;
+      sof_sync_in_token(endpoint.t_us);
+    }
+    frame_ns += 1000000ULL;
+    frame_index++;
+    sof_sent = false;
+  }
+}
+
+static bool sim_carries(uint8_t kind) {
+  return !composite || kind == HID_REPORT_KEYBOARD || kind == HID_REPORT_MOUSE;
+}
+
+const hid_transport hid_transport_sim = {
+    "sim", sim_ready, sim_send, sim_suspended, sim_remote_wakeup, sim_carries};
+
+void sim_host_reset() {
+  reports.clear();
+  interval_us = 0;
+  accepted_once = false;
+  suspended = resuming = false;
+  remote_wakeup_enabled = true;
+  wakeups = 0;
+  usb_frames = false;
+  composite = false;
+  endpoint_full = false;
+  sim_core_set_irq(nullptr);
+}
+
+void sim_host_set_composite(bool enabled) { composite = enabled; }
+
+void sim_host_set_usb_frames(bool enabled, uint32_t phase_us,
+                             uint32_t interval_frames) {
+  usb_frames = enabled;
+  in_phase_us = phase_us;
+  in_interval = interval_frames ? interval_frames : 1;
+  frame_index = 0;
+  endpoint_full = false;
+  // Première trame à la milliseconde suivante
+  frame_ns = (sim_now_ns() / 1000000ULL + 1) * 1000000ULL;
+  sof_sent = false;
+  sim_core_set_irq(enabled ? usb_irq : nullptr);
+}
+
+void sim_host_set_suspended(bool suspend) {
+  suspended = suspend;
+  resuming = false;
+}
+
+void sim_host_set_remote_wakeup(bool enabled) {
+  remote_wakeup_enabled = enabled;
+}
+
+uint32_t sim_host_wakeups() { return wakeups; }
+
+void sim_host_set_interval_us(uint32_t interval) { interval_us = interval; }
+
+const std::vector<sim_host_report> &sim_host_reports() { return reports; }
+
+uint32_t sim_host_count(uint8_t kind) {
+  uint32_t count = 0;
+  for (const sim_host_report &report : reports)
+    count += report.kind == kind;
+  return count;
+}
+
+/**
+ * @brief Résume une série de latences.
+ */
+static sim_latency summarize(std::vector<uint32_t> &samples,
+                             uint32_t missing) {
+  sim_latency result = {};
+  result.count = samples.size();
+  result.missing = missing;
+  if (samples.empty())
+    return result;
+
+  std::sort(samples.begin(), samples.end());
+  uint64_t sum = 0;
+  for (uint32_t sample : samples)
+    sum += sample;
+  result.min_us = samples.front();
+  result.max_us = samples.back();
+  result.mean_us = (uint32_t)(sum / samples.size());
+  result.p99_us = samples[std::min(samples.size() - 1,
+                                   samples.size() * 99 / 100)];
+  return result;
+}
+
+/**
+ * @brief Premier rapport d'un type reçu à partir de l'instant indiqué.
+ */
+static size_t next_report(size_t from, uint8_t kind, uint32_t t_us) {
+  while (from < reports.size() &&
+         (reports[from].kind != kind ||
+          (int32_t)(reports[from].t_us - t_us) < 0))
+    from++;
+  return from;
+}
+
+sim_latency sim_host_keyboard_latency(const sim_keyboard *kbd) {
+  std::vector<uint32_t> samples;
+  uint32_t missing = 0;
+  size_t cursor = 0;
+
+  for (const sim_key_action &action : kbd->script) {
+    if (action.lost) {
+      missing++;
+      continue;
+    }
+    if (action.fetched_us == 0)
+      continue; // Pas encore survenue ou pas encore lue
+    cursor = next_report(cursor, HID_REPORT_KEYBOARD, action.fetched_us);
+    if (cursor == reports.size()) {
+      missing++;
+      continue;
+    }
+    samples.push_back(reports[cursor].t_us - action.at_us);
+    cursor++;
+  }
+  return summarize(samples, missing);
+}
+
+sim_latency sim_host_mouse_latency(const sim_mouse *mouse) {
+  std::vector<uint32_t> samples;
+  uint32_t missing = 0;
+  size_t cursor = 0;
+
+  for (const sim_mouse_action &action : mouse->script) {
+    if (action.fetched_us == 0)
+      continue;
+    cursor = next_report(cursor, HID_REPORT_MOUSE, action.fetched_us);
+    if (cursor == reports.size()) {
+      missing++;
+      continue;
+    }
+    // Plusieurs actions cumulées partagent le même rapport
+    samples.push_back(reports[cursor].t_us - action.at_us);
+  }
+  return summarize(samples, missing);
+}
+
+sim_latency sim_host_joystick_latency(const sim_joystick *stick) {
+  std::vector<uint32_t> samples;
+  uint32_t missing = 0;
+  size_t cursor = 0;
+
+  for (const sim_joystick_action &action : stick->script) {
+    if (action.fetched_us == 0)
+      continue;
+    cursor = next_report(cursor, HID_REPORT_JOYSTICK, action.fetched_us);
+    if (cursor == reports.size()) {
+      missing++;
+      continue;
+    }
+    samples.push_back(reports[cursor].t_us - action.at_us);
+  }
+  return summarize(samples, missing);
+}
+
+void sim_host_mouse_total(int32_t *dx, int32_t *dy) {
+  *dx = *dy = 0;
+  for (const sim_host_report &report : reports) {
+    if (report.kind != HID_REPORT_MOUSE)
+      continue;
+    *dx += (int8_t)report.data[1];
+    *dy += (int8_t)report.data[2];
+  }
+}
+
+uint32_t sim_poll_rate_hz(const sim_adb_device *dev, uint32_t talks_before,
+                          uint32_t elapsed_us) {
+  if (elapsed_us == 0)
+    return 0;
+  return (uint32_t)((uint64_t)(dev->talks - talks_before) * 1000000ULL /
+                    elapsed_us);
+}
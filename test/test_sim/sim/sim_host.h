@@ -0,0 +1,135 @@
+/**
+ * @file sim_host.h
+ * @brief Hôte HID virtuel : enregistre les rapports horodatés et mesure la
+ * latence de bout en bout.
+ * @part of Apple-ADB-Ressurector
+ *
+ * Le transport `sim` est actif à côté des transports du micrologiciel. Un
+ * intervalle d'interrogation (bInterval USB par exemple) peut être imposé :
+ * un rapport soumis avant son échéance est refusé, donc compté comme perdu
+ * par hid_transport.
+ *
+ * L'hôte peut suspendre le lien ; une signalisation de réveil d'au moins
+ * 1 ms est suivie de la reprise après SIM_HOST_RESUME_US, comme la
+ * signalisation de reprise (20 ms) d'un hôte USB.
+ *
+ * En mode trames USB, l'hôte émet un SOF par milliseconde (remis à
+ * sof_sync comme la pile USB du cœur STM32) et un jeton IN pour le clavier
+ * à une position fixe d'une trame sur `interval_frames` (intervalle
+ * d'interrogation effectif de l'hôte) : un rapport clavier attend dans le
+ * point d'accès jusqu'au jeton suivant, qui l'horodate, et un rapport soumis
+ * pendant cette attente est refusé.
+ *
+ * @date 2025
+ * @author Clément SAILLANT
+ * Dépôt actuel : https://github.com/electron-rare/Apple-ADB-Ressurector
+ * @license GNU GPL v3
+ */
+
+#ifndef SIM_HOST_H
+#define SIM_HOST_H
+
+#include "hid_transport.h"
+#include "sim_adb.h"
+#include <cstdint>
+#include <vector>
+
+#define SIM_HOST_REPORT_MAX 8 /**< Octets conservés par rapport. */
+#define SIM_HOST_RESUME_US 20000 /**< Réveil signalé → reprise du lien. */
+
+/**
+ * @struct sim_host_report
+ * @brief Rapport reçu par l'hôte virtuel.
+ */
+struct sim_host_report {
+  uint32_t t_us; /**< Réception (micros()). */
+  uint8_t kind;  /**< Voir hid_report_kind. */
+  uint8_t len;
+  uint8_t data[SIM_HOST_REPORT_MAX];
+};
+
+/**
+ * @struct sim_latency
+ * @brief Distribution de latences (µs).
+ */
+struct sim_latency {
+  uint32_t count;   /**< Actions livrées à l'hôte. */
+  uint32_t missing; /**< Actions jamais vues par l'hôte. */
+  uint32_t min_us;
+  uint32_t mean_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+};
+
+extern const hid_transport hid_transport_sim; /**< Hôte HID virtuel. */
+
+/** @brief Vide le journal et rétablit un hôte toujours prêt. */
+void sim_host_reset();
+
+/** @brief Intervalle minimal entre deux rapports acceptés (0 : aucun). */
+void sim_host_set_interval_us(uint32_t interval_us);
+
+/**
+ * @brief Active le mode trames USB (désactivé par défaut).
+ * @param in_phase_us Position du jeton IN clavier après le SOF.
+ * @param interval_frames Trames entre deux jetons IN clavier.
+ */
+void sim_host_set_usb_frames(bool enabled, uint32_t in_phase_us,
+                             uint32_t interval_frames);
+
+/**
+ * @brief Limite l'hôte aux interfaces du composite USB STM32 (clavier et
+ * souris) ; désactivé par défaut.
+ */
+void sim_host_set_composite(bool enabled);
+
+/** @brief Suspend (true) ou reprend (false) le lien. */
+void sim_host_set_suspended(bool suspended);
+
+/** @brief Autorise ou non le réveil à distance (autorisé par défaut). */
+void sim_host_set_remote_wakeup(bool enabled);
+
+/** @brief Nombre de réveils à distance valides reçus. */
+uint32_t sim_host_wakeups();
+
+/** @brief Rapports reçus, dans l'ordre. */
+const std::vector<sim_host_report> &sim_host_reports();
+
+/** @brief Nombre de rapports reçus d'un type. */
+uint32_t sim_host_count(uint8_t kind);
+
+/**
+ * @brief Latence action → rapport clavier.
+ *
+ * Chaque transition produit un rapport clavier (Caps Lock excepté, qui en
+ * produit deux) : les transitions livrées par le clavier sont associées dans
+ * l'ordre aux rapports reçus après leur lecture.
+ */
+sim_latency sim_host_keyboard_latency(const sim_keyboard *kbd);
+
+/**
+ * @brief Latence action → rapport souris.
+ *
+ * Un Talk non vide produit un rapport : une action est comptée à la
+ * réception du premier rapport qui suit sa lecture complète.
+ */
+sim_latency sim_host_mouse_latency(const sim_mouse *mouse);
+
+/**
+ * @brief Latence action → rapport manette.
+ *
+ * Une action est comptée à la réception du premier rapport manette qui suit
+ * la lecture de son état (ou d'un état plus récent).
+ */
+sim_latency sim_host_joystick_latency(const sim_joystick *stick);
+
+/** @brief Somme des déplacements reçus par l'hôte. */
+void sim_host_mouse_total(int32_t *dx, int32_t *dy);
+
+/**
+ * @brief Cadence d'interrogation d'un périphérique (Talk 0 par seconde).
+ */
+uint32_t sim_poll_rate_hz(const sim_adb_device *dev, uint32_t talks_before,
+                          uint32_t elapsed_us);
+
+#endif // SIM_HOST_H
@@ -0,0 +1,374 @@
+/**
+ * Simulation du micrologiciel complet : setup()/loop() de main.cpp sur le
+ * cœur Arduino simulé, clavier, souris et manette virtuels sur le bus ADB, hôte HID
+ * virtuel. Chaque scénario affiche latences et cadence d'interrogation.
+ *
+ *   pio test -e sim
+ */
+
+#include <unity.h>
+#include <cstdio>
+#include "Arduino.h"
+#include "adb_joystick.h"
+#include "adb_stats.h"
+#include "hid_transport.h"
+#include "host_suspend.h"
+#include "input_events.h"
+#include "key_queue.h"
+#include "power_manager.h"
+#include "sim_adb.h"
+#include "sim_core.h"
+#include "sim_host.h"
+#include "sof_sync.h"
+
+#define SIM_ADB_PIN 2 // ADB_PIN de main.cpp sous ADB_SIM
+
+void setup();
+
+static sim_keyboard keyboard;
+static sim_mouse mouse;
+static sim_joystick joystick;
+
+/**
+ * Démarre le micrologiciel avec un clavier et une souris (ou une manette, à
+ * la même adresse) sur le bus.
+ */
+static void sim_boot(bool with_joystick = false, bool composite = false) {
+    sim_core_reset();
+    sim_adb_begin(SIM_ADB_PIN);
+    sim_keyboard_init(&keyboard);
+    sim_mouse_init(&mouse);
+    sim_joystick_init(&joystick);
+    sim_adb_attach(&keyboard.dev);
+    sim_adb_attach(with_joystick ? &joystick.dev : &mouse.dev);
+
+    hid_transport_clear();
+    key_queue_reset();
+    sim_host_reset();
+    sim_host_set_composite(composite);
+    hid_transport_register(&hid_transport_sim);
+    adb_stats_reset();
+    setup();
+}
+
+static void print_latency(const char *name, const sim_latency &lat,
+                          uint32_t poll_hz) {
+    printf("SIM %s : n=%u perdus=%u latence min/moy/p99/max = "
+           "%u/%u/%u/%u us, interrogation %u Hz\n",
+           name, lat.count, lat.missing, lat.min_us, lat.mean_us, lat.p99_us,
+           lat.max_us, poll_hz);
+}
+
+void test_sim_boot_configures_devices() {
+    sim_boot();
+
+    // Gestionnaires étendus demandés par initializeDevice()
+    TEST_ASSERT_EQUAL(0x03, keyboard.dev.handler_id);
+    TEST_ASSERT_EQUAL(0x02, mouse.dev.handler_id);
+    // Num Lock actif par défaut
+    TEST_ASSERT_EQUAL(0x01, sim_keyboard_leds(&keyboard) & 0x01);
+    TEST_ASSERT_TRUE(sim_serial_output().find("Clavier détecté : Oui") !=
+                     std::string::npos);
+}
+
+void test_sim_typing_latency() {
+    sim_boot();
+    uint32_t t0 = micros();
+    uint32_t talks = keyboard.dev.talks;
+
+    // 30 frappes espacées de 60 ms, relâchées après 30 ms
+    for (uint8_t i = 0; i < 30; i++) {
+        uint32_t at = t0 + 10000 + i * 60000;
+        sim_keyboard_key(&keyboard, at, 1 + i % 10, false);
+        sim_keyboard_key(&keyboard, at + 30000, 1 + i % 10, true);
+    }
+    sim_run_for_ms(1900);
+
+    sim_latency lat = sim_host_keyboard_latency(&keyboard);
+    uint32_t poll_hz = sim_poll_rate_hz(&keyboard.dev, talks, micros() - t0);
+    print_latency("clavier", lat, poll_hz);
+
+    TEST_ASSERT_EQUAL(60, lat.count);
+    TEST_ASSERT_EQUAL(0, lat.missing);
+    // Au pire deux cycles d'interrogation
+    TEST_ASSERT_LESS_THAN(20000, lat.max_us);
+    TEST_ASSERT_GREATER_THAN(50, poll_hz);
+    TEST_ASSERT_EQUAL(0, input_event_overflows());
+}
+
+void test_sim_mouse_motion_is_conserved() {
+    sim_boot();
+    uint32_t t0 = micros();
+    uint32_t talks = mouse.dev.talks;
+
+    // Déplacements plus rapides que l'interrogation : cumulés par la souris
+    for (uint16_t i = 0; i < 400; i++)
+        sim_mouse_move(&mouse, t0 + 1000 + i * 2000, 3, -2, i >= 200);
+    sim_run_for_ms(900);
+
+    int32_t dx = 0, dy = 0;
+    sim_host_mouse_total(&dx, &dy);
+    sim_latency lat = sim_host_mouse_latency(&mouse);
+    print_latency("souris", lat, sim_poll_rate_hz(&mouse.dev, talks,
+                                                  micros() - t0));
+
+    TEST_ASSERT_EQUAL(1200, dx);
+    TEST_ASSERT_EQUAL(-800, dy);
+    TEST_ASSERT_EQUAL(400, lat.count);
+    TEST_ASSERT_EQUAL(0, lat.missing);
+    TEST_ASSERT_LESS_THAN(20000, lat.max_us);
+}
+
+void test_sim_keyboard_burst_overflow() {
+    sim_boot();
+    uint32_t t0 = micros();
+    uint32_t talks = keyboard.dev.talks;
+
+    // 6 frappes (12 transitions) en rafale : le tampon du clavier en garde 8
+    for (uint8_t i = 0; i < 6; i++) {
+        sim_keyboard_key(&keyboard, t0 + 1000 + i * 20, 1 + i, false);
+        sim_keyboard_key(&keyboard, t0 + 1010 + i * 20, 1 + i, true);
+    }
+    sim_run_for_ms(100);
+
+    sim_latency lat = sim_host_keyboard_latency(&keyboard);
+    print_latency("rafale", lat, sim_poll_rate_hz(&keyboard.dev, talks,
+                                                  micros() - t0));
+    TEST_ASSERT_EQUAL(SIM_ADB_KEYBOARD_BUFFER, lat.count);
+    TEST_ASSERT_EQUAL(12 - SIM_ADB_KEYBOARD_BUFFER, lat.missing);
+    TEST_ASSERT_EQUAL(12 - SIM_ADB_KEYBOARD_BUFFER, keyboard.lost);
+    // Le clavier signale ses données pendant l'interrogation de la souris
+    TEST_ASSERT_GREATER_THAN(0, keyboard.dev.srqs);
+}
+
+void test_sim_suspend_and_remote_wakeup() {
+    sim_boot();
+    sim_run_for_ms(100);
+
+    // Hôte suspendu : sonde SRQ seule, au rythme lent
+    sim_host_set_suspended(true);
+    sim_run_for_ms(20);
+    uint32_t commands = sim_adb_command_count();
+    uint32_t talks = keyboard.dev.talks + mouse.dev.talks;
+    sim_run_for_ms(1000);
+    TEST_ASSERT_EQUAL(POWER_SUSPEND, power_get_state());
+    TEST_ASSERT_EQUAL(talks, keyboard.dev.talks + mouse.dev.talks);
+    TEST_ASSERT_LESS_OR_EQUAL(1000 / POWER_SUSPEND_POLL_MS + 1,
+                              sim_adb_command_count() - commands);
+
+    // Le déplacement seul ne réveille pas l'hôte et n'est pas conservé
+    uint32_t t0 = micros();
+    sim_mouse_move(&mouse, t0 + 1000, 5, 5, false);
+    sim_run_for_ms(200);
+    TEST_ASSERT_EQUAL(0, sim_host_wakeups());
+
+    // La frappe réveille l'hôte et lui parvient dès la reprise
+    t0 = micros();
+    sim_keyboard_key(&keyboard, t0 + 1000, 3, false);
+    sim_keyboard_key(&keyboard, t0 + 40000, 3, true);
+    sim_run_for_ms(300);
+
+    const host_suspend_stats &stats = host_suspend_get_stats();
+    printf("SIM réveil : %u us de la frappe au premier rapport\n",
+           stats.wake_last_us);
+    TEST_ASSERT_EQUAL(1, sim_host_wakeups());
+    TEST_ASSERT_FALSE(host_suspend_active());
+    TEST_ASSERT_EQUAL(1, stats.wake_count);
+    // Une sonde, la signalisation puis la reprise pilotée par l'hôte
+    TEST_ASSERT_LESS_THAN((POWER_SUSPEND_POLL_MS + HOST_WAKEUP_SIGNAL_MS +
+                           POLL_DELAY * 2) * 1000 + SIM_HOST_RESUME_US,
+                          stats.wake_last_us);
+    TEST_ASSERT_EQUAL(2, sim_host_count(HID_REPORT_KEYBOARD));
+    TEST_ASSERT_EQUAL(0, sim_host_count(HID_REPORT_MOUSE));
+    sim_latency lat = sim_host_keyboard_latency(&keyboard);
+    TEST_ASSERT_EQUAL(2, lat.count);
+    TEST_ASSERT_EQUAL(0, lat.missing);
+}
+
+/**
+ * 30 frappes à des instants sans rapport avec les trames USB.
+ */
+static void sim_type_30_keys() {
+    uint32_t t0 = micros();
+    for (uint8_t i = 0; i < 30; i++) {
+        uint32_t at = t0 + 10000 + i * 60000 + (i * 337) % 1000;
+        sim_keyboard_key(&keyboard, at, 1 + i % 10, false);
+        sim_keyboard_key(&keyboard, at + 30000, 1 + i % 10, true);
+    }
+    sim_run_for_ms(1900);
+}
+
+static void print_sof(const char *name, const sof_sync_stats &stats) {
+    printf("SIM SOF %s : n=%u événement -> jeton IN moy/max = %u/%u us, "
+           "cycle %u us, jeton IN à %u us toutes les %u trames, h=",
+           name, stats.count, stats.mean_us, stats.max_us, stats.cycle_us,
+           stats.in_phase_us, stats.interval_frames);
+    for (uint8_t i = 0; i < SOF_SYNC_BINS; i++)
+        printf(i ? ",%u" : "%u", stats.bins[i]);
+    printf("\n");
+}
+
+/**
+ * Même frappe en cadence libre puis calée, l'hôte prenant le rapport
+ * clavier toutes les `interval_frames` trames pour `declared` déclarées.
+ */
+static void sim_sof_run(uint32_t declared, uint32_t interval_frames,
+                        sof_sync_stats *free_run, sof_sync_stats *synced) {
+    sim_boot();
+    sof_sync_set_declared_interval(declared);
+    sim_host_set_usb_frames(true, 400, interval_frames);
+
+    // Cadence libre : le rapport attend le jeton IN jusqu'à un intervalle
+    sof_sync_set_enabled(false);
+    sim_type_30_keys();
+    *free_run = sof_sync_get_stats();
+    print_sof("libre", *free_run);
+
+    sof_sync_reset();
+    sim_type_30_keys();
+    *synced = sof_sync_get_stats();
+    print_sof("calé", *synced);
+
+    sim_latency lat = sim_host_keyboard_latency(&keyboard);
+    TEST_ASSERT_EQUAL(120, lat.count);
+    TEST_ASSERT_EQUAL(0, lat.missing);
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_KEYBOARD));
+
+    TEST_ASSERT_EQUAL(60, free_run->count);
+    TEST_ASSERT_EQUAL(60, synced->count);
+    TEST_ASSERT_EQUAL(interval_frames, synced->interval_frames);
+    TEST_ASSERT_UINT32_WITHIN(50, 400, synced->in_phase_us);
+    sof_sync_set_declared_interval(SOF_SYNC_INTERVAL_FRAMES);
+}
+
+void test_sim_sof_synchronized_polling() {
+    sof_sync_stats free_run, synced;
+    sim_sof_run(1, 1, &free_run, &synced);
+    TEST_ASSERT_LESS_THAN(free_run.mean_us - 200, synced.mean_us);
+    // L'événement est décodé pendant le cycle : calé, il n'attend plus que
+    // la fin du cycle et la marge
+    TEST_ASSERT_LESS_OR_EQUAL(synced.cycle_us + SOF_SYNC_GUARD_US,
+                              synced.max_us);
+}
+
+void test_sim_sof_learns_host_interval() {
+    // bInterval 10 arrondi à 8 par l'hôte : le calage suit l'intervalle réel
+    sof_sync_stats free_run, synced;
+    sim_sof_run(10, 8, &free_run, &synced);
+    TEST_ASSERT_LESS_THAN(free_run.mean_us - 2000, synced.mean_us);
+    // Seuls les rapports précédant l'apprentissage visent une autre trame
+    uint32_t on_time = 0;
+    for (uint32_t i = 0;
+         i <= (synced.cycle_us + SOF_SYNC_GUARD_US) / SOF_SYNC_BIN_US; i++)
+        on_time += synced.bins[i];
+    TEST_ASSERT_GREATER_OR_EQUAL(synced.count - 2, on_time);
+}
+
+void test_sim_joystick_priority_slot() {
+    sim_boot(true);
+    TEST_ASSERT_TRUE(sim_serial_output().find("Manette détectée : Oui") !=
+                     std::string::npos);
+    // Le Flush de l'initialisation vide l'état de repos : il est rapporté au
+    // premier changement, ici sans bouger, et sert de centre
+    sim_joystick_move(&joystick, micros(), 0x80, 0x80, 0);
+    sim_run_for_ms(50);
+
+    uint32_t t0 = micros();
+    uint32_t joystick_talks = joystick.dev.talks;
+    uint32_t keyboard_talks = keyboard.dev.talks;
+
+    // Balayages de l'axe X dans l'étendue initiale, hors zone morte, toutes
+    // les 7 ms ; bouton 1 basculé toutes les 10 positions ; frappes au
+    // clavier en parallèle
+    for (uint8_t i = 0; i < 100; i++)
+        sim_joystick_move(&joystick, t0 + 1000 + i * 7000, 0x88 + i % 50,
+                          0x80, (i / 10) & 1);
+    for (uint8_t i = 0; i < 10; i++) {
+        uint32_t at = t0 + 5000 + i * 70000;
+        sim_keyboard_key(&keyboard, at, 1 + i, false);
+        sim_keyboard_key(&keyboard, at + 30000, 1 + i, true);
+    }
+    sim_run_for_ms(750);
+
+    uint32_t elapsed = micros() - t0;
+    uint32_t joystick_hz =
+        sim_poll_rate_hz(&joystick.dev, joystick_talks, elapsed);
+    uint32_t keyboard_hz =
+        sim_poll_rate_hz(&keyboard.dev, keyboard_talks, elapsed);
+    sim_latency lat = sim_host_joystick_latency(&joystick);
+    print_latency("manette", lat, joystick_hz);
+    print_latency("clavier", sim_host_keyboard_latency(&keyboard),
+                  keyboard_hz);
+    printf("SIM manette : regroupés=%u débordements=%u\n",
+           adb_joystick_coalesced(), adb_joystick_overflows());
+
+    TEST_ASSERT_EQUAL(101, lat.count);
+    TEST_ASSERT_EQUAL(0, lat.missing);
+    // Créneau dédié : la manette est lue bien plus souvent que le clavier
+    TEST_ASSERT_GREATER_THAN(keyboard_hz * 3 / 2, joystick_hz);
+    TEST_ASSERT_LESS_THAN(2 * ADB_JOYSTICK_POLL_US + 6000, lat.max_us);
+    TEST_ASSERT_EQUAL(0, adb_joystick_overflows());
+    TEST_ASSERT_EQUAL(0, sim_host_keyboard_latency(&keyboard).missing);
+}
+
+void test_sim_joystick_without_transport_stays_mouse() {
+    // Composite USB STM32 : aucun rapport manette, la MouseStick reste une
+    // souris et n'a pas de créneau dédié
+    sim_boot(true, true);
+    const std::string &out = sim_serial_output();
+    TEST_ASSERT_TRUE(out.find("Manette détectée : Non") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("Souris détectée : Oui") != std::string::npos);
+
+    uint32_t t0 = micros();
+    uint32_t joystick_talks = joystick.dev.talks;
+    uint32_t keyboard_talks = keyboard.dev.talks;
+    for (uint8_t i = 0; i < 20; i++)
+        sim_joystick_move(&joystick, t0 + 1000 + i * 10000, 0x90 + i, 0x80,
+                          i & 1);
+    sim_run_for_ms(300);
+
+    uint32_t elapsed = micros() - t0;
+    TEST_ASSERT_GREATER_THAN(0, sim_host_count(HID_REPORT_MOUSE));
+    TEST_ASSERT_EQUAL(0, sim_host_count(HID_REPORT_JOYSTICK));
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_JOYSTICK));
+    // Même cadence que le clavier : un Talk par cycle
+    uint32_t joystick_hz =
+        sim_poll_rate_hz(&joystick.dev, joystick_talks, elapsed);
+    uint32_t keyboard_hz =
+        sim_poll_rate_hz(&keyboard.dev, keyboard_talks, elapsed);
+    TEST_ASSERT_LESS_OR_EQUAL(keyboard_hz + keyboard_hz / 10, joystick_hz);
+}
+
+void test_sim_tablet_skipped_without_transport() {
+    // Composite USB STM32 : pas de rapport numériseur, l'adresse 4 n'est
+    // jamais interrogée
+    sim_boot(false, true);
+    TEST_ASSERT_TRUE(sim_serial_output().find(
+                         "Tablettes non prises en charge") != std::string::npos);
+    sim_run_for_ms(100);
+    const adb_device_stats *tablet = adb_stats_get(ADB_STATS_TABLET);
+    TEST_ASSERT_EQUAL(0, tablet->timeouts + tablet->frames_ok);
+    TEST_ASSERT_EQUAL(0, hid_transport_dropped(HID_REPORT_TABLET));
+
+    // Hôte complet : la tablette est cherchée (absente, sans réponse)
+    sim_boot();
+    TEST_ASSERT_GREATER_THAN(0, adb_stats_get(ADB_STATS_TABLET)->timeouts);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sim_boot_configures_devices);
+    RUN_TEST(test_sim_typing_latency);
+    RUN_TEST(test_sim_mouse_motion_is_conserved);
+    RUN_TEST(test_sim_keyboard_burst_overflow);
+    RUN_TEST(test_sim_suspend_and_remote_wakeup);
+    RUN_TEST(test_sim_sof_synchronized_polling);
+    RUN_TEST(test_sim_sof_learns_host_interval);
+    RUN_TEST(test_sim_joystick_priority_slot);
+    RUN_TEST(test_sim_joystick_without_transport_stays_mouse);
+    RUN_TEST(test_sim_tablet_skipped_without_transport);
+    UNITY_END();
+
+    return 0;
+}